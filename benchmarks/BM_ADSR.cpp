@@ -26,6 +26,7 @@
 #include <algorithm>
 #include <random>
 #include <numeric>
+#include <vector>
 
 constexpr int fixedAmount { 12 };
 constexpr int envelopeSize { 2 << 16 };
@@ -66,6 +67,32 @@ static void Block(benchmark::State& state) {
     state.counters["Per block"] = benchmark::Counter(envelopeSize / state.range(0), benchmark::Counter::kIsIterationInvariantRate);
 }
 
+constexpr int numVoices { 64 };
+
+// Voices started and released at different times, so that their segments do not line up
+static void resetVoices(std::vector<sfz::ADSREnvelope<float>>& envelopes)
+{
+    for (int i = 0; i < numVoices; ++i) {
+        envelopes[i].reset(attack - 37 * i, release + 53 * i, 0.5f, fixedAmount + 11 * i, decay + 29 * i, fixedAmount);
+        envelopes[i].startRelease(releaseTime - 101 * i);
+    }
+}
+
+static void Voices_Block(benchmark::State& state) {
+    std::vector<std::vector<float>> outputs(numVoices, std::vector<float>(state.range(0)));
+    std::vector<sfz::ADSREnvelope<float>> envelopes(numVoices);
+    for (auto _ : state) {
+        resetVoices(envelopes);
+        for (int offset = 0; offset < envelopeSize; offset += state.range(0))
+            for (int i = 0; i < numVoices; ++i)
+                envelopes[i].getBlock(absl::MakeSpan(outputs[i]));
+        benchmark::DoNotOptimize(outputs);
+    }
+
+    state.counters["Per block"] = benchmark::Counter(envelopeSize / state.range(0), benchmark::Counter::kIsIterationInvariantRate);
+}
+
 BENCHMARK(Point)->RangeMultiplier(2)->Range((2<<6), (2<<11));
 BENCHMARK(Block)->RangeMultiplier(2)->Range((2<<6), (2<<11));
+BENCHMARK(Voices_Block)->RangeMultiplier(4)->Range((2<<5), (2<<9));
 BENCHMARK_MAIN();
\ No newline at end of file
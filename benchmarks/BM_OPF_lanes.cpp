@@ -0,0 +1,107 @@
+// Copyright (c) 2019, Paul Ferrand
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "OnePoleFilter.h"
+#include <benchmark/benchmark.h>
+#include <absl/types/span.h>
+#include <random>
+#include <algorithm>
+#include <vector>
+
+constexpr int numVoices { 64 };
+
+class Voices : public benchmark::Fixture {
+public:
+    void SetUp(const ::benchmark::State& state)
+    {
+        std::random_device rd {};
+        std::mt19937 gen { rd() };
+        std::normal_distribution<float> dist {};
+        filters.clear();
+        filterPointers.clear();
+        inputSpans.clear();
+        outputSpans.clear();
+        inputs.resize(numVoices);
+        outputs.resize(numVoices);
+        for (int i = 0; i < numVoices; ++i) {
+            inputs[i].resize(state.range(0));
+            outputs[i].resize(state.range(0));
+            std::generate(inputs[i].begin(), inputs[i].end(), [&]() { return dist(gen); });
+            filters.emplace_back(0.05f + 0.01f * i);
+        }
+        for (int i = 0; i < numVoices; ++i) {
+            filterPointers.push_back(&filters[i]);
+            inputSpans.push_back(absl::MakeConstSpan(inputs[i]));
+            outputSpans.push_back(absl::MakeSpan(outputs[i]));
+        }
+    }
+
+    void TearDown(const ::benchmark::State& state [[maybe_unused]]) {}
+
+    std::vector<sfz::OnePoleFilter<float>> filters;
+    std::vector<sfz::OnePoleFilter<float>*> filterPointers;
+    std::vector<std::vector<float>> inputs;
+    std::vector<std::vector<float>> outputs;
+    std::vector<absl::Span<const float>> inputSpans;
+    std::vector<absl::Span<float>> outputSpans;
+};
+
+BENCHMARK_DEFINE_F(Voices, Lowpass_Single)(benchmark::State& state)
+{
+    for (auto _ : state) {
+        for (int i = 0; i < numVoices; ++i)
+            filters[i].processLowpass(inputs[i], absl::MakeSpan(outputs[i]));
+        benchmark::DoNotOptimize(outputs);
+    }
+}
+
+BENCHMARK_DEFINE_F(Voices, Lowpass_Lanes)(benchmark::State& state)
+{
+    for (auto _ : state) {
+        sfz::OnePoleFilter<float>::processLowpassLanes(filterPointers, inputSpans, outputSpans);
+        benchmark::DoNotOptimize(outputs);
+    }
+}
+
+BENCHMARK_DEFINE_F(Voices, Highpass_Single)(benchmark::State& state)
+{
+    for (auto _ : state) {
+        for (int i = 0; i < numVoices; ++i)
+            filters[i].processHighpass(inputs[i], absl::MakeSpan(outputs[i]));
+        benchmark::DoNotOptimize(outputs);
+    }
+}
+
+BENCHMARK_DEFINE_F(Voices, Highpass_Lanes)(benchmark::State& state)
+{
+    for (auto _ : state) {
+        sfz::OnePoleFilter<float>::processHighpassLanes(filterPointers, inputSpans, outputSpans);
+        benchmark::DoNotOptimize(outputs);
+    }
+}
+
+BENCHMARK_REGISTER_F(Voices, Lowpass_Single)->RangeMultiplier(4)->Range((1 << 6), (1 << 10));
+BENCHMARK_REGISTER_F(Voices, Lowpass_Lanes)->RangeMultiplier(4)->Range((1 << 6), (1 << 10));
+BENCHMARK_REGISTER_F(Voices, Highpass_Single)->RangeMultiplier(4)->Range((1 << 6), (1 << 10));
+BENCHMARK_REGISTER_F(Voices, Highpass_Lanes)->RangeMultiplier(4)->Range((1 << 6), (1 << 10));
+BENCHMARK_MAIN();
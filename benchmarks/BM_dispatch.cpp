@@ -0,0 +1,214 @@
+// Copyright (c) 2019, Paul Ferrand
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// The hot kernels on each instruction set; the second argument is the SIMD path,
+// where scalar runs the generic implementations
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+#include "../sfizz/SIMDHelpers.h"
+#include "absl/types/span.h"
+
+class Dispatch : public benchmark::Fixture {
+public:
+  void SetUp(const ::benchmark::State& state) {
+    std::random_device rd { };
+    std::mt19937 gen { rd() };
+    std::uniform_real_distribution<float> dist { 0.1f, 1.0f };
+    const auto size = static_cast<size_t>(state.range(0));
+    input = std::vector<float>(size);
+    gain = std::vector<float>(size);
+    output = std::vector<float>(size);
+    outputRight = std::vector<float>(size);
+    interleaved = std::vector<float>(2 * size);
+    floatJumps = std::vector<float>(size);
+    jumps = std::vector<int>(size);
+    std::generate(input.begin(), input.end(), [&]() { return dist(gen); });
+    std::generate(gain.begin(), gain.end(), [&]() { return dist(gen); });
+    std::generate(interleaved.begin(), interleaved.end(), [&]() { return dist(gen); });
+    std::generate(floatJumps.begin(), floatJumps.end(), [&]() { return dist(gen) * static_cast<float>(size - 1); });
+
+    path = static_cast<sfz::SIMDPath>(state.range(1));
+    sfz::setSIMDPath(path);
+  }
+
+  void TearDown(const ::benchmark::State& state [[maybe_unused]]) {
+    sfz::setSIMDPath(sfz::getSupportedSIMDPath());
+  }
+
+  // False when the benchmark has to be skipped
+  bool select(benchmark::State& state) {
+    if (path != sfz::SIMDPath::scalar && sfz::getSIMDPath() != path) {
+      state.SkipWithError("Unsupported SIMD path");
+      return false;
+    }
+    state.SetLabel(sfz::simdPathName(path));
+    return true;
+  }
+
+  bool scalar() const { return path == sfz::SIMDPath::scalar; }
+
+  sfz::SIMDPath path;
+  std::vector<float> input;
+  std::vector<float> gain;
+  std::vector<float> output;
+  std::vector<float> outputRight;
+  std::vector<float> interleaved;
+  std::vector<float> floatJumps;
+  std::vector<int> jumps;
+};
+
+BENCHMARK_DEFINE_F(Dispatch, Gain)(benchmark::State& state) {
+    if (!select(state))
+        return;
+    for (auto _ : state)
+    {
+        if (scalar())
+            sfz::applyGain<float, false>(gain, input, absl::MakeSpan(output));
+        else
+            sfz::applyGain<float, true>(gain, input, absl::MakeSpan(output));
+        benchmark::DoNotOptimize(output.data());
+    }
+}
+
+BENCHMARK_DEFINE_F(Dispatch, MultiplyAdd)(benchmark::State& state) {
+    if (!select(state))
+        return;
+    for (auto _ : state)
+    {
+        if (scalar())
+            sfz::multiplyAdd<float, false>(gain, input, absl::MakeSpan(output));
+        else
+            sfz::multiplyAdd<float, true>(gain, input, absl::MakeSpan(output));
+        benchmark::DoNotOptimize(output.data());
+    }
+}
+
+BENCHMARK_DEFINE_F(Dispatch, LinearRamp)(benchmark::State& state) {
+    if (!select(state))
+        return;
+    for (auto _ : state)
+    {
+        if (scalar())
+            benchmark::DoNotOptimize(sfz::linearRamp<float, false>(absl::MakeSpan(output), 0.0f, 0.001f));
+        else
+            benchmark::DoNotOptimize(sfz::linearRamp<float, true>(absl::MakeSpan(output), 0.0f, 0.001f));
+    }
+}
+
+BENCHMARK_DEFINE_F(Dispatch, MultiplicativeRamp)(benchmark::State& state) {
+    if (!select(state))
+        return;
+    for (auto _ : state)
+    {
+        if (scalar())
+            benchmark::DoNotOptimize(sfz::multiplicativeRamp<float, false>(absl::MakeSpan(output), 1.0f, 0.9999f));
+        else
+            benchmark::DoNotOptimize(sfz::multiplicativeRamp<float, true>(absl::MakeSpan(output), 1.0f, 0.9999f));
+    }
+}
+
+BENCHMARK_DEFINE_F(Dispatch, Cumsum)(benchmark::State& state) {
+    if (!select(state))
+        return;
+    for (auto _ : state)
+    {
+        if (scalar())
+            sfz::cumsum<float, false>(input, absl::MakeSpan(output));
+        else
+            sfz::cumsum<float, true>(input, absl::MakeSpan(output));
+        benchmark::DoNotOptimize(output.data());
+    }
+}
+
+BENCHMARK_DEFINE_F(Dispatch, InterpolationCast)(benchmark::State& state) {
+    if (!select(state))
+        return;
+    for (auto _ : state)
+    {
+        if (scalar())
+            sfz::sfzInterpolationCast<float, false>(floatJumps, absl::MakeSpan(jumps), absl::MakeSpan(output), absl::MakeSpan(outputRight));
+        else
+            sfz::sfzInterpolationCast<float, true>(floatJumps, absl::MakeSpan(jumps), absl::MakeSpan(output), absl::MakeSpan(outputRight));
+        benchmark::DoNotOptimize(jumps.data());
+    }
+}
+
+BENCHMARK_DEFINE_F(Dispatch, Interpolate)(benchmark::State& state) {
+    if (!select(state))
+        return;
+    sfz::sfzInterpolationCast<float, false>(floatJumps, absl::MakeSpan(jumps), absl::MakeSpan(gain), absl::MakeSpan(outputRight));
+    for (auto _ : state)
+    {
+        if (scalar())
+            sfz::interpolate<float, false>(input, jumps, gain, outputRight, absl::MakeSpan(output));
+        else
+            sfz::interpolate<float, true>(input, jumps, gain, outputRight, absl::MakeSpan(output));
+        benchmark::DoNotOptimize(output.data());
+    }
+}
+
+BENCHMARK_DEFINE_F(Dispatch, ReadInterleaved)(benchmark::State& state) {
+    if (!select(state))
+        return;
+    for (auto _ : state)
+    {
+        if (scalar())
+            sfz::readInterleaved<float, false>(interleaved, absl::MakeSpan(output), absl::MakeSpan(outputRight));
+        else
+            sfz::readInterleaved<float, true>(interleaved, absl::MakeSpan(output), absl::MakeSpan(outputRight));
+        benchmark::DoNotOptimize(output.data());
+    }
+}
+
+BENCHMARK_DEFINE_F(Dispatch, WriteInterleaved)(benchmark::State& state) {
+    if (!select(state))
+        return;
+    for (auto _ : state)
+    {
+        if (scalar())
+            sfz::writeInterleaved<float, false>(input, gain, absl::MakeSpan(interleaved));
+        else
+            sfz::writeInterleaved<float, true>(input, gain, absl::MakeSpan(interleaved));
+        benchmark::DoNotOptimize(interleaved.data());
+    }
+}
+
+static void paths(benchmark::internal::Benchmark* benchmark)
+{
+    for (int size : { 256, 1024, 4096 })
+        for (auto path : { sfz::SIMDPath::scalar, sfz::SIMDPath::sse, sfz::SIMDPath::avx2, sfz::SIMDPath::avx512 })
+            benchmark->Args({ size, static_cast<int>(path) });
+}
+
+BENCHMARK_REGISTER_F(Dispatch, Gain)->Apply(paths);
+BENCHMARK_REGISTER_F(Dispatch, MultiplyAdd)->Apply(paths);
+BENCHMARK_REGISTER_F(Dispatch, LinearRamp)->Apply(paths);
+BENCHMARK_REGISTER_F(Dispatch, MultiplicativeRamp)->Apply(paths);
+BENCHMARK_REGISTER_F(Dispatch, Cumsum)->Apply(paths);
+BENCHMARK_REGISTER_F(Dispatch, InterpolationCast)->Apply(paths);
+BENCHMARK_REGISTER_F(Dispatch, Interpolate)->Apply(paths);
+BENCHMARK_REGISTER_F(Dispatch, ReadInterleaved)->Apply(paths);
+BENCHMARK_REGISTER_F(Dispatch, WriteInterleaved)->Apply(paths);
+BENCHMARK_MAIN();
@@ -0,0 +1,97 @@
+// Copyright (c) 2019, Paul Ferrand
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <numeric>
+#include <vector>
+#include <cmath>
+#include <iostream>
+#include "../sfizz/SIMDHelpers.h"
+
+// Cost of decoding 16 bit samples on read, compared to copying samples already stored as floats
+class Int16ToFloat : public benchmark::Fixture {
+public:
+  void SetUp(const ::benchmark::State& state) {
+    std::random_device rd { };
+    std::mt19937 gen { rd() };
+    std::uniform_int_distribution<int16_t> dist { std::numeric_limits<int16_t>::min(), std::numeric_limits<int16_t>::max() };
+    input = std::vector<int16_t>(state.range(0));
+    floatInput = std::vector<float>(state.range(0));
+    output = std::vector<float>(state.range(0));
+    std::generate(input.begin(), input.end(), [&]() { return dist(gen); });
+    std::transform(input.begin(), input.end(), floatInput.begin(), [](int16_t x) { return static_cast<float>(x); });
+  }
+
+  void TearDown(const ::benchmark::State& state [[maybe_unused]]) {
+
+  }
+
+  std::vector<int16_t> input;
+  std::vector<float> floatInput;
+  std::vector<float> output;
+};
+
+BENCHMARK_DEFINE_F(Int16ToFloat, FloatCopy)(benchmark::State& state) {
+    for (auto _ : state)
+    {
+        sfz::copy<float, true>(floatInput, absl::MakeSpan(output));
+    }
+}
+
+BENCHMARK_DEFINE_F(Int16ToFloat, Scalar)(benchmark::State& state) {
+    for (auto _ : state)
+    {
+        sfz::int16ToFloat<float, false>(input, absl::MakeSpan(output));
+    }
+}
+
+BENCHMARK_DEFINE_F(Int16ToFloat, SIMD)(benchmark::State& state) {
+    for (auto _ : state)
+    {
+        sfz::int16ToFloat<float, true>(input, absl::MakeSpan(output));
+    }
+}
+
+BENCHMARK_DEFINE_F(Int16ToFloat, Scalar_Unaligned)(benchmark::State& state) {
+    for (auto _ : state)
+    {
+        sfz::int16ToFloat<float, false>(absl::MakeSpan(input).subspan(1), absl::MakeSpan(output).subspan(1));
+    }
+}
+
+BENCHMARK_DEFINE_F(Int16ToFloat, SIMD_Unaligned)(benchmark::State& state) {
+    for (auto _ : state)
+    {
+        sfz::int16ToFloat<float, true>(absl::MakeSpan(input).subspan(1), absl::MakeSpan(output).subspan(1));
+    }
+}
+
+BENCHMARK_REGISTER_F(Int16ToFloat, FloatCopy)->RangeMultiplier(4)->Range(1 << 4, 1 << 16);
+BENCHMARK_REGISTER_F(Int16ToFloat, Scalar)->RangeMultiplier(4)->Range(1 << 4, 1 << 16);
+BENCHMARK_REGISTER_F(Int16ToFloat, SIMD)->RangeMultiplier(4)->Range(1 << 4, 1 << 16);
+BENCHMARK_REGISTER_F(Int16ToFloat, Scalar_Unaligned)->RangeMultiplier(4)->Range(1 << 4, 1 << 16);
+BENCHMARK_REGISTER_F(Int16ToFloat, SIMD_Unaligned)->RangeMultiplier(4)->Range(1 << 4, 1 << 16);
+BENCHMARK_MAIN();
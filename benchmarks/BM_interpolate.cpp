@@ -0,0 +1,152 @@
+// Copyright (c) 2019, Paul Ferrand
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "../sfizz/SIMDHelpers.h"
+
+// Resampling a stereo source the way the voices do, with a pitch ratio a bit above 1
+constexpr float pitchRatio { 1.3f };
+
+class Interpolate : public benchmark::Fixture {
+public:
+  void SetUp(const ::benchmark::State& state) {
+    std::random_device rd { };
+    std::mt19937 gen { rd() };
+    std::uniform_real_distribution<float> dist { -1.0f, 1.0f };
+    const auto numFrames = static_cast<size_t>(state.range(0));
+    const auto sourceSize = static_cast<size_t>(numFrames * pitchRatio) + 2;
+    leftSource = std::vector<float>(sourceSize);
+    rightSource = std::vector<float>(sourceSize);
+    std::generate(leftSource.begin(), leftSource.end(), [&]() { return dist(gen); });
+    std::generate(rightSource.begin(), rightSource.end(), [&]() { return dist(gen); });
+
+    jumps = std::vector<float>(numFrames);
+    indices = std::vector<int>(numFrames);
+    leftCoeffs = std::vector<float>(numFrames);
+    rightCoeffs = std::vector<float>(numFrames);
+    sfz::fill<float>(absl::MakeSpan(jumps), pitchRatio);
+    sfz::cumsum<float>(jumps, absl::MakeSpan(jumps));
+    sfz::sfzInterpolationCast<float>(jumps, absl::MakeSpan(indices), absl::MakeSpan(leftCoeffs), absl::MakeSpan(rightCoeffs));
+
+    leftOutput = std::vector<float>(numFrames);
+    rightOutput = std::vector<float>(numFrames);
+  }
+
+  void TearDown(const ::benchmark::State& state [[maybe_unused]]) {
+
+  }
+
+  std::vector<float> leftSource;
+  std::vector<float> rightSource;
+  std::vector<float> jumps;
+  std::vector<int> indices;
+  std::vector<float> leftCoeffs;
+  std::vector<float> rightCoeffs;
+  std::vector<float> leftOutput;
+  std::vector<float> rightOutput;
+};
+
+BENCHMARK_DEFINE_F(Interpolate, Scalar)(benchmark::State& state) {
+    for (auto _ : state)
+    {
+        sfz::interpolate<float, false>(leftSource, indices, leftCoeffs, rightCoeffs, absl::MakeSpan(leftOutput));
+        sfz::interpolate<float, false>(rightSource, indices, leftCoeffs, rightCoeffs, absl::MakeSpan(rightOutput));
+    }
+}
+
+BENCHMARK_DEFINE_F(Interpolate, SIMD)(benchmark::State& state) {
+    for (auto _ : state)
+    {
+        sfz::interpolate<float, true>(leftSource, indices, leftCoeffs, rightCoeffs, absl::MakeSpan(leftOutput));
+        sfz::interpolate<float, true>(rightSource, indices, leftCoeffs, rightCoeffs, absl::MakeSpan(rightOutput));
+    }
+}
+
+BENCHMARK_DEFINE_F(Interpolate, Stereo_Scalar)(benchmark::State& state) {
+    for (auto _ : state)
+    {
+        sfz::interpolateStereo<float, false>(leftSource, rightSource, indices, leftCoeffs, rightCoeffs, absl::MakeSpan(leftOutput), absl::MakeSpan(rightOutput));
+    }
+}
+
+BENCHMARK_DEFINE_F(Interpolate, Stereo_SIMD)(benchmark::State& state) {
+    for (auto _ : state)
+    {
+        sfz::interpolateStereo<float, true>(leftSource, rightSource, indices, leftCoeffs, rightCoeffs, absl::MakeSpan(leftOutput), absl::MakeSpan(rightOutput));
+    }
+}
+
+BENCHMARK_DEFINE_F(Interpolate, Stereo_SIMD_Unaligned)(benchmark::State& state) {
+    for (auto _ : state)
+    {
+        sfz::interpolateStereo<float, true>(leftSource, rightSource, absl::MakeSpan(indices).subspan(1), absl::MakeSpan(leftCoeffs).subspan(1),
+            absl::MakeSpan(rightCoeffs).subspan(1), absl::MakeSpan(leftOutput).subspan(1), absl::MakeSpan(rightOutput).subspan(1));
+    }
+}
+
+// The higher quality kernels, to compare with the linear interpolation above
+BENCHMARK_DEFINE_F(Interpolate, Hermite_Scalar)(benchmark::State& state) {
+    for (auto _ : state)
+    {
+        sfz::interpolateHermite<float, false>(leftSource, indices, rightCoeffs, absl::MakeSpan(leftOutput));
+        sfz::interpolateHermite<float, false>(rightSource, indices, rightCoeffs, absl::MakeSpan(rightOutput));
+    }
+}
+
+BENCHMARK_DEFINE_F(Interpolate, Hermite_SIMD)(benchmark::State& state) {
+    for (auto _ : state)
+    {
+        sfz::interpolateHermite<float, true>(leftSource, indices, rightCoeffs, absl::MakeSpan(leftOutput));
+        sfz::interpolateHermite<float, true>(rightSource, indices, rightCoeffs, absl::MakeSpan(rightOutput));
+    }
+}
+
+BENCHMARK_DEFINE_F(Interpolate, Sinc_Scalar)(benchmark::State& state) {
+    for (auto _ : state)
+    {
+        sfz::interpolateSinc<float, false>(leftSource, indices, rightCoeffs, absl::MakeSpan(leftOutput));
+        sfz::interpolateSinc<float, false>(rightSource, indices, rightCoeffs, absl::MakeSpan(rightOutput));
+    }
+}
+
+BENCHMARK_DEFINE_F(Interpolate, Sinc_SIMD)(benchmark::State& state) {
+    for (auto _ : state)
+    {
+        sfz::interpolateSinc<float, true>(leftSource, indices, rightCoeffs, absl::MakeSpan(leftOutput));
+        sfz::interpolateSinc<float, true>(rightSource, indices, rightCoeffs, absl::MakeSpan(rightOutput));
+    }
+}
+
+BENCHMARK_REGISTER_F(Interpolate, Scalar)->RangeMultiplier(4)->Range(1 << 4, 1 << 16);
+BENCHMARK_REGISTER_F(Interpolate, SIMD)->RangeMultiplier(4)->Range(1 << 4, 1 << 16);
+BENCHMARK_REGISTER_F(Interpolate, Stereo_Scalar)->RangeMultiplier(4)->Range(1 << 4, 1 << 16);
+BENCHMARK_REGISTER_F(Interpolate, Stereo_SIMD)->RangeMultiplier(4)->Range(1 << 4, 1 << 16);
+BENCHMARK_REGISTER_F(Interpolate, Stereo_SIMD_Unaligned)->RangeMultiplier(4)->Range(1 << 4, 1 << 16);
+BENCHMARK_REGISTER_F(Interpolate, Hermite_Scalar)->RangeMultiplier(4)->Range(1 << 4, 1 << 16);
+BENCHMARK_REGISTER_F(Interpolate, Hermite_SIMD)->RangeMultiplier(4)->Range(1 << 4, 1 << 16);
+BENCHMARK_REGISTER_F(Interpolate, Sinc_Scalar)->RangeMultiplier(4)->Range(1 << 4, 1 << 16);
+BENCHMARK_REGISTER_F(Interpolate, Sinc_SIMD)->RangeMultiplier(4)->Range(1 << 4, 1 << 16);
+BENCHMARK_MAIN();
@@ -41,8 +41,10 @@ public:
     left = std::vector<float>(state.range(0));
     right = std::vector<float>(state.range(0));
     std::generate(pan.begin(), pan.end(), [&]() { return dist(gen); });
-    std::generate(right.begin(), right.end(), [&]() { return dist(gen); });
-    std::generate(left.begin(), left.end(), [&]() { return dist(gen); });
+    inputLeft = std::vector<float>(state.range(0));
+    inputRight = std::vector<float>(state.range(0));
+    std::generate(inputRight.begin(), inputRight.end(), [&]() { return dist(gen); });
+    std::generate(inputLeft.begin(), inputLeft.end(), [&]() { return dist(gen); });
     temp1 = std::vector<float>(state.range(0));
     temp2 = std::vector<float>(state.range(0));
     span1 = absl::MakeSpan(temp1);
@@ -53,6 +55,9 @@ public:
 
   }
 
+  // Copied into the buffers on each iteration so that the repeated gains do not decay into denormals
+  std::vector<float> inputLeft;
+  std::vector<float> inputRight;
   std::vector<float> pan;
   std::vector<float> left;
   std::vector<float> right;
@@ -66,6 +71,8 @@ public:
 BENCHMARK_DEFINE_F(PanArray, Scalar)(benchmark::State& state) {
     for (auto _ : state)
     {
+        sfz::copy<float>(inputLeft, absl::MakeSpan(left));
+        sfz::copy<float>(inputRight, absl::MakeSpan(right));
         sfz::pan<float, false>(pan, absl::MakeSpan(left), absl::MakeSpan(right));
     }
 }
@@ -73,13 +80,35 @@ BENCHMARK_DEFINE_F(PanArray, Scalar)(benchmark::State& state) {
 BENCHMARK_DEFINE_F(PanArray, SIMD)(benchmark::State& state) {
     for (auto _ : state)
     {
+        sfz::copy<float>(inputLeft, absl::MakeSpan(left));
+        sfz::copy<float>(inputRight, absl::MakeSpan(right));
         sfz::pan<float, true>(pan, absl::MakeSpan(left), absl::MakeSpan(right));
     }
 }
 
+BENCHMARK_DEFINE_F(PanArray, Table_Scalar)(benchmark::State& state) {
+    for (auto _ : state)
+    {
+        sfz::copy<float>(inputLeft, absl::MakeSpan(left));
+        sfz::copy<float>(inputRight, absl::MakeSpan(right));
+        sfz::tablePan<float, false>(pan, absl::MakeSpan(left), absl::MakeSpan(right));
+    }
+}
+
+BENCHMARK_DEFINE_F(PanArray, Table_SIMD)(benchmark::State& state) {
+    for (auto _ : state)
+    {
+        sfz::copy<float>(inputLeft, absl::MakeSpan(left));
+        sfz::copy<float>(inputRight, absl::MakeSpan(right));
+        sfz::tablePan<float, true>(pan, absl::MakeSpan(left), absl::MakeSpan(right));
+    }
+}
+
 BENCHMARK_DEFINE_F(PanArray, BlockOps)(benchmark::State& state) {
     for (auto _ : state)
     {
+        sfz::copy<float>(inputLeft, absl::MakeSpan(left));
+        sfz::copy<float>(inputRight, absl::MakeSpan(right));
         sfz::fill<float>(span2, 1.0f);
         sfz::add<float>(span1, span2);
         sfz::applyGain<float>(piFour<float>, span2);
@@ -92,5 +121,7 @@ BENCHMARK_DEFINE_F(PanArray, BlockOps)(benchmark::State& state) {
 
 BENCHMARK_REGISTER_F(PanArray, Scalar)->RangeMultiplier(4)->Range(1 << 2, 1 << 12);
 BENCHMARK_REGISTER_F(PanArray, SIMD)->RangeMultiplier(4)->Range(1 << 2, 1 << 12);
+BENCHMARK_REGISTER_F(PanArray, Table_Scalar)->RangeMultiplier(4)->Range(1 << 2, 1 << 12);
+BENCHMARK_REGISTER_F(PanArray, Table_SIMD)->RangeMultiplier(4)->Range(1 << 2, 1 << 12);
 BENCHMARK_REGISTER_F(PanArray, BlockOps)->RangeMultiplier(4)->Range(1 << 2, 1 << 12);
 BENCHMARK_MAIN();
\ No newline at end of file
@@ -0,0 +1,93 @@
+// Copyright (c) 2019, Paul Ferrand
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <benchmark/benchmark.h>
+#include <vector>
+#include "../sfizz/SIMDHelpers.h"
+
+// Computing the indices and coefficients of a block of sample playback, in separate passes or in the fused phase accumulator
+constexpr float pitchRatio { 1.3f };
+constexpr int sampleEnd { 1 << 20 };
+
+class PhaseIndex : public benchmark::Fixture {
+public:
+  void SetUp(const ::benchmark::State& state) {
+    jumps = std::vector<float>(state.range(0));
+    indices = std::vector<int>(state.range(0));
+    leftCoeffs = std::vector<float>(state.range(0));
+    rightCoeffs = std::vector<float>(state.range(0));
+  }
+
+  void TearDown(const ::benchmark::State& state [[maybe_unused]]) {
+
+  }
+
+  std::vector<float> jumps;
+  std::vector<int> indices;
+  std::vector<float> leftCoeffs;
+  std::vector<float> rightCoeffs;
+};
+
+BENCHMARK_DEFINE_F(PhaseIndex, Passes)(benchmark::State& state) {
+    for (auto _ : state)
+    {
+        int position { 0 };
+        sfz::fill<float>(absl::MakeSpan(jumps), pitchRatio);
+        jumps[0] += 0.5f;
+        sfz::cumsum<float>(jumps, absl::MakeSpan(jumps));
+        sfz::sfzInterpolationCast<float>(jumps, absl::MakeSpan(indices), absl::MakeSpan(leftCoeffs), absl::MakeSpan(rightCoeffs));
+        sfz::add<int>(position, absl::MakeSpan(indices));
+        for (auto* index = indices.data(); index < indices.data() + indices.size(); ++index) {
+            if (*index > sampleEnd) {
+                sfz::fill<int>(absl::MakeSpan(index, indices.data() + indices.size() - index), sampleEnd);
+                break;
+            }
+        }
+        benchmark::DoNotOptimize(indices.back());
+    }
+}
+
+BENCHMARK_DEFINE_F(PhaseIndex, Scalar)(benchmark::State& state) {
+    for (auto _ : state)
+    {
+        int position { 0 };
+        float phase { 0.5f };
+        sfz::phaseIndex<float, false>(pitchRatio, position, phase, sampleEnd, 0, false, absl::MakeSpan(indices), absl::MakeSpan(leftCoeffs), absl::MakeSpan(rightCoeffs));
+        benchmark::DoNotOptimize(position);
+    }
+}
+
+BENCHMARK_DEFINE_F(PhaseIndex, SIMD)(benchmark::State& state) {
+    for (auto _ : state)
+    {
+        int position { 0 };
+        float phase { 0.5f };
+        sfz::phaseIndex<float, true>(pitchRatio, position, phase, sampleEnd, 0, false, absl::MakeSpan(indices), absl::MakeSpan(leftCoeffs), absl::MakeSpan(rightCoeffs));
+        benchmark::DoNotOptimize(position);
+    }
+}
+
+BENCHMARK_REGISTER_F(PhaseIndex, Passes)->RangeMultiplier(4)->Range(1 << 4, 1 << 16);
+BENCHMARK_REGISTER_F(PhaseIndex, Scalar)->RangeMultiplier(4)->Range(1 << 4, 1 << 16);
+BENCHMARK_REGISTER_F(PhaseIndex, SIMD)->RangeMultiplier(4)->Range(1 << 4, 1 << 16);
+BENCHMARK_MAIN();
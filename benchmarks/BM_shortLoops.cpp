@@ -0,0 +1,91 @@
+// Copyright (c) 2019, Paul Ferrand
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <benchmark/benchmark.h>
+#include <vector>
+#include "../sfizz/SIMDHelpers.h"
+
+// Playback indices for a 10 frame loop read at 4 times the speed, which wraps every few frames
+constexpr float pitchRatio { 4.0f };
+constexpr int loopStart { 100 };
+constexpr int loopEnd { 109 };
+
+class ShortLoops : public benchmark::Fixture {
+public:
+  void SetUp(const ::benchmark::State& state) {
+    jumps = std::vector<float>(state.range(0));
+    indices = std::vector<int>(state.range(0));
+    leftCoeffs = std::vector<float>(state.range(0));
+    rightCoeffs = std::vector<float>(state.range(0));
+  }
+
+  void TearDown(const ::benchmark::State& state [[maybe_unused]]) {
+
+  }
+
+  std::vector<float> jumps;
+  std::vector<int> indices;
+  std::vector<float> leftCoeffs;
+  std::vector<float> rightCoeffs;
+};
+
+// What the voices used to do: every index past the end shifts the whole remaining block back
+BENCHMARK_DEFINE_F(ShortLoops, TailCorrection)(benchmark::State& state) {
+    for (auto _ : state)
+    {
+        sfz::fill<float>(absl::MakeSpan(jumps), pitchRatio);
+        sfz::cumsum<float>(jumps, absl::MakeSpan(jumps));
+        sfz::sfzInterpolationCast<float>(jumps, absl::MakeSpan(indices), absl::MakeSpan(leftCoeffs), absl::MakeSpan(rightCoeffs));
+        sfz::add<int>(loopStart, absl::MakeSpan(indices));
+        for (auto* index = indices.data(); index < indices.data() + indices.size(); ++index) {
+            if (*index > loopEnd)
+                sfz::subtract<int>(loopEnd - loopStart + 1, absl::MakeSpan(index, indices.data() + indices.size() - index));
+        }
+        benchmark::DoNotOptimize(indices.back());
+    }
+}
+
+BENCHMARK_DEFINE_F(ShortLoops, Scalar)(benchmark::State& state) {
+    for (auto _ : state)
+    {
+        int position { loopStart };
+        float phase { 0.0f };
+        sfz::phaseIndex<float, false>(pitchRatio, position, phase, loopEnd, loopStart, true, absl::MakeSpan(indices), absl::MakeSpan(leftCoeffs), absl::MakeSpan(rightCoeffs));
+        benchmark::DoNotOptimize(position);
+    }
+}
+
+BENCHMARK_DEFINE_F(ShortLoops, SIMD)(benchmark::State& state) {
+    for (auto _ : state)
+    {
+        int position { loopStart };
+        float phase { 0.0f };
+        sfz::phaseIndex<float, true>(pitchRatio, position, phase, loopEnd, loopStart, true, absl::MakeSpan(indices), absl::MakeSpan(leftCoeffs), absl::MakeSpan(rightCoeffs));
+        benchmark::DoNotOptimize(position);
+    }
+}
+
+BENCHMARK_REGISTER_F(ShortLoops, TailCorrection)->RangeMultiplier(4)->Range(1 << 4, 1 << 12);
+BENCHMARK_REGISTER_F(ShortLoops, Scalar)->RangeMultiplier(4)->Range(1 << 4, 1 << 12);
+BENCHMARK_REGISTER_F(ShortLoops, SIMD)->RangeMultiplier(4)->Range(1 << 4, 1 << 12);
+BENCHMARK_MAIN();
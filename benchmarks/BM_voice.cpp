@@ -0,0 +1,208 @@
+// Copyright (c) 2019, Paul Ferrand
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "../sfizz/SIMDHelpers.h"
+
+// Gain and stereo stages of a voice, once the envelopes have rendered their blocks; each iteration
+// starts from fresh source data as the stages work in place
+class VoiceGains : public benchmark::Fixture {
+public:
+  void SetUp(const ::benchmark::State& state) {
+    std::random_device rd { };
+    std::mt19937 gen { rd() };
+    std::uniform_real_distribution<float> dist { -1.0f, 1.0f };
+    const auto numFrames = static_cast<size_t>(state.range(0));
+    for (auto* vector : { &amplitude, &eg, &volume, &pan, &width, &position, &inputLeft, &inputRight }) {
+        *vector = std::vector<float>(numFrames);
+        std::generate(vector->begin(), vector->end(), [&]() { return dist(gen); });
+    }
+    left = std::vector<float>(numFrames);
+    right = std::vector<float>(numFrames);
+    temp1 = std::vector<float>(numFrames);
+    temp2 = std::vector<float>(numFrames);
+    temp3 = std::vector<float>(numFrames);
+  }
+
+  void TearDown(const ::benchmark::State& state [[maybe_unused]]) {
+
+  }
+
+  std::vector<float> amplitude;
+  std::vector<float> eg;
+  std::vector<float> volume;
+  std::vector<float> pan;
+  std::vector<float> width;
+  std::vector<float> position;
+  std::vector<float> inputLeft;
+  std::vector<float> inputRight;
+  std::vector<float> left;
+  std::vector<float> right;
+  std::vector<float> temp1;
+  std::vector<float> temp2;
+  std::vector<float> temp3;
+};
+
+// What the mono voices used to do, one pass per operation
+BENCHMARK_DEFINE_F(VoiceGains, Mono_BlockOps)(benchmark::State& state) {
+    auto leftBuffer = absl::MakeSpan(left);
+    auto rightBuffer = absl::MakeSpan(right);
+    auto span1 = absl::MakeSpan(temp1);
+    auto span2 = absl::MakeSpan(temp2);
+    for (auto _ : state)
+    {
+        sfz::copy<float>(inputLeft, absl::MakeSpan(left));
+        sfz::copy<float>(amplitude, span1);
+        sfz::applyGain<float>(span1, leftBuffer);
+        sfz::copy<float>(eg, span1);
+        sfz::applyGain<float>(span1, leftBuffer);
+        sfz::copy<float>(volume, span1);
+        sfz::applyGain<float>(span1, leftBuffer);
+        sfz::copy<float>(leftBuffer, rightBuffer);
+        sfz::copy<float>(pan, span1);
+        sfz::fill<float>(span2, 1.0f);
+        sfz::add<float>(span1, span2);
+        sfz::applyGain<float>(piFour<float>, span2);
+        sfz::cos<float>(span2, span1);
+        sfz::sin<float>(span2, span2);
+        sfz::applyGain<float>(span1, leftBuffer);
+        sfz::applyGain<float>(span2, rightBuffer);
+    }
+}
+
+BENCHMARK_DEFINE_F(VoiceGains, Mono_Scalar)(benchmark::State& state) {
+    for (auto _ : state)
+    {
+        sfz::copy<float>(inputLeft, absl::MakeSpan(left));
+        sfz::applyGainAndPan<float, false>(amplitude, eg, volume, pan, absl::MakeSpan(left), absl::MakeSpan(right));
+    }
+}
+
+BENCHMARK_DEFINE_F(VoiceGains, Mono_SIMD)(benchmark::State& state) {
+    for (auto _ : state)
+    {
+        sfz::copy<float>(inputLeft, absl::MakeSpan(left));
+        sfz::applyGainAndPan<float, true>(amplitude, eg, volume, pan, absl::MakeSpan(left), absl::MakeSpan(right));
+    }
+}
+
+// What the stereo voices used to do, one pass per operation
+BENCHMARK_DEFINE_F(VoiceGains, Stereo_BlockOps)(benchmark::State& state) {
+    auto leftBuffer = absl::MakeSpan(left);
+    auto rightBuffer = absl::MakeSpan(right);
+    auto span1 = absl::MakeSpan(temp1);
+    auto span2 = absl::MakeSpan(temp2);
+    auto span3 = absl::MakeSpan(temp3);
+    for (auto _ : state)
+    {
+        sfz::copy<float>(inputLeft, absl::MakeSpan(left));
+        sfz::copy<float>(inputRight, absl::MakeSpan(right));
+        for (const auto* envelope : { &amplitude, &eg, &volume }) {
+            sfz::copy<float>(*envelope, span1);
+            sfz::applyGain<float>(span1, leftBuffer);
+            sfz::applyGain<float>(span1, rightBuffer);
+        }
+        sfz::copy<float>(rightBuffer, span1);
+        sfz::add<float>(leftBuffer, rightBuffer);
+        sfz::subtract<float>(span1, leftBuffer);
+        sfz::applyGain<float>(sqrtTwoInv<float>, leftBuffer);
+        sfz::applyGain<float>(sqrtTwoInv<float>, rightBuffer);
+        sfz::copy<float>(width, span1);
+        sfz::fill<float>(span2, 1.0f);
+        sfz::add<float>(span1, span2);
+        sfz::applyGain<float>(piFour<float>, span2);
+        sfz::cos<float>(span2, span1);
+        sfz::sin<float>(span2, span2);
+        sfz::applyGain<float>(span1, leftBuffer);
+        sfz::applyGain<float>(span2, rightBuffer);
+        sfz::copy<float>(position, span1);
+        sfz::fill<float>(span2, 1.0f);
+        sfz::add<float>(span1, span2);
+        sfz::applyGain<float>(piFour<float>, span2);
+        sfz::cos<float>(span2, span1);
+        sfz::sin<float>(span2, span2);
+        sfz::copy<float>(leftBuffer, span3);
+        sfz::copy<float>(rightBuffer, leftBuffer);
+        sfz::multiplyAdd<float>(span1, span3, leftBuffer);
+        sfz::multiplyAdd<float>(span2, span3, rightBuffer);
+        sfz::applyGain<float>(sqrtTwoInv<float>, leftBuffer);
+        sfz::applyGain<float>(sqrtTwoInv<float>, rightBuffer);
+    }
+}
+
+BENCHMARK_DEFINE_F(VoiceGains, Stereo_Scalar)(benchmark::State& state) {
+    for (auto _ : state)
+    {
+        sfz::copy<float>(inputLeft, absl::MakeSpan(left));
+        sfz::copy<float>(inputRight, absl::MakeSpan(right));
+        sfz::applyGainWidthAndPosition<float, false>(amplitude, eg, volume, width, position, absl::MakeSpan(left), absl::MakeSpan(right));
+    }
+}
+
+BENCHMARK_DEFINE_F(VoiceGains, Stereo_SIMD)(benchmark::State& state) {
+    for (auto _ : state)
+    {
+        sfz::copy<float>(inputLeft, absl::MakeSpan(left));
+        sfz::copy<float>(inputRight, absl::MakeSpan(right));
+        sfz::applyGainWidthAndPosition<float, true>(amplitude, eg, volume, width, position, absl::MakeSpan(left), absl::MakeSpan(right));
+    }
+}
+
+// Sustained notes without any change in the envelopes fold the stages into scalar gains
+BENCHMARK_DEFINE_F(VoiceGains, Mono_Constant)(benchmark::State& state) {
+    for (auto _ : state)
+    {
+        sfz::copy<float>(inputLeft, absl::MakeSpan(left));
+        const auto gain = amplitude[0] * eg[0] * volume[0];
+        const auto circlePan = piFour<float> * (1.0f + pan[0]);
+        sfz::applyGain<float>(gain * std::sin(circlePan), left, absl::MakeSpan(right));
+        sfz::applyGain<float>(gain * std::cos(circlePan), absl::MakeSpan(left));
+    }
+}
+
+BENCHMARK_DEFINE_F(VoiceGains, Stereo_Constant)(benchmark::State& state) {
+    for (auto _ : state)
+    {
+        sfz::copy<float>(inputLeft, absl::MakeSpan(left));
+        sfz::copy<float>(inputRight, absl::MakeSpan(right));
+        const auto gain = amplitude[0] * eg[0] * volume[0] * 0.5f;
+        const auto mid = gain * std::sin(piFour<float> * (1.0f + width[0]));
+        const auto side = gain * std::cos(piFour<float> * (1.0f + width[0]));
+        const auto leftSide = side * std::cos(piFour<float> * (1.0f + position[0]));
+        const auto rightSide = side * std::sin(piFour<float> * (1.0f + position[0]));
+        sfz::mixStereo<float>(mid + leftSide, mid - leftSide, mid + rightSide, mid - rightSide, absl::MakeSpan(left), absl::MakeSpan(right));
+    }
+}
+
+BENCHMARK_REGISTER_F(VoiceGains, Mono_BlockOps)->RangeMultiplier(4)->Range(1 << 4, 1 << 12);
+BENCHMARK_REGISTER_F(VoiceGains, Mono_Scalar)->RangeMultiplier(4)->Range(1 << 4, 1 << 12);
+BENCHMARK_REGISTER_F(VoiceGains, Mono_SIMD)->RangeMultiplier(4)->Range(1 << 4, 1 << 12);
+BENCHMARK_REGISTER_F(VoiceGains, Stereo_BlockOps)->RangeMultiplier(4)->Range(1 << 4, 1 << 12);
+BENCHMARK_REGISTER_F(VoiceGains, Stereo_Scalar)->RangeMultiplier(4)->Range(1 << 4, 1 << 12);
+BENCHMARK_REGISTER_F(VoiceGains, Stereo_SIMD)->RangeMultiplier(4)->Range(1 << 4, 1 << 12);
+BENCHMARK_REGISTER_F(VoiceGains, Mono_Constant)->RangeMultiplier(4)->Range(1 << 4, 1 << 12);
+BENCHMARK_REGISTER_F(VoiceGains, Stereo_Constant)->RangeMultiplier(4)->Range(1 << 4, 1 << 12);
+BENCHMARK_MAIN();
@@ -22,7 +22,9 @@
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "AudioSpan.h"
+#include "SIMDHelpers.h"
 #include "Synth.h"
+#include <absl/flags/flag.h>
 #include <absl/flags/parse.h>
 #include <absl/types/span.h>
 #include <atomic>
@@ -39,6 +41,12 @@
 #include <thread>
 using namespace std::literals;
 
+ABSL_FLAG(std::string, preload_cache, "", "Directory where the decoded sample preloads are kept between runs");
+ABSL_FLAG(int, memory_budget, 0, "Memory budget for the sample data in MB; 0 means no limit");
+ABSL_FLAG(bool, lazy_keyswitches, false, "Preload the keyswitched articulations in the background once selected");
+ABSL_FLAG(bool, lock_memory, true, "Lock the sample data in RAM");
+ABSL_FLAG(bool, huge_pages, false, "Back the locked sample data with transparent huge pages");
+
 static jack_port_t* midiInputPort;
 static jack_port_t* outputPort1;
 static jack_port_t* outputPort2;
@@ -168,6 +176,11 @@ int main(int argc, char** argv)
     std::cout << '\n';
 
     sfz::Synth synth;
+    synth.setCacheDirectory(absl::GetFlag(FLAGS_preload_cache));
+    synth.setMemoryBudget(static_cast<size_t>(absl::GetFlag(FLAGS_memory_budget)) * 1024 * 1024);
+    synth.setLazyKeyswitchPreload(absl::GetFlag(FLAGS_lazy_keyswitches));
+    if (absl::GetFlag(FLAGS_lock_memory))
+        synth.setMemoryLocking(absl::GetFlag(FLAGS_huge_pages) ? sfz::SampleBuffer::Locking::lockedHugePages : sfz::SampleBuffer::Locking::locked);
     synth.loadSfzFile(filesToParse[0]);
     std::cout << "==========" << '\n';
     std::cout << "Total:" << '\n';
@@ -176,6 +189,9 @@ int main(int argc, char** argv)
     std::cout << "\tRegions: " << synth.getNumRegions() << '\n';
     std::cout << "\tCurves: " << synth.getNumCurves() << '\n';
     std::cout << "\tPreloadedSamples: " << synth.getNumPreloadedSamples() << '\n';
+    std::cout << "\tPreloadedMemory: " << synth.getPreloadedBytes() / 1024 << " kB" << '\n';
+    std::cout << "\tLockedMemory: " << synth.getMemoryStats().lockedBytes / 1024 << " kB" << '\n';
+    std::cout << "\tSIMD: " << sfz::simdPathName(sfz::getSIMDPath()) << '\n';
     std::cout << "==========" << '\n';
     std::cout << "Included files:" << '\n';
     for (auto& file : synth.getIncludedFiles())
@@ -258,6 +274,14 @@ int main(int argc, char** argv)
         std::this_thread::sleep_for(1s);
     }
 
+    const auto loadingStats = synth.getLoadingStats();
+    std::cout << "Loading queue: " << loadingStats.highWaterMark << '/' << loadingStats.capacity << " used at most, "
+              << loadingStats.numDropped << " dropped, " << loadingStats.numFailed << " failed, "
+              << loadingStats.numCoalesced << " coalesced" << '\n';
+    const auto memoryStats = synth.getMemoryStats();
+    std::cout << "Sample memory: " << (memoryStats.preloadedBytes + memoryStats.streamingBytes) / 1024 << " kB, "
+              << memoryStats.numEvictions << " preloads shrunk (" << memoryStats.evictedBytes / 1024 << " kB), "
+              << memoryStats.numRetireOverflows << " retire overflows" << '\n';
     std::cout << "Closing..." << '\n';
     jack_client_close(client);
     return 0;
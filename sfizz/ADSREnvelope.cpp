@@ -26,6 +26,9 @@
 #include "SIMDHelpers.h"
 #include "MathHelpers.h"
 
+#include <algorithm>
+#include <limits>
+
 namespace sfz {
 
 template <class Type>
@@ -37,18 +40,20 @@ void ADSREnvelope<Type>::reset(int attack, int release, Type sustain, int delay,
     sustain = clamp<Type>(sustain, 0.0, 1.0);
     start = clamp<Type>(start, 0.0, 1.0);
 
-    currentState = State::Done;
-    this->delay = delay;
-    this->attack = attack;
-    this->decay = decay;
-    this->release = release;
-    this->hold = hold;
+    this->delay = std::max(delay, 0);
+    this->attack = std::max(attack, 0);
+    this->decay = std::max(decay, 0);
+    this->release = std::max(release, 0);
+    this->hold = std::max(hold, 0);
     this->start = depth * start;
     this->sustain = depth * sustain;
     this->peak = depth;
+    // The release step depends on the level the release starts from, so it is only known then
+    attackStep = (peak - this->start) / (attack > 0 ? attack : 1);
+    decayStep = peak > 0 ? std::pow(this->sustain / peak, Type { 1 } / (decay > 0 ? decay : 1)) : Type { 1 };
+    releaseStep = 1.0;
     releaseDelay = 0;
     shouldRelease = false;
-    step = 0.0;
     currentValue = this->start;
     currentState = State::Delay;
 }
@@ -56,161 +61,156 @@ void ADSREnvelope<Type>::reset(int attack, int release, Type sustain, int delay,
 template <class Type>
 Type ADSREnvelope<Type>::getNextValue() noexcept
 {
-    if (shouldRelease && releaseDelay-- == 0) {
-        currentState = State::Release;
-        step = std::exp((std::log(config::virtuallyZero) - std::log(currentValue)) / (release > 0 ? release : 1));
+    Type value;
+    getBlock(absl::MakeSpan(&value, 1));
+    return value;
+}
+
+template <class Type>
+void ADSREnvelope<Type>::settle() noexcept
+{
+    if (shouldRelease && releaseDelay == 0) {
+        shouldRelease = false;
+        if (currentState != State::Done) {
+            currentState = State::Release;
+            // Reach virtuallyZero at the end of the release, whatever the level it starts from
+            releaseStep = (currentValue > config::virtuallyZero && release > 0)
+                ? std::pow(config::virtuallyZero / currentValue, Type { 1 } / release)
+                : Type { 1 };
+        }
     }
 
+    while (true) {
+        switch (currentState) {
+        case State::Delay:
+            if (delay > 0)
+                return;
+            currentState = State::Attack;
+            break;
+        case State::Attack:
+            if (attack > 0)
+                return;
+            currentValue = peak;
+            currentState = State::Hold;
+            break;
+        case State::Hold:
+            if (hold > 0)
+                return;
+            currentState = State::Decay;
+            break;
+        case State::Decay:
+            if (decay > 0)
+                return;
+            currentValue = sustain;
+            currentState = State::Sustain;
+            break;
+        case State::Release:
+            if (release > 0)
+                return;
+            currentValue = 0.0;
+            currentState = State::Done;
+            return;
+        case State::Sustain:
+        case State::Done:
+        default:
+            return;
+        }
+    }
+}
+
+template <class Type>
+int ADSREnvelope<Type>::segmentLength() const noexcept
+{
+    int length;
     switch (currentState) {
     case State::Delay:
-        if (delay-- > 0)
-            return start;
-
-        currentState = State::Attack;
-        step = (1.0 - currentValue) / (attack > 0 ? attack : 1);
-        [[fallthrough]];
+        length = delay;
+        break;
     case State::Attack:
-        if (attack-- > 0) {
-            currentValue += step;
-            return currentValue;
-        }
-
-        currentState = State::Hold;
-        currentValue = 1.0;
-        [[fallthrough]];
+        length = attack;
+        break;
     case State::Hold:
-        if (hold-- > 0)
-            return currentValue;
-
-        step = std::exp(std::log(sustain) / (decay > 0 ? decay : 1));
-        currentState = State::Decay;
-        [[fallthrough]];
+        length = hold;
+        break;
     case State::Decay:
-        if (decay-- > 0) {
-            currentValue *= step;
-            return currentValue;
-        }
-
-        currentState = State::Sustain;
-        currentValue = sustain;
-        [[fallthrough]];
-    case State::Sustain:
-        return currentValue;
+        length = decay;
+        break;
     case State::Release:
-        if (release-- > 0) {
-            currentValue *= step;
-            return currentValue;
-        }
-
-        currentState = State::Done;
-        currentValue = 0.0;
-        [[fallthrough]];
+        length = release;
+        break;
+    case State::Sustain:
+    case State::Done:
     default:
-        return 0.0;
+        length = std::numeric_limits<int>::max();
+        break;
     }
+    return shouldRelease ? min(length, releaseDelay) : length;
 }
 
 template <class Type>
-void ADSREnvelope<Type>::getBlock(absl::Span<Type> output) noexcept
+void ADSREnvelope<Type>::advance(int length) noexcept
 {
-    auto originalSpan = output;
-    auto remainingSamples = static_cast<int>(output.size());
-    int length;
     switch (currentState) {
     case State::Delay:
-        length = min(remainingSamples, delay);
-        fill<Type>(output, currentValue);
-        output.remove_prefix(length);
-        remainingSamples -= length;
         delay -= length;
-        if (remainingSamples == 0)
-            break;
-
-        currentState = State::Attack;
-        step = (peak - start) / (attack > 0 ? attack : 1);
-        [[fallthrough]];
+        break;
     case State::Attack:
-        length = min(remainingSamples, attack);
-        currentValue = linearRamp<Type>(output, currentValue, step);
-        output.remove_prefix(length);
-        remainingSamples -= length;
         attack -= length;
-        if (remainingSamples == 0)
-            break;
-
-        currentValue = peak;
-        currentState = State::Hold;
-        [[fallthrough]];
+        break;
     case State::Hold:
-        length = min(remainingSamples, hold);
-        fill<Type>(output, currentValue);
-        output.remove_prefix(length);
-        remainingSamples -= length;
         hold -= length;
-        if (remainingSamples == 0)
-            break;
-
-        step = std::exp(std::log(sustain) / (decay > 0 ? decay : 1));
-        currentState = State::Decay;
-        [[fallthrough]];
+        break;
     case State::Decay:
-        length = min(remainingSamples, decay);
-        currentValue = multiplicativeRamp<Type>(output, currentValue, step);
-        output.remove_prefix(length);
-        remainingSamples -= length;
         decay -= length;
-        if (remainingSamples == 0)
-            break;
-
-        currentValue = sustain;
-        currentState = State::Sustain;
-        [[fallthrough]];
-    case State::Sustain:
         break;
     case State::Release:
-        length = min(remainingSamples, release);
-        currentValue = multiplicativeRamp<Type>(output, currentValue, step);
-        output.remove_prefix(length);
-        remainingSamples -= length;
         release -= length;
-        if (remainingSamples == 0)
-            break;
-
-        currentValue = 0.0;
-        currentState = State::Done;
-        [[fallthrough]];
+        break;
+    case State::Sustain:
     case State::Done:
-        [[fallthrough]];
     default:
         break;
     }
-    fill<Type>(output, currentValue);
-
-    if (shouldRelease) {
-        remainingSamples = static_cast<int>(originalSpan.size());
-        if (releaseDelay > remainingSamples) {
-            releaseDelay -= remainingSamples;
-            return;
-        }
 
-        originalSpan.remove_prefix(releaseDelay);
-        if (originalSpan.size() > 0)
-            currentValue = originalSpan.front();
-        step = std::exp((std::log(config::virtuallyZero) - std::log(currentValue)) / (release > 0 ? release : 1));
-        remainingSamples -= releaseDelay;
-        length = min(remainingSamples, release);
-        currentState = State::Release;
-        currentValue = multiplicativeRamp<Type>(originalSpan, currentValue, step);
-        originalSpan.remove_prefix(length);
-        release -= length;
+    if (shouldRelease)
+        releaseDelay -= length;
+}
 
-        if (release == 0) {
-            currentValue = 0.0;
-            currentState = State::Done;
-            fill<Type>(originalSpan, 0.0);
+template <class Type>
+bool ADSREnvelope<Type>::getBlock(absl::Span<Type> output) noexcept
+{
+    bool constant { true };
+    const auto firstValue = currentValue;
+    while (!output.empty()) {
+        settle();
+        const auto length = min(static_cast<int>(output.size()), segmentLength());
+        const auto segment = output.first(length);
+        switch (currentState) {
+        case State::Attack:
+            constant = false;
+            currentValue = linearRamp<Type>(segment, currentValue, attackStep);
+            break;
+        case State::Decay:
+            constant = false;
+            currentValue = multiplicativeRamp<Type>(segment, currentValue, decayStep);
+            break;
+        case State::Release:
+            constant = false;
+            currentValue = multiplicativeRamp<Type>(segment, currentValue, releaseStep);
+            break;
+        default:
+            constant = constant && currentValue == firstValue;
+            fill<Type>(segment, currentValue);
+            break;
         }
+        advance(length);
+        output.remove_prefix(length);
     }
+    // Finish the segments ending with the block, so that the state is up to date between the blocks
+    settle();
+    return constant;
 }
+
 template <class Type>
 bool ADSREnvelope<Type>::isSmoothing() noexcept
 {
@@ -220,8 +220,11 @@ bool ADSREnvelope<Type>::isSmoothing() noexcept
 template <class Type>
 void ADSREnvelope<Type>::startRelease(int releaseDelay) noexcept
 {
+    if (currentState == State::Release || currentState == State::Done)
+        return;
+
     shouldRelease = true;
-    this->releaseDelay = releaseDelay;
+    this->releaseDelay = std::max(releaseDelay, 0);
 }
 
 }
@@ -32,7 +32,11 @@ public:
     ADSREnvelope() = default;
     void reset(int attack, int release, Type sustain = 1.0, int delay = 0, int decay = 0, int hold = 0, Type start = 0.0, Type depth = 1) noexcept;
     Type getNextValue() noexcept;
-    void getBlock(absl::Span<Type> output) noexcept;
+    // Returns true when the whole block holds the same value, e.g. in the sustain phase.
+    // Each voice renders its own envelope: most blocks are a constant sustain or a single ramp,
+    // which a batch across voices in SIMD lanes measured slower on.
+    bool getBlock(absl::Span<Type> output) noexcept;
+    // The release starts exactly releaseDelay samples after the start of the next block
     void startRelease(int releaseDelay) noexcept;
     bool isSmoothing() noexcept;
 
@@ -46,9 +50,16 @@ private:
         Release,
         Done
     };
+    // Move past the finished segments and start the release if it is due
+    void settle() noexcept;
+    // Samples until the current segment ends or the release starts
+    int segmentLength() const noexcept;
+    void advance(int length) noexcept;
     State currentState { State::Done };
     Type currentValue { 0.0 };
-    Type step { 0.0 };
+    Type attackStep { 0.0 };
+    Type decayStep { 1.0 };
+    Type releaseStep { 1.0 };
     int delay { 0 };
     int attack { 0 };
     int decay { 0 };
@@ -62,4 +73,4 @@ private:
     LEAK_DETECTOR(ADSREnvelope);
 };
 
-}
\ No newline at end of file
+}
@@ -26,13 +26,17 @@
 #include "Config.h"
 #include "Debug.h"
 #include "LeakDetector.h"
+#include "SlabArena.h"
 #include "absl/types/span.h"
+#include <algorithm>
+#include <cstring>
 #include <memory>
-#include <array>
+#include <utility>
 
 namespace sfz 
 {
 
+// Planar audio data; the channels lie one after the other in a single allocation, each of them aligned
 template <class Type, unsigned int MaxChannels = sfz::config::numChannels, unsigned int Alignment = SIMDConfig::defaultAlignment>
 class AudioBuffer {
 public:
@@ -50,23 +54,53 @@ public:
         : numChannels(numChannels)
         , numFrames(numFrames)
     {
-        for (auto i = 0; i < numChannels; ++i)
-            buffers[i] = std::make_unique<buffer_type>(numFrames);
+        allocate(numChannels, numFrames);
+    }
+    // Carve the storage out of an arena; falls back on the heap if the arena cannot allocate
+    AudioBuffer(int numChannels, int numFrames, SlabArena& arena)
+        : numChannels(numChannels)
+        , numFrames(numFrames)
+    {
+        channelStride = strideFor(numFrames);
+        const auto storageSize = numChannels * channelStride;
+        // Keep some room past the last channel like the heap buffers do, since the interpolators read one frame ahead
+        if (storageSize > 0)
+            arenaStorage = arena.allocate((storageSize + TypeAlignment) * sizeof(value_type), std::max<size_t>(Alignment, alignof(value_type)));
+
+        if (arenaStorage != nullptr)
+            storage = reinterpret_cast<pointer>(arenaStorage.get());
+        else
+            allocate(numChannels, numFrames);
+    }
+    AudioBuffer(const AudioBuffer&) = delete;
+    AudioBuffer& operator=(const AudioBuffer&) = delete;
+    AudioBuffer(AudioBuffer&& other)
+    {
+        *this = std::move(other);
+    }
+    AudioBuffer& operator=(AudioBuffer&& other)
+    {
+        if (this != &other) {
+            heapStorage = std::move(other.heapStorage);
+            arenaStorage = std::move(other.arenaStorage);
+            storage = std::exchange(other.storage, nullptr);
+            channelStride = std::exchange(other.channelStride, 0);
+            numChannels = std::exchange(other.numChannels, 0);
+            numFrames = std::exchange(other.numFrames, 0);
+        }
+        return *this;
     }
 
     bool resize(size_type newSize)
     {
-        bool returnedOK = true;
-        for (auto i = 0; i < numChannels; ++i)
-            returnedOK &= buffers[i]->resize(newSize);
-        return returnedOK;
+        return reshape(numChannels, newSize);
     }
 
     iterator channelWriter(int channelIndex)
     {
         ASSERT(channelIndex < numChannels)
         if (channelIndex < numChannels)
-            return buffers[channelIndex]->data();
+            return storage + channelIndex * channelStride;
 
         return {};
     }
@@ -75,7 +109,7 @@ public:
     {
         ASSERT(channelIndex < numChannels)
         if (channelIndex < numChannels)
-            return buffers[channelIndex]->end();
+            return storage + channelIndex * channelStride + numFrames;
 
         return {};
     }
@@ -84,7 +118,7 @@ public:
     {
         ASSERT(channelIndex < numChannels)
         if (channelIndex < numChannels)
-            return buffers[channelIndex]->data();
+            return storage + channelIndex * channelStride;
 
         return {};
     }
@@ -93,7 +127,7 @@ public:
     {
         ASSERT(channelIndex < numChannels)
         if (channelIndex < numChannels)
-            return buffers[channelIndex]->end();
+            return storage + channelIndex * channelStride + numFrames;
 
         return {};
     }
@@ -102,7 +136,7 @@ public:
     {
         ASSERT(channelIndex < numChannels)
         if (channelIndex < numChannels)
-            return { buffers[channelIndex]->data(), buffers[channelIndex]->size() };
+            return { storage + channelIndex * channelStride, numFrames };
 
         return {};
     }
@@ -114,8 +148,8 @@ public:
 
     void addChannel()
     {
-        if (numChannels < MaxChannels)
-            buffers[numChannels++] = std::make_unique<buffer_type>(numFrames);
+        if (numChannels < static_cast<int>(MaxChannels))
+            reshape(numChannels + 1, numFrames);
     }
 
     size_type getNumFrames() const
@@ -128,18 +162,29 @@ public:
         return numChannels;
     }
 
+    // Distance between the starts of two consecutive channels, in samples
+    size_type getChannelStride() const
+    {
+        return channelStride;
+    }
+
     bool empty() const
     {
         return numFrames == 0;
     }
 
+    bool isInArena() const
+    {
+        return arenaStorage != nullptr;
+    }
+
     Type& getSample(int channelIndex, size_type frameIndex)
     {
         // Uhoh
-        ASSERT(buffers[channelIndex] != nullptr);
+        ASSERT(channelIndex < numChannels);
         ASSERT(frameIndex < numFrames);
 
-        return *(buffers[channelIndex]->data() + frameIndex);
+        return *(storage + channelIndex * channelStride + frameIndex);
     }
 
     Type& operator()(int channelIndex, size_type frameIndex)
@@ -149,9 +194,48 @@ public:
 
 private:
     using buffer_type = Buffer<Type, Alignment>;
-    using buffer_ptr = std::unique_ptr<buffer_type>;
-    std::array<buffer_ptr, MaxChannels> buffers;
+    static constexpr size_type TypeAlignment { std::max<size_type>(Alignment / sizeof(value_type), 1) };
+    // Pad each channel so that the next one starts aligned too
+    static size_type strideFor(size_type numFrames)
+    {
+        return (numFrames + TypeAlignment - 1) / TypeAlignment * TypeAlignment;
+    }
+    bool allocate(int newNumChannels, size_type newNumFrames)
+    {
+        const auto newStride = strideFor(newNumFrames);
+        if (!heapStorage.resize(newNumChannels * newStride))
+            return false;
+
+        channelStride = newStride;
+        storage = heapStorage.data();
+        return true;
+    }
+    // Move the channels to a new heap allocation, keeping as many frames as possible
+    bool reshape(int newNumChannels, size_type newNumFrames)
+    {
+        buffer_type oldStorage { std::move(heapStorage) };
+        auto oldArenaStorage = std::move(arenaStorage);
+        const auto oldData = storage;
+        const auto oldStride = channelStride;
+        if (!allocate(newNumChannels, newNumFrames)) {
+            heapStorage = std::move(oldStorage);
+            arenaStorage = std::move(oldArenaStorage);
+            return false;
+        }
+
+        const auto numCopiedFrames = std::min(numFrames, newNumFrames);
+        for (int i = 0; i < std::min(numChannels, newNumChannels); ++i)
+            std::memcpy(storage + i * channelStride, oldData + i * oldStride, numCopiedFrames * sizeof(value_type));
+
+        numChannels = newNumChannels;
+        numFrames = newNumFrames;
+        return true;
+    }
+    buffer_type heapStorage;
+    std::shared_ptr<char> arenaStorage;
+    pointer storage { nullptr };
+    size_type channelStride { 0 };
     int numChannels { 0 };
     size_type numFrames { 0 };
 };
-}
\ No newline at end of file
+}
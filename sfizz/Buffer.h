@@ -24,6 +24,7 @@
 #pragma once
 #include "Config.h"
 #include "LeakDetector.h"
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <memory>
@@ -64,6 +65,8 @@ public:
         }
 
         auto tempSize = newSize + 2 * AlignmentMask; // To ensure that we have leeway at the beginning and at the end
+        const auto oldOffset = normalData - paddedData;
+        const auto oldSize = alignedSize;
         auto* newData = paddedData != nullptr ? std::realloc(paddedData, tempSize * sizeof(value_type)) : std::malloc(tempSize * sizeof(value_type));
         if (newData == nullptr) {
             return false;
@@ -73,10 +76,13 @@ public:
         alignedSize = newSize;
         paddedData = static_cast<pointer>(newData);
         normalData = static_cast<pointer>(std::align(Alignment, alignedSize, newData, tempSize));
+        // realloc only keeps the alignment malloc guarantees, so the data may have to move to the new aligned start
+        if (oldSize > 0 && normalData != paddedData + oldOffset)
+            std::memmove(normalData, paddedData + oldOffset, std::min(oldSize, newSize) * sizeof(value_type));
         normalEnd = normalData + alignedSize;
 		auto endMisalignment = (alignedSize & TypeAlignmentMask);
 		if (endMisalignment != 0)
-            _alignedEnd = normalEnd + Alignment - endMisalignment;
+            _alignedEnd = normalEnd + TypeAlignment - endMisalignment;
         else
             _alignedEnd = normalEnd;
 
@@ -88,6 +94,7 @@ public:
         largerSize = 0;
         alignedSize = 0;
         std::free(paddedData);
+        paddedData = nullptr;
         normalData = nullptr;
         normalEnd = nullptr;
         _alignedEnd = nullptr;
@@ -97,14 +104,14 @@ public:
         std::free(paddedData);
     }
 
-    Buffer(const Buffer<Type>& other)
+    Buffer(const Buffer& other)
     {
         if (resize(other.size())) {
             std::memcpy(this->data(), other.data(), other.size() * sizeof(value_type));
         }
     }
 
-    Buffer(Buffer<Type>&& other)
+    Buffer(Buffer&& other)
     {
         largerSize = std::exchange(other.largerSize, 0);
         alignedSize = std::exchange(other.alignedSize, 0);
@@ -114,7 +121,7 @@ public:
         _alignedEnd = std::exchange(other._alignedEnd, nullptr);
     }
 
-    Buffer<Type>& operator=(const Buffer<Type>& other)
+    Buffer& operator=(const Buffer& other)
     {
         if (this != &other) {
             if (resize(other.size()))
@@ -123,7 +130,7 @@ public:
         return *this;
     }
 
-    Buffer<Type>& operator=(Buffer<Type>&& other)
+    Buffer& operator=(Buffer&& other)
     {
         if (this != &other) {
             std::free(paddedData);
@@ -150,7 +157,7 @@ private:
     static constexpr auto TypeAlignment { Alignment / sizeof(value_type) };
     static constexpr auto TypeAlignmentMask { TypeAlignment - 1 };
     static_assert(std::is_arithmetic<value_type>::value, "Type should be arithmetic");
-    static_assert(Alignment == 0 || Alignment == 4 || Alignment == 8 || Alignment == 16, "Bad alignment value");
+    static_assert(Alignment == 0 || Alignment == 4 || Alignment == 8 || Alignment == 16 || Alignment == 32 || Alignment == 64, "Bad alignment value");
     static_assert(TypeAlignment * sizeof(value_type) == Alignment, "The alignment does not appear to be divided by the size of the Type");
     size_type largerSize { 0 };
     size_type alignedSize { 0 };
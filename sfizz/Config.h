@@ -22,6 +22,7 @@
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #pragma once
+#include <cstddef>
 
 namespace sfz {
 
@@ -29,8 +30,38 @@ namespace config {
     constexpr float defaultSampleRate { 48000 };
     constexpr int defaultSamplesPerBlock { 1024 };
     constexpr int preloadSize { 8192 * 4 };
+    // Interleaved files are decoded this many frames at a time
+    constexpr int fileChunkSize { 4096 };
+    // The preloads of an instrument are carved out of slabs of this size
+    constexpr size_t arenaSlabSize { 16 * 1024 * 1024 };
+    constexpr float minimumLoaderLatency { 0.05f }; // Latency assumed by the adaptive preload before any measurement
+    constexpr float adaptivePreloadMargin { 2.0f };
+    constexpr float loaderLatencyDecay { 0.99f };
+    constexpr int decodeWindowFactor { 2 }; // 16 bit sources are decoded per block up to this pitch ratio
+    // Windowed-sinc interpolation: taps per frame, phases in the filter table, and cutoff relative to the Nyquist frequency
+    constexpr int sincTaps { 8 };
+    constexpr int sincPhases { 256 };
+    constexpr double sincCutoff { 0.9 };
+    // Entries of the equal-power pan law table
+    constexpr int panTableSize { 4096 };
     constexpr int numChannels { 2 };
     constexpr int numVoices { 64 };
+    constexpr int loadingQueueSize { numVoices };
+    // Background preload requests have their own queue so that they never take the place of a voice
+    constexpr int preloadQueueSize { numVoices };
+    constexpr int fileDataMailboxSize { 4 };
+    constexpr int fileHandleCacheSize { 64 };
+    // Frames kept after the offsets when a preload is shrunk to fit the memory budget
+    constexpr int evictedPreloadSize { 8192 };
+    constexpr int evictionQueueSize { 64 };
+    // Room for every voice to drop its data and a full mailbox, and for every pending preload update
+    constexpr int retireQueueSize { numVoices * (fileDataMailboxSize + 1) + 2 * evictionQueueSize };
+    // Buffers kept alive on the audio thread when the retire queue is full anyway
+    constexpr int retireFallbackSize { numVoices };
+    // Frames kept after the offsets for the files only preloaded in the background once needed
+    constexpr int deferredPreloadSize { 1024 };
+    // Frames preloaded ahead of time for the release and next round robin regions of a note
+    constexpr int prefetchSize { 4 * preloadSize };
     constexpr int sustainCC { 64 };
     constexpr int halfCCThreshold { 64 };
     constexpr int centPerSemitone { 100 };
@@ -45,25 +76,35 @@ namespace config {
 
 
 namespace SIMDConfig {
-    constexpr unsigned int defaultAlignment { 16 };
+    // Cache line sized so that the AVX-512 kernels never split their loads
+    constexpr unsigned int defaultAlignment { 64 };
     constexpr bool writeInterleaved { true };
     constexpr bool readInterleaved { true };
     constexpr bool fill { true };
-    constexpr bool gain { false };
+    constexpr bool gain { true };
     constexpr bool mathfuns { false };
     constexpr bool loopingSFZIndex { true };
     constexpr bool saturatingSFZIndex { true };
-    constexpr bool linearRamp { false };
+    constexpr bool linearRamp { true };
     constexpr bool multiplicativeRamp { true };
+    constexpr bool onePoleLanes { true };
     constexpr bool add { false };
     constexpr bool subtract { false };
-    constexpr bool multiplyAdd { false };
+    constexpr bool multiplyAdd { true };
     constexpr bool copy { false };
     constexpr bool pan { true };
+    constexpr bool gainAndPan { true };
+    constexpr bool mixStereo { true };
+    constexpr bool tablePan { true };
     constexpr bool cumsum { true };
     constexpr bool diff { false };
     constexpr bool sfzInterpolationCast { true };
+    constexpr bool interpolate { true };
+    constexpr bool interpolateHermite { true };
+    constexpr bool interpolateSinc { true };
+    constexpr bool phaseIndex { true };
     constexpr bool mean { false };
     constexpr bool meanSquared { false };
+    constexpr bool int16ToFloat { true };
 }
 } // namespace sfz
\ No newline at end of file
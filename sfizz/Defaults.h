@@ -47,8 +47,11 @@ namespace Default
 	constexpr Range<uint32_t> offsetRange { 0, std::numeric_limits<uint32_t>::max() };
 	constexpr Range<uint32_t> sampleEndRange { 0, std::numeric_limits<uint32_t>::max() };
 	constexpr Range<uint32_t> sampleCountRange { 0, std::numeric_limits<uint32_t>::max() };
+	constexpr Range<uint32_t> preloadSizeRange { 0, std::numeric_limits<uint32_t>::max() };
 	constexpr SfzLoopMode loopMode { SfzLoopMode::no_loop };
 	constexpr Range<uint32_t> loopRange { 0, std::numeric_limits<uint32_t>::max() };
+	constexpr int sampleQuality { 1 };
+	constexpr Range<int> sampleQualityRange { 0, 10 };
 
     // Instrument setting: voice lifecycle
 	constexpr uint32_t group { 0 };
@@ -25,35 +25,366 @@
 #include "AudioBuffer.h"
 #include "Config.h"
 #include "Debug.h"
+#include "SIMDHelpers.h"
 #include "absl/types/span.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
 #include <memory>
 #include <mutex>
 #include <sndfile.hh>
+#include <string>
 #include <thread>
 #include <mutex>
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
 using namespace std::chrono_literals;
 
+// Reads from the current position of the file into the frames from firstFrame to numFrames
 template <class T>
-std::unique_ptr<sfz::AudioBuffer<T>> readFromFile(SndfileHandle& sndFile, int numFrames)
+void readFromFile(SndfileHandle& sndFile, int numFrames, sfz::AudioBuffer<T>& output, int firstFrame = 0)
 {
-    auto returnedBuffer = std::make_unique<sfz::AudioBuffer<T>>(sndFile.channels(), numFrames);
     if (sndFile.channels() == 1) {
-        sndFile.readf(returnedBuffer->channelWriter(0), numFrames);
+        sndFile.readf(output.channelWriter(0) + firstFrame, numFrames - firstFrame);
     } else if (sndFile.channels() == 2) {
-        auto tempReadBuffer = std::make_unique<sfz::AudioBuffer<float>>(1, 2 * numFrames);
-        sndFile.readf(tempReadBuffer->channelWriter(0), numFrames);
-        sfz::readInterleaved<float>(tempReadBuffer->getSpan(0), returnedBuffer->getSpan(0), returnedBuffer->getSpan(1));
+        // Decode a chunk at a time in a scratch buffer owned by the reading thread and deinterleave straight into the planes
+        thread_local sfz::Buffer<T> interleavedChunk { 2 * sfz::config::fileChunkSize };
+        auto left = output.getSpan(0);
+        auto right = output.getSpan(1);
+        for (int frame = firstFrame; frame < numFrames;) {
+            const auto chunkSize = std::min(numFrames - frame, sfz::config::fileChunkSize);
+            const auto numRead = static_cast<int>(sndFile.readf(interleavedChunk.data(), chunkSize));
+            if (numRead <= 0)
+                break;
+
+            sfz::readInterleaved<T>(absl::MakeConstSpan(interleavedChunk.data(), 2 * numRead), left.subspan(frame, numRead), right.subspan(frame, numRead));
+            frame += numRead;
+        }
     }
+}
+
+// 16 bit files are stored as they are; libsndfile converts anything else to floats
+sfz::SampleBuffer::Format bufferFormat(SndfileHandle& sndFile)
+{
+    return (sndFile.format() & SF_FORMAT_SUBMASK) == SF_FORMAT_PCM_16 ? sfz::SampleBuffer::Format::int16 : sfz::SampleBuffer::Format::float32;
+}
+
+std::unique_ptr<sfz::SampleBuffer> readFromFile(SndfileHandle& sndFile, int numFrames, sfz::SampleBuffer::Locking locking, sfz::SlabArena* arena = nullptr)
+{
+    const auto format = bufferFormat(sndFile);
+    auto returnedBuffer = std::make_unique<sfz::SampleBuffer>(format, sndFile.channels(), numFrames, locking, arena);
+    if (format == sfz::SampleBuffer::Format::int16)
+        readFromFile<int16_t>(sndFile, numFrames, returnedBuffer->getInt16Buffer());
+    else
+        readFromFile<float>(sndFile, numFrames, returnedBuffer->getFloatBuffer());
     return returnedBuffer;
 }
 
-absl::optional<sfz::FilePool::FileInformation> sfz::FilePool::getFileInformation(const std::string& filename, uint32_t offset) noexcept
+// Reads the first frames of a file when its preload already holds the beginning: the preloaded frames are
+// copied and only the ones after them are read, with a seek since the handles are reused
+std::unique_ptr<sfz::SampleBuffer> readAfterPreload(SndfileHandle& sndFile, const sfz::SampleBuffer& preload, int numFrames, sfz::SampleBuffer::Locking locking)
+{
+    const auto format = bufferFormat(sndFile);
+    int firstFrame { 0 };
+    if (preload.getFormat() == format && preload.getNumChannels() == sndFile.channels())
+        firstFrame = std::min(numFrames, static_cast<int>(preload.getNumFrames()));
+    if (sndFile.seek(firstFrame, SEEK_SET) != firstFrame)
+        return {};
+
+    auto returnedBuffer = std::make_unique<sfz::SampleBuffer>(format, sndFile.channels(), numFrames, locking);
+    for (int channel = 0; channel < sndFile.channels(); ++channel) {
+        if (format == sfz::SampleBuffer::Format::int16)
+            sfz::copy<int16_t>(preload.getInt16Buffer().getConstSpan(channel).first(firstFrame), returnedBuffer->getInt16Buffer().getSpan(channel));
+        else
+            sfz::copy<float>(preload.getFloatBuffer().getConstSpan(channel).first(firstFrame), returnedBuffer->getFloatBuffer().getSpan(channel));
+    }
+
+    if (format == sfz::SampleBuffer::Format::int16)
+        readFromFile<int16_t>(sndFile, numFrames, returnedBuffer->getInt16Buffer(), firstFrame);
+    else
+        readFromFile<float>(sndFile, numFrames, returnedBuffer->getFloatBuffer(), firstFrame);
+    return returnedBuffer;
+}
+
+// Preload cache files start with this header and the full path of the file, padded so that the planar
+// sample data that follows is aligned
+struct CacheHeader {
+    char magic[4] { 'S', 'F', 'Z', 'C' };
+    uint32_t version { 2 };
+    uint64_t fileSize { 0 };
+    int64_t fileTime { 0 };
+    double sampleRate { 0.0 };
+    uint32_t end { 0 };
+    uint32_t loopBegin { 0 };
+    uint32_t loopEnd { 0 };
+    uint32_t numFrames { 0 };
+    uint16_t numChannels { 0 };
+    uint16_t format { 0 };
+    uint32_t pathSize { 0 };
+};
+constexpr size_t cacheHeaderSize { 64 };
+static_assert(sizeof(CacheHeader) <= cacheHeaderSize, "The cache header does not fit in its padded size");
+
+struct CacheKey {
+    fs::path cacheFile;
+    std::string path;
+    uint64_t fileSize;
+    int64_t fileTime;
+};
+
+absl::optional<CacheKey> getCacheKey(const fs::path& cacheDirectory, const fs::path& file)
+{
+    std::error_code error;
+    const auto fileSize = fs::file_size(file, error);
+    if (error)
+        return {};
+    const auto fileTime = fs::last_write_time(file, error);
+    if (error)
+        return {};
+    const auto absolutePath = fs::absolute(file, error);
+    if (error)
+        return {};
+
+    // FNV-1a hash of the path; the path, size and modification time are checked against the header
+    // since different paths may share a hash
+    auto path = absolutePath.string();
+    uint64_t hash { 0xcbf29ce484222325 };
+    for (auto character : path) {
+        hash ^= static_cast<uint8_t>(character);
+        hash *= 0x100000001b3;
+    }
+    char cacheName[32];
+    std::snprintf(cacheName, sizeof(cacheName), "%016llx.sfzcache", static_cast<unsigned long long>(hash));
+    return CacheKey { cacheDirectory / cacheName, std::move(path), fileSize, static_cast<int64_t>(fileTime.time_since_epoch().count()) };
+}
+
+// The samples start at the first multiple of the header size after the path
+std::streamoff cacheDataOffset(const CacheHeader& header)
+{
+    return static_cast<std::streamoff>((cacheHeaderSize + header.pathSize + cacheHeaderSize - 1) / cacheHeaderSize * cacheHeaderSize);
+}
+
+size_t sampleSize(sfz::SampleBuffer::Format format)
+{
+    return format == sfz::SampleBuffer::Format::int16 ? sizeof(int16_t) : sizeof(float);
+}
+
+char* channelData(sfz::SampleBuffer& buffer, int channel)
+{
+    if (buffer.getFormat() == sfz::SampleBuffer::Format::int16)
+        return reinterpret_cast<char*>(buffer.getInt16Buffer().channelWriter(channel));
+    return reinterpret_cast<char*>(buffer.getFloatBuffer().channelWriter(channel));
+}
+
+absl::optional<CacheHeader> readCacheHeader(fs::ifstream& cacheStream, const CacheKey& key)
+{
+    CacheHeader header;
+    if (!cacheStream.read(reinterpret_cast<char*>(&header), sizeof(header)))
+        return {};
+
+    const CacheHeader reference;
+    if (std::memcmp(header.magic, reference.magic, sizeof(header.magic)) != 0 || header.version != reference.version)
+        return {};
+
+    if (header.fileSize != key.fileSize || header.fileTime != key.fileTime)
+        return {};
+
+    if (header.numChannels != 1 && header.numChannels != 2)
+        return {};
+
+    if (header.pathSize != key.path.size())
+        return {};
+
+    std::string path(header.pathSize, '\0');
+    cacheStream.seekg(static_cast<std::streamoff>(cacheHeaderSize));
+    if (!cacheStream.read(&path[0], static_cast<std::streamsize>(path.size())) || path != key.path)
+        return {};
+
+    return header;
+}
+
+std::unique_ptr<sfz::SampleBuffer> readFromCache(fs::ifstream& cacheStream, const CacheHeader& header, uint32_t numFrames, sfz::SampleBuffer::Locking locking, sfz::SlabArena* arena)
+{
+    if (header.format != static_cast<uint16_t>(sfz::SampleBuffer::Format::int16)
+        && header.format != static_cast<uint16_t>(sfz::SampleBuffer::Format::float32))
+        return {};
+
+    // The samples are copied rather than mapped: the audio thread reads the preloads, and mapped pages
+    // could be dropped and fault back in from the disk, or change when another instance rewrites the entry
+    const auto format = static_cast<sfz::SampleBuffer::Format>(header.format);
+    auto returnedBuffer = std::make_unique<sfz::SampleBuffer>(format, header.numChannels, numFrames, locking, arena);
+    const auto channelSize = static_cast<std::streamoff>(header.numFrames * sampleSize(format));
+    for (int channel = 0; channel < header.numChannels; ++channel) {
+        cacheStream.seekg(cacheDataOffset(header) + channel * channelSize);
+        if (!cacheStream.read(channelData(*returnedBuffer, channel), numFrames * sampleSize(format)))
+            return {};
+    }
+    return returnedBuffer;
+}
+
+void writeToCache(const CacheKey& key, const CacheHeader& header, sfz::SampleBuffer& buffer)
+{
+    // Write to a temporary file first so that a concurrent load never sees a partial cache file;
+    // the name is unique to this process and call, since other instances may write the same entry
+    static std::atomic<unsigned> temporaryCount { 0 };
+#if defined(_WIN32)
+    const auto processId = _getpid();
+#else
+    const auto processId = getpid();
+#endif
+    auto temporaryFile = key.cacheFile;
+    temporaryFile += ".tmp" + std::to_string(processId) + "-" + std::to_string(temporaryCount++);
+    std::error_code error;
+    {
+        fs::ofstream cacheStream { temporaryFile, std::ios::binary | std::ios::trunc };
+        if (!cacheStream)
+            return;
+
+        std::array<char, cacheHeaderSize> paddedHeader {};
+        std::memcpy(paddedHeader.data(), &header, sizeof(header));
+        cacheStream.write(paddedHeader.data(), paddedHeader.size());
+        cacheStream.write(key.path.data(), static_cast<std::streamsize>(key.path.size()));
+        const std::array<char, cacheHeaderSize> padding {};
+        cacheStream.write(padding.data(), cacheDataOffset(header) - static_cast<std::streamoff>(cacheHeaderSize + key.path.size()));
+        const auto channelSize = static_cast<std::streamsize>(header.numFrames * sampleSize(buffer.getFormat()));
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+            cacheStream.write(channelData(buffer, channel), channelSize);
+
+        if (!cacheStream) {
+            cacheStream.close();
+            fs::remove(temporaryFile, error);
+            return;
+        }
+    }
+
+    fs::rename(temporaryFile, key.cacheFile, error);
+    if (error) {
+        DBG("Could not write the preload cache file " << key.cacheFile.string());
+        fs::remove(temporaryFile, error);
+    }
+}
+
+void sfz::FilePool::PreloadRequest::add(uint32_t offset, float pitchRatio, absl::optional<uint32_t> preloadSize) noexcept
+{
+    if (preloadSize) {
+        // A zero preload size means the whole file
+        const uint64_t end = *preloadSize == 0 ? std::numeric_limits<uint32_t>::max() : uint64_t(offset) + *preloadSize;
+        minimumEnd = std::max(minimumEnd, static_cast<uint32_t>(std::min<uint64_t>(end, std::numeric_limits<uint32_t>::max())));
+        return;
+    }
+
+    usesPolicy = true;
+    maxOffset = std::max(maxOffset, offset);
+    maxPitchRatio = std::max(maxPitchRatio, pitchRatio);
+}
+
+void sfz::FilePool::setCacheDirectory(const fs::path& directory) noexcept
+{
+    cacheDirectory = directory;
+    if (cacheDirectory.empty())
+        return;
+
+    std::error_code error;
+    fs::create_directories(cacheDirectory, error);
+    if (error) {
+        DBG("Could not create the preload cache directory " << cacheDirectory.string() << ", disabling the cache");
+        cacheDirectory.clear();
+    }
+}
+
+void sfz::FilePool::setPreloadSize(uint32_t numFrames) noexcept
+{
+    preloadMode = PreloadMode::frames;
+    preloadSize = numFrames;
+}
+
+void sfz::FilePool::setPreloadDuration(float seconds) noexcept
+{
+    preloadMode = PreloadMode::duration;
+    preloadDuration = std::max(seconds, 0.0f);
+}
+
+void sfz::FilePool::setAdaptivePreload() noexcept
+{
+    preloadMode = PreloadMode::adaptive;
+}
+
+uint32_t sfz::FilePool::preloadEnd(const PreloadRequest& request, uint32_t fileEnd, double fileSampleRate) const noexcept
+{
+    uint64_t end { request.minimumEnd };
+    if (request.usesPolicy) {
+        const auto policySize = [&]() -> uint64_t {
+            switch (preloadMode) {
+            case PreloadMode::frames:
+                return preloadSize == 0 ? fileEnd : preloadSize;
+            case PreloadMode::duration:
+                return static_cast<uint64_t>(std::ceil(preloadDuration * fileSampleRate));
+            case PreloadMode::adaptive:
+                // The voice reads fileSampleRate * pitchRatio frames per second while waiting for the loader
+                const auto latency = std::max(loaderLatency.load(), config::minimumLoaderLatency);
+                return static_cast<uint64_t>(std::ceil(config::adaptivePreloadMargin * latency * fileSampleRate * request.maxPitchRatio));
+            }
+            return fileEnd;
+        }();
+        end = std::max(end, request.maxOffset + policySize);
+    }
+    return static_cast<uint32_t>(std::min<uint64_t>(end, fileEnd));
+}
+
+uint32_t sfz::FilePool::initialPreloadEnd(const PreloadRequest& request, uint32_t fileEnd, double fileSampleRate) const noexcept
+{
+    if (!request.deferred)
+        return preloadEnd(request, fileEnd, fileSampleRate);
+
+    return static_cast<uint32_t>(std::min<uint64_t>(request.maxOffset + static_cast<uint64_t>(config::deferredPreloadSize), fileEnd));
+}
+
+// Regions overriding the preload size keep what they asked for; the others keep a few blocks after their offsets
+uint32_t minimumPreloadEnd(const sfz::FilePool::PreloadRequest& request, uint32_t fileEnd)
+{
+    const auto end = std::max<uint64_t>(request.maxOffset + static_cast<uint64_t>(sfz::config::evictedPreloadSize), request.minimumEnd);
+    return static_cast<uint32_t>(std::min<uint64_t>(end, fileEnd));
+}
+
+absl::optional<sfz::FilePool::FileInformation> sfz::FilePool::readFileInformation(const std::string& filename, const PreloadRequest& request) const noexcept
 {
     fs::path file { rootDirectory / filename };
     if (!fs::exists(file))
         return {};
 
+    // The budget may shrink a preload and a deferred preload grows, which would leave its block in a slab
+    auto* preloadArena = (request.deferred || memoryBudget > 0) ? nullptr : arena.get();
+    auto cacheKey = cacheDirectory.empty() ? absl::nullopt : getCacheKey(cacheDirectory, file);
+    if (cacheKey) {
+        fs::ifstream cacheStream { cacheKey->cacheFile, std::ios::binary };
+        const auto header = readCacheHeader(cacheStream, *cacheKey);
+        const auto preloadedSize = header ? initialPreloadEnd(request, header->end, header->sampleRate) : 0;
+        if (header && preloadedSize <= header->numFrames) {
+            if (auto cachedData = readFromCache(cacheStream, *header, preloadedSize, memoryLocking, preloadArena)) {
+                FileInformation returnedValue;
+                returnedValue.end = header->end;
+                returnedValue.loopBegin = header->loopBegin;
+                returnedValue.loopEnd = header->loopEnd;
+                returnedValue.sampleRate = header->sampleRate;
+                returnedValue.minimumPreloadEnd = minimumPreloadEnd(request, header->end);
+                returnedValue.sampleHandle = std::make_shared<SampleHandle>();
+                returnedValue.sampleHandle->preloadedData = std::move(cachedData);
+                if (request.deferred)
+                    returnedValue.sampleHandle->deferredPreloadEnd = preloadEnd(request, header->end, header->sampleRate);
+                return returnedValue;
+            }
+        }
+    }
+
     SndfileHandle sndFile(reinterpret_cast<const char*>(file.c_str()));
     if (sndFile.channels() != 1 && sndFile.channels() != 2) {
         DBG("Missing logic for " << sndFile.channels() << " channels, discarding sample " << filename);
@@ -63,6 +394,7 @@ absl::optional<sfz::FilePool::FileInformation> sfz::FilePool::getFileInformation
     FileInformation returnedValue;
     returnedValue.end = static_cast<uint32_t>(sndFile.frames());
     returnedValue.sampleRate = static_cast<double>(sndFile.samplerate());
+    returnedValue.minimumPreloadEnd = minimumPreloadEnd(request, returnedValue.end);
 
     SF_INSTRUMENT instrumentInfo;
     sndFile.command(SFC_GET_INSTRUMENT, &instrumentInfo, sizeof(instrumentInfo));
@@ -72,99 +404,524 @@ absl::optional<sfz::FilePool::FileInformation> sfz::FilePool::getFileInformation
     }
 
     // FIXME: Large offsets will require large preloading; is this OK in practice?
-    const auto preloadedSize = [&]() {
-        if (config::preloadSize == 0)
-            return returnedValue.end;
-        else
-            return std::min(returnedValue.end, offset + static_cast<uint32_t>(config::preloadSize));
-    }();
-
-    if (preloadedData.contains(filename)) {
-        auto alreadyPreloaded = preloadedData[filename];
-        if (preloadedSize > alreadyPreloaded->getNumFrames()) {
-            // FIXME: Okay, ideally here you would have a double indirection so that we can update _all_ the preloaded
-            // files in previous regions to account for the new offset
-            //
-            // Before this next command, some old regions and the file pool hold a shared pointer to the same audio buffer.
-            // This audio buffer is OK for the old regions, but too small for the new one.
-            // By resetting the filepool data to a new, longer audiobuffer, we are creating 2 copies of the same audio data.
-            // The filepool and the new regions have the longer copy, and the older regions have the shorter copy.
-            // This is not entirely optimal, but is it better to write a double shared pointer ?
-            // std::shared_ptr<std::shared_ptr<sfz::AudioBuffer>>> is a bit ugly...
-            alreadyPreloaded.reset(readFromFile<float>(sndFile, preloadedSize).release());
+    const auto preloadedSize = initialPreloadEnd(request, returnedValue.end, returnedValue.sampleRate);
+    returnedValue.sampleHandle = std::make_shared<SampleHandle>();
+    returnedValue.sampleHandle->preloadedData = readFromFile(sndFile, preloadedSize, memoryLocking, preloadArena);
+    if (request.deferred)
+        returnedValue.sampleHandle->deferredPreloadEnd = preloadEnd(request, returnedValue.end, returnedValue.sampleRate);
+
+    if (cacheKey) {
+        auto& preloadedData = *returnedValue.sampleHandle->preloadedData;
+        CacheHeader header;
+        header.fileSize = cacheKey->fileSize;
+        header.fileTime = cacheKey->fileTime;
+        header.sampleRate = returnedValue.sampleRate;
+        header.end = returnedValue.end;
+        header.loopBegin = returnedValue.loopBegin;
+        header.loopEnd = returnedValue.loopEnd;
+        header.numFrames = static_cast<uint32_t>(preloadedData.getNumFrames());
+        header.numChannels = static_cast<uint16_t>(preloadedData.getNumChannels());
+        header.format = static_cast<uint16_t>(preloadedData.getFormat());
+        header.pathSize = static_cast<uint32_t>(cacheKey->path.size());
+        writeToCache(*cacheKey, header, preloadedData);
+    }
+    return returnedValue;
+}
+
+bool sfz::FilePool::hasLargeEnoughPreload(const std::string& filename, const PreloadRequest& request) const noexcept
+{
+    const auto alreadyPreloaded = preloadedData.find(filename);
+    if (alreadyPreloaded == preloadedData.end())
+        return false;
+
+    const auto& fileInformation = alreadyPreloaded->second;
+    const auto preloadedSize = initialPreloadEnd(request, fileInformation.end, fileInformation.sampleRate);
+    return preloadedSize <= fileInformation.sampleHandle->preloadedData->getNumFrames();
+}
+
+const sfz::FilePool::FileInformation& sfz::FilePool::storeFileInformation(const std::string& filename, FileInformation&& fileInformation) noexcept
+{
+    const auto alreadyPreloaded = preloadedData.find(filename);
+    if (alreadyPreloaded == preloadedData.end()) {
+        auto& sampleHandle = *fileInformation.sampleHandle;
+        sampleHandle.path = rootDirectory / filename;
+        sampleHandle.id = nextSampleId++;
+        preloadedBytes += sampleHandle.preloadedData->getNumBytes();
+        return preloadedData.emplace(filename, std::move(fileInformation)).first->second;
+    }
+
+    // The regions already using this file hold the handle, so they all see the longer buffer
+    // and the shorter one is freed right away.
+    auto& sampleHandle = alreadyPreloaded->second.sampleHandle;
+    preloadedBytes -= sampleHandle->preloadedData->getNumBytes();
+    if (sampleHandle->preloadedData->isInArena())
+        pinnedBytes += sampleHandle->preloadedData->getNumBytes();
+    preloadedBytes += fileInformation.sampleHandle->preloadedData->getNumBytes();
+    sampleHandle->preloadedData = std::move(fileInformation.sampleHandle->preloadedData);
+    sampleHandle->deferredPreloadEnd = fileInformation.sampleHandle->deferredPreloadEnd;
+    fileInformation.sampleHandle = sampleHandle;
+    alreadyPreloaded->second = std::move(fileInformation);
+    return alreadyPreloaded->second;
+}
+
+absl::optional<sfz::FilePool::FileInformation> sfz::FilePool::getFileInformation(const std::string& filename, const PreloadRequest& request) noexcept
+{
+    std::lock_guard<std::mutex> guard { preloadMutex };
+    if (hasLargeEnoughPreload(filename, request))
+        return preloadedData[filename];
+
+    auto fileInformation = readFileInformation(filename, request);
+    if (!fileInformation)
+        return {};
+
+    return storeFileInformation(filename, std::move(*fileInformation));
+}
+
+void sfz::FilePool::preloadFiles(const absl::flat_hash_map<std::string, PreloadRequest>& requests, const ProgressCallback& callback) noexcept
+{
+    std::lock_guard<std::mutex> preloadGuard { preloadMutex };
+    std::vector<std::pair<std::string, PreloadRequest>> filesToLoad;
+    filesToLoad.reserve(requests.size());
+    for (auto& file : requests) {
+        if (!hasLargeEnoughPreload(file.first, file.second))
+            filesToLoad.emplace_back(file.first, file.second);
+    }
+
+    const auto numFiles = static_cast<int>(filesToLoad.size());
+    if (numFiles == 0)
+        return;
+
+    // Each thread picks the next file to read; the results are merged in the pool once all the threads are joined
+    std::vector<absl::optional<FileInformation>> results(filesToLoad.size());
+    std::atomic<size_t> nextFile { 0 };
+    std::mutex callbackMutex;
+    int numLoaded { 0 };
+    auto preloadWorker = [&]() {
+        for (auto fileIndex = nextFile++; fileIndex < filesToLoad.size(); fileIndex = nextFile++) {
+            const auto& file = filesToLoad[fileIndex];
+            results[fileIndex] = readFileInformation(file.first, file.second);
+            if (callback) {
+                std::lock_guard<std::mutex> guard { callbackMutex };
+                callback(++numLoaded, numFiles);
+            }
         }
-        returnedValue.preloadedData = alreadyPreloaded;
-    } else {
-        returnedValue.preloadedData = readFromFile<float>(sndFile, preloadedSize);
-        preloadedData[filename] = returnedValue.preloadedData;
+    };
+
+    const auto numThreads = std::max(1, std::min(static_cast<int>(std::thread::hardware_concurrency()), numFiles));
+    std::vector<std::thread> preloadThreads;
+    preloadThreads.reserve(numThreads - 1);
+    for (int i = 1; i < numThreads; ++i)
+        preloadThreads.emplace_back(preloadWorker);
+    preloadWorker();
+    for (auto& thread : preloadThreads)
+        thread.join();
+
+    for (size_t fileIndex = 0; fileIndex < filesToLoad.size(); ++fileIndex) {
+        if (results[fileIndex])
+            storeFileInformation(filesToLoad[fileIndex].first, std::move(*results[fileIndex]));
     }
+}
 
-    return returnedValue;
+void sfz::FilePool::enqueueLoading(Voice* voice, const std::shared_ptr<SampleHandle>& sample, int numFrames, unsigned ticket) noexcept
+{
+    sample->numPlays.store(sample->numPlays.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    const FileLoadingInformation request { voice, sample, numFrames, ticket, std::chrono::steady_clock::now() };
+    if (!loadingQueue.try_enqueue(request)) {
+        if (overflowPolicy == OverflowPolicy::drop) {
+            DBG("Problem enqueuing a file read for file " << sample->path);
+            numDropped.store(numDropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return;
+        }
+
+        if (!spareLoadingQueue.try_enqueue(request)) {
+            DBG("The spare loading queue is full too, dropping the file read for " << sample->path);
+            numDropped.store(numDropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return;
+        }
+        numGrown.store(numGrown.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    const auto numPending = loadingQueue.size_approx() + spareLoadingQueue.size_approx();
+    if (numPending > highWaterMark.load(std::memory_order_relaxed))
+        highWaterMark.store(numPending, std::memory_order_relaxed);
 }
 
-void sfz::FilePool::enqueueLoading(Voice* voice, const std::string* sample, int numFrames, unsigned ticket) noexcept
+void sfz::FilePool::enqueuePreload(const std::shared_ptr<SampleHandle>& sample, uint32_t numFrames) noexcept
 {
-    if (!loadingQueue.try_enqueue({ voice, sample, numFrames, ticket })) {
-        DBG("Problem enqueuing a file read for file " << sample);
+    const auto& preload = *sample->preloadedData;
+    if (sample->preloadPending || numFrames <= preload.getNumFrames())
+        return;
+
+    // The garbage thread would only shrink a preload grown past the memory budget right away
+    const size_t budget = memoryBudget;
+    const auto sampleSize = preload.getFormat() == SampleBuffer::Format::int16 ? sizeof(int16_t) : sizeof(float);
+    auto growthBytes = (numFrames - preload.getNumFrames()) * preload.getNumChannels() * sampleSize;
+    if (preload.isInArena())
+        growthBytes += preload.getNumBytes();
+    if (budget > 0 && preloadedBytes + streamingBytes + pinnedBytes + growthBytes > budget)
+        return;
+
+    // A preload request has no voice
+    if (preloadQueue.try_enqueue({ nullptr, sample, static_cast<int>(numFrames), 0, std::chrono::steady_clock::now() }))
+        sample->preloadPending = true;
+}
+
+void sfz::FilePool::setLoadingQueueCapacity(size_t capacity) noexcept
+{
+    // The loading thread waits on the queue, so it is stopped while the queue is replaced
+    stopLoadingThread = true;
+    fileLoadingThread.join();
+
+    decltype(loadingQueue) newQueue { capacity };
+    decltype(spareLoadingQueue) newSpareQueue { capacity + config::numVoices };
+    FileLoadingInformation request;
+    while (loadingQueue.try_dequeue(request))
+        newQueue.enqueue(std::move(request));
+    while (spareLoadingQueue.try_dequeue(request))
+        newSpareQueue.enqueue(std::move(request));
+    loadingQueue = std::move(newQueue);
+    spareLoadingQueue = std::move(newSpareQueue);
+    loadingQueueCapacity = capacity;
+
+    stopLoadingThread = false;
+    fileLoadingThread = std::thread(&FilePool::loadingThread, this);
+}
+
+sfz::FilePool::LoadingStats sfz::FilePool::getLoadingStats() const noexcept
+{
+    LoadingStats stats;
+    stats.capacity = loadingQueue.max_capacity();
+    stats.highWaterMark = highWaterMark;
+    stats.numDropped = numDropped;
+    stats.numFailed = numFailed;
+    stats.numGrown = numGrown;
+    stats.numCoalesced = numCoalesced;
+    return stats;
+}
+
+void sfz::FilePool::resetLoadingStats() noexcept
+{
+    highWaterMark = 0;
+    numDropped = 0;
+    numFailed = 0;
+    numGrown = 0;
+    numCoalesced = 0;
+}
+
+SndfileHandle sfz::FilePool::openFile(const SampleHandle& sample) noexcept
+{
+    const auto cached = openFileIndex.find(sample.id);
+    if (cached != openFileIndex.end()) {
+        openFiles.splice(openFiles.begin(), openFiles, cached->second);
+        return openFiles.front().handle;
+    }
+
+    SndfileHandle sndFile(reinterpret_cast<const char*>(sample.path.c_str()));
+    if (sndFile.error() != SF_ERR_NO_ERROR)
+        return sndFile;
+
+    if (openFiles.size() >= static_cast<size_t>(config::fileHandleCacheSize)) {
+        openFileIndex.erase(openFiles.back().sampleId);
+        openFiles.pop_back();
     }
+
+    openFiles.push_front({ sample.id, sndFile });
+    openFileIndex[sample.id] = openFiles.begin();
+    return sndFile;
 }
 
 void sfz::FilePool::loadingThread() noexcept
 {
-    while (!quitThread) {
+    std::vector<FileLoadingInformation> pendingLoads;
+    pendingLoads.reserve(2 * loadingQueueCapacity + config::numVoices + config::preloadQueueSize);
+    while (!quitThread && !stopLoadingThread) {
         FileLoadingInformation fileToLoad {};
-        if (!loadingQueue.wait_dequeue_timed(fileToLoad, 200ms)) {
+        // The spare and preload queues have no waiting primitive, so they are checked around a short wait on the main one
+        if (!spareLoadingQueue.try_dequeue(fileToLoad)
+            && !loadingQueue.wait_dequeue_timed(fileToLoad, 10ms)
+            && !preloadQueue.try_dequeue(fileToLoad)) {
             continue;
         }
 
-        if (fileToLoad.voice == nullptr) {
-            DBG("Background thread error: voice is null.");
-            continue;
-        }
+        // Take everything pending so that each file is read once for all the voices waiting on it
+        pendingLoads.clear();
+        do {
+            if (fileToLoad.sample == nullptr) {
+                DBG("Background thread error: sample is null.");
+                continue;
+            }
 
-        if (fileToLoad.sample == nullptr) {
-            DBG("Background thread error: sample is null.");
-            continue;
+            pendingLoads.push_back(std::move(fileToLoad));
+        } while (loadingQueue.try_dequeue(fileToLoad) || spareLoadingQueue.try_dequeue(fileToLoad) || preloadQueue.try_dequeue(fileToLoad));
+
+        for (auto load = pendingLoads.begin(); load < pendingLoads.end(); ++load) {
+            if (load->sample == nullptr || load->voice == nullptr)
+                continue; // Already served with an earlier request, or a preload request
+
+            const auto sample = load->sample;
+            const auto sameSample = [&](const FileLoadingInformation& other) { return other.voice != nullptr && other.sample == sample; };
+            int numFrames = load->numFrames;
+            for (auto other = load + 1; other < pendingLoads.end(); ++other) {
+                if (sameSample(*other))
+                    numFrames = std::max(numFrames, other->numFrames);
+            }
+
+            DBG("Background loading of: " << sample->path);
+            // The header is parsed once per file; reading again from a cached handle only needs a seek
+            auto sndFile = openFile(*sample);
+            const auto preload = std::atomic_load(&sample->preloadedData);
+            auto readData = sndFile.error() == SF_ERR_NO_ERROR ? readAfterPreload(sndFile, *preload, numFrames, memoryLocking) : nullptr;
+            if (readData == nullptr) {
+                DBG("Background thread: cannot read " << sample->path);
+                // The voices waiting on this file play their preload only; none of these requests may grow the preload
+                for (auto other = load; other < pendingLoads.end(); ++other) {
+                    if (!sameSample(*other))
+                        continue;
+                    other->sample = nullptr;
+                    numFailed++;
+                }
+                continue;
+            }
+
+            const auto numBytes = readData->getNumBytes();
+            streamingBytes += numBytes;
+            std::shared_ptr<SampleBuffer> fileData { readData.release(), [this, numBytes](SampleBuffer* buffer) {
+                streamingBytes -= numBytes;
+                delete buffer;
+            } };
+            for (auto other = load; other < pendingLoads.end(); ++other) {
+                if (!sameSample(*other))
+                    continue;
+
+                other->voice->setFileData(fileData, other->ticket);
+                if (other != load)
+                    numCoalesced++;
+
+                // Keep track of the peak latency, slowly forgetting about the old peaks
+                const std::chrono::duration<float> latency { std::chrono::steady_clock::now() - other->enqueueTime };
+                loaderLatency = std::max(latency.count(), config::loaderLatencyDecay * loaderLatency.load());
+                other->sample = nullptr;
+            }
         }
 
-        DBG("Background loading of: " << *fileToLoad.sample);
-        fs::path file { rootDirectory / *fileToLoad.sample };
-        if (!fs::exists(file)) {
-            DBG("Background thread: no file " << *fileToLoad.sample << " exists.");
-            continue;
+        // The preloads are grown once the voices have their data
+        for (auto& load : pendingLoads) {
+            if (load.sample != nullptr)
+                loadPreload(load);
         }
+    }
+}
+
+void sfz::FilePool::loadPreload(const FileLoadingInformation& request) noexcept
+{
+    DBG("Background preloading of: " << request.sample->path);
+    auto sndFile = openFile(*request.sample);
+    const auto currentPreload = std::atomic_load(&request.sample->preloadedData);
+    std::shared_ptr<SampleBuffer> preload;
+    if (sndFile.error() == SF_ERR_NO_ERROR)
+        preload = readAfterPreload(sndFile, *currentPreload, request.numFrames, memoryLocking);
+    if (preload == nullptr) {
+        DBG("Background thread: cannot read " << request.sample->path);
+        return;
+    }
+
+    std::lock_guard<std::mutex> guard { preloadMutex };
+    if (request.sample->id < firstLiveSampleId)
+        return; // Cleared while it was read
+
+    numPendingUpdates++;
+    growthQueue.enqueue({ request.sample, std::move(preload) });
+}
+
+void sfz::FilePool::retire(std::shared_ptr<SampleBuffer>&& buffer) noexcept
+{
+    if (buffer == nullptr)
+        return;
+
+    flushRetireFallback();
+    if (retireQueue.try_enqueue(std::move(buffer)))
+        return;
 
-        SndfileHandle sndFile(reinterpret_cast<const char*>(file.c_str()));
-        
-        std::lock_guard<std::mutex> guard { fileHandleMutex };
-        fileHandles.emplace_back(readFromFile<float>(sndFile, fileToLoad.numFrames));
-        fileToLoad.voice->setFileData(fileHandles.back(), fileToLoad.ticket);
+    // The queue is sized for the worst case, so this should not happen; the buffer is kept for later
+    // rather than growing the queue here
+    numRetireOverflows.store(numRetireOverflows.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (retireFallback.size() < retireFallback.capacity()) {
+        retireFallback.push_back(std::move(buffer));
+        return;
     }
+
+    DBG("The retire queue and its fallback are full, freeing the buffer on the audio thread");
+    buffer.reset();
+}
+
+void sfz::FilePool::flushRetireFallback() noexcept
+{
+    while (!retireFallback.empty() && retireQueue.try_enqueue(std::move(retireFallback.back())))
+        retireFallback.pop_back();
 }
 
 void sfz::FilePool::garbageThread() noexcept
 {
+    auto nextBudgetCheck = std::chrono::steady_clock::now();
     while (!quitThread) {
-        fileHandleMutex.lock();
-        for (auto handle = fileHandles.begin(); handle < fileHandles.end();) {
-            if (handle->use_count() == 1) {
-                handle->reset();
-                std::iter_swap(handle, fileHandles.end() - 1);
-                fileHandles.pop_back();
-            } else {
-                handle++;
-            }
+        std::shared_ptr<SampleBuffer> buffer;
+        retireQueue.wait_dequeue_timed(buffer, 100ms);
+        // The buffer is freed here, away from the audio thread
+        buffer.reset();
+
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= nextBudgetCheck) {
+            enforceMemoryBudget();
+            nextBudgetCheck = now + 100ms;
+        }
+    }
+}
+
+void sfz::FilePool::enforceMemoryBudget() noexcept
+{
+    const size_t budget = memoryBudget;
+    if (budget == 0 || numPendingUpdates > 0)
+        return;
+
+    // Never wait for a load to finish; the next check will do
+    std::unique_lock<std::mutex> lock { preloadMutex, std::try_to_lock };
+    if (!lock.owns_lock())
+        return;
+
+    // An update may have been queued between the first check and the lock, and
+    // the audio thread could be swapping the buffers read below
+    if (numPendingUpdates > 0)
+        return;
+
+    size_t usage = preloadedBytes + streamingBytes + pinnedBytes;
+    if (usage <= budget)
+        return;
+
+    std::vector<const FileInformation*> files;
+    files.reserve(preloadedData.size());
+    for (auto& file : preloadedData)
+        files.push_back(&file.second);
+    std::sort(files.begin(), files.end(), [](const FileInformation* lhs, const FileInformation* rhs) {
+        return lhs->sampleHandle->numPlays.load(std::memory_order_relaxed) < rhs->sampleHandle->numPlays.load(std::memory_order_relaxed);
+    });
+
+    for (auto file : files) {
+        if (usage <= budget)
+            break;
+
+        const auto currentPreload = std::atomic_load(&file->sampleHandle->preloadedData);
+        const auto& preload = *currentPreload;
+        const auto numFrames = static_cast<size_t>(file->minimumPreloadEnd);
+        // Shrinking a preload carved out of a slab would free nothing
+        if (numFrames >= preload.getNumFrames() || preload.isInArena())
+            continue;
+
+        auto shrunkPreload = std::make_shared<SampleBuffer>(preload.getFormat(), preload.getNumChannels(), numFrames, memoryLocking);
+        for (int channel = 0; channel < preload.getNumChannels(); ++channel) {
+            if (preload.getFormat() == SampleBuffer::Format::int16)
+                copy<int16_t>(preload.getInt16Buffer().getConstSpan(channel).first(numFrames), shrunkPreload->getInt16Buffer().getSpan(channel));
+            else
+                copy<float>(preload.getFloatBuffer().getConstSpan(channel).first(numFrames), shrunkPreload->getFloatBuffer().getSpan(channel));
+        }
+
+        const auto freedBytes = preload.getNumBytes() - shrunkPreload->getNumBytes();
+        numPendingUpdates++;
+        if (!evictionQueue.try_enqueue({ file->sampleHandle, std::move(shrunkPreload) })) {
+            numPendingUpdates--;
+            break;
+        }
+        usage -= freedBytes;
+    }
+}
+
+// The audio thread is the only writer of a preload once the file is loaded, but
+// the garbage thread reads it concurrently when it checks the memory budget
+void swapPreload(sfz::SampleHandle& handle, std::shared_ptr<sfz::SampleBuffer>& preload) noexcept
+{
+    auto previous = handle.preloadedData;
+    std::atomic_store(&handle.preloadedData, std::move(preload));
+    preload = std::move(previous);
+}
+
+void sfz::FilePool::applyPreloadUpdates(absl::Span<const std::unique_ptr<Voice>> voices) noexcept
+{
+    flushRetireFallback();
+    PreloadUpdate update;
+    while (growthQueue.try_dequeue(update)) {
+        auto& preload = update.handle->preloadedData;
+        update.handle->preloadPending = false;
+        // A longer preload starts the same way, so the voices playing the file can switch over
+        if (update.preloadedData->getNumFrames() > preload->getNumFrames()) {
+            preloadedBytes += update.preloadedData->getNumBytes();
+            preloadedBytes -= preload->getNumBytes();
+            swapPreload(*update.handle, update.preloadedData);
+            if (update.preloadedData->isInArena())
+                pinnedBytes += update.preloadedData->getNumBytes();
         }
-        fileHandleMutex.unlock();
-        std::this_thread::sleep_for(200ms);
+
+        retire(std::move(update.preloadedData));
+        update.handle.reset();
+        numPendingUpdates--;
+    }
+
+    while (evictionQueue.try_dequeue(update)) {
+        const bool inUse = std::any_of(voices.begin(), voices.end(), [&](const std::unique_ptr<Voice>& voice) {
+            const auto region = voice->getRegion();
+            return region != nullptr && region->sampleHandle == update.handle;
+        });
+
+        // A playing voice may still read past the shrunk preload, so this one is retried on the next check
+        auto& preload = update.handle->preloadedData;
+        if (!inUse && update.preloadedData->getNumFrames() < preload->getNumFrames()) {
+            const auto freedBytes = preload->getNumBytes() - update.preloadedData->getNumBytes();
+            swapPreload(*update.handle, update.preloadedData);
+            preloadedBytes -= freedBytes;
+            numEvictions.store(numEvictions.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            evictedBytes.store(evictedBytes.load(std::memory_order_relaxed) + freedBytes, std::memory_order_relaxed);
+        }
+
+        retire(std::move(update.preloadedData));
+        update.handle.reset();
+        numPendingUpdates--;
     }
 }
 
+sfz::FilePool::MemoryStats sfz::FilePool::getMemoryStats() const noexcept
+{
+    MemoryStats stats;
+    stats.budget = memoryBudget;
+    stats.preloadedBytes = preloadedBytes;
+    stats.streamingBytes = streamingBytes;
+    stats.numEvictions = numEvictions;
+    stats.evictedBytes = evictedBytes;
+    stats.lockedBytes = SampleBuffer::getTotalLockedBytes();
+    stats.numRetireOverflows = numRetireOverflows;
+    stats.pinnedBytes = pinnedBytes;
+    return stats;
+}
+
 void sfz::FilePool::clear()
 {
+    std::lock_guard<std::mutex> guard { preloadMutex };
+    // The audio thread is kept out while clearing, so the preload updates it did not swap in yet are dropped here
+    PreloadUpdate update;
+    while (growthQueue.try_dequeue(update))
+        numPendingUpdates--;
+    while (evictionQueue.try_dequeue(update))
+        numPendingUpdates--;
+    firstLiveSampleId = nextSampleId;
     preloadedData.clear();
-    fileHandles.clear();
+    preloadedBytes = 0;
+    pinnedBytes = 0;
+    // The slabs go away in one go once the voices and the garbage thread let go of the last preloads
+    arena = std::make_unique<SlabArena>();
     while (loadingQueue.pop()) {
         // Pop the queue
     }
+    while (spareLoadingQueue.pop()) {
+        // Pop the queue
+    }
+    while (preloadQueue.pop()) {
+        // Pop the queue
+    }
 }
@@ -26,55 +26,212 @@
 #include "Defaults.h"
 #include "LeakDetector.h"
 #include "AudioBuffer.h"
+#include "SampleBuffer.h"
+#include "SampleHandle.h"
+#include "SlabArena.h"
 #include "Voice.h"
 #include "ghc/fs_std.hpp"
 #include "readerwriterqueue.h"
 #include <absl/container/flat_hash_map.h>
+#include <functional>
 #include <mutex>
 #include <absl/types/optional.h>
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <sndfile.hh>
 #include <string_view>
 #include <thread>
+#include <vector>
 
 namespace sfz {
 class FilePool {
 public:
-    FilePool() { }
+    FilePool() { retireFallback.reserve(config::retireFallbackSize); }
 
     ~FilePool()
     {
         quitThread = true;
+        // Wake up the garbage thread; the audio thread is gone by now, so this is the only producer
+        retireQueue.enqueue(nullptr);
         fileLoadingThread.join();
         garbageCollectionThread.join();
     }
     void setRootDirectory(const fs::path& directory) noexcept { rootDirectory = directory; }
+    // Keep the preloads in this directory so that the next loads do not need to decode the files again;
+    // an empty path disables the cache
+    void setCacheDirectory(const fs::path& directory) noexcept;
     size_t getNumPreloadedSamples() const noexcept { return preloadedData.size(); }
+    size_t getPreloadedBytes() const noexcept { return preloadedBytes; }
+
+    // Preloading policy; a change only applies to the files preloaded afterwards
+    enum class PreloadMode { frames, duration, adaptive };
+    // Preload a fixed number of frames after the offsets; 0 preloads the whole files
+    void setPreloadSize(uint32_t numFrames) noexcept;
+    // Preload a fixed duration after the offsets, whatever the sample rate of the files
+    void setPreloadDuration(float seconds) noexcept;
+    // Preload enough to cover the loader latency at the highest pitch each region can play
+    void setAdaptivePreload() noexcept;
+    PreloadMode getPreloadMode() const noexcept { return preloadMode; }
+    // Peak latency between a voice enqueuing a file and the file data being handed back, in seconds
+    float getLoaderLatency() const noexcept { return loaderLatency; }
+
+    // Everything the regions sharing a file require from its preload
+    struct PreloadRequest {
+        void add(uint32_t offset, float pitchRatio, absl::optional<uint32_t> preloadSize) noexcept;
+        uint32_t maxOffset { 0 }; // largest offset among the regions following the policy
+        float maxPitchRatio { 0.0f }; // largest pitch ratio among the regions following the policy
+        bool usesPolicy { false };
+        uint32_t minimumEnd { 0 }; // largest offset + preload_size among the regions overriding the policy
+        bool deferred { false }; // only the head is preloaded until a region using the file can play
+    };
 
     struct FileInformation {
         uint32_t end { Default::sampleEndRange.getEnd() };
         uint32_t loopBegin { Default::loopRange.getStart() };
         uint32_t loopEnd { Default::loopRange.getEnd() };
         double sampleRate { config::defaultSampleRate };
-        std::shared_ptr<AudioBuffer<float>> preloadedData;
+        uint32_t minimumPreloadEnd { 0 }; // what the preload must still cover when shrunk to fit the memory budget
+        std::shared_ptr<SampleHandle> sampleHandle;
+    };
+    absl::optional<FileInformation> getFileInformation(const std::string& filename, const PreloadRequest& request) noexcept;
+    // Called with the number of files already preloaded and the total number of files to preload,
+    // from whichever preload thread read the file; the calls are serialized
+    using ProgressCallback = std::function<void(int, int)>;
+    // Preload all the files in parallel
+    void preloadFiles(const absl::flat_hash_map<std::string, PreloadRequest>& requests, const ProgressCallback& callback = {}) noexcept;
+    void enqueueLoading(Voice* voice, const std::shared_ptr<SampleHandle>& sample, int numFrames, unsigned ticket) noexcept;
+    // Grow the preload of a file in the background, after the voices waiting on the loader;
+    // called from the audio thread, the request is dropped when the preload queue is full or when
+    // the longer preload would not fit in the memory budget. A grown preload is counted in the budget
+    // and shrunk back like the others.
+    void enqueuePreload(const std::shared_ptr<SampleHandle>& sample, uint32_t numFrames) noexcept;
+    // What to do when a voice finds the loading queue full
+    enum class OverflowPolicy {
+        drop, // the voice plays its preloaded data and then silence
+        grow // the request goes to a spare queue allocated beforehand, with room for one request per voice
+    };
+    void setOverflowPolicy(OverflowPolicy policy) noexcept { overflowPolicy = policy; }
+    OverflowPolicy getOverflowPolicy() const noexcept { return overflowPolicy; }
+    // Requests pending in the queue are kept; this must not be called while voices can enqueue
+    void setLoadingQueueCapacity(size_t capacity) noexcept;
+    struct LoadingStats {
+        size_t capacity { 0 }; // requests the queue holds, which the queue rounds up from the capacity asked for
+        size_t highWaterMark { 0 }; // most requests pending at once
+        size_t numDropped { 0 }; // requests lost to a full queue
+        size_t numFailed { 0 }; // requests for files that could not be read
+        size_t numGrown { 0 }; // requests enqueued past the capacity, in the spare queue
+        size_t numCoalesced { 0 }; // requests served by reading a file once for several voices
     };
-    absl::optional<FileInformation> getFileInformation(const std::string& filename, uint32_t offset) noexcept;
-    void enqueueLoading(Voice* voice, const std::string* sample, int numFrames, unsigned ticket) noexcept;
+    LoadingStats getLoadingStats() const noexcept;
+    void resetLoadingStats() noexcept;
+
+    // Memory budget for the preloads and the buffers streamed to the voices, in bytes; 0 means no limit.
+    // Over budget, the garbage thread shrinks the preloads of the least played files. Set it before
+    // loading the instrument: without a budget the preloads are carved out of slabs, which are only
+    // freed with the instrument, so they are never shrunk.
+    void setMemoryBudget(size_t bytes) noexcept { memoryBudget = bytes; }
+    struct MemoryStats {
+        size_t budget { 0 };
+        size_t preloadedBytes { 0 };
+        size_t streamingBytes { 0 };
+        size_t numEvictions { 0 }; // preloads shrunk to fit the budget
+        size_t evictedBytes { 0 };
+        size_t lockedBytes { 0 }; // sample memory locked in RAM by the whole process
+        size_t numRetireOverflows { 0 }; // buffers that did not fit in the retire queue
+        size_t pinnedBytes { 0 }; // replaced preloads whose slab is held until the instrument is unloaded
+    };
+    MemoryStats getMemoryStats() const noexcept;
+    // Lock the sample data read from now on in RAM
+    void setMemoryLocking(SampleBuffer::Locking locking) noexcept { memoryLocking = locking; }
+    // Swap in the preloads grown in the background and the ones shrunk by the garbage thread, skipping
+    // the files the voices are playing for the latter; called by the audio thread before rendering the voices
+    void applyPreloadUpdates(absl::Span<const std::unique_ptr<Voice>> voices) noexcept;
+    // Hand over a buffer to the garbage thread so that the audio thread never frees sample data;
+    // lock-free and never allocates. The retire queue has a single producer, so this must only be
+    // called from the audio thread: the other threads free their buffers themselves.
+    void retire(std::shared_ptr<SampleBuffer>&& buffer) noexcept;
     void clear();
 private:
+    absl::optional<FileInformation> readFileInformation(const std::string& filename, const PreloadRequest& request) const noexcept;
+    bool hasLargeEnoughPreload(const std::string& filename, const PreloadRequest& request) const noexcept;
+    const FileInformation& storeFileInformation(const std::string& filename, FileInformation&& fileInformation) noexcept;
+    uint32_t preloadEnd(const PreloadRequest& request, uint32_t fileEnd, double fileSampleRate) const noexcept;
+    uint32_t initialPreloadEnd(const PreloadRequest& request, uint32_t fileEnd, double fileSampleRate) const noexcept;
+    void enforceMemoryBudget() noexcept;
+    // Declared before the queues so that it outlives the streamed buffers they may still hold
+    std::atomic<size_t> streamingBytes { 0 };
     fs::path rootDirectory;
+    fs::path cacheDirectory;
     struct FileLoadingInformation {
         Voice* voice;
-        const std::string* sample;
+        std::shared_ptr<SampleHandle> sample;
         int numFrames;
         unsigned ticket;
+        std::chrono::steady_clock::time_point enqueueTime;
     };
+    PreloadMode preloadMode { PreloadMode::frames };
+    uint32_t preloadSize { config::preloadSize };
+    float preloadDuration { 0.0f };
+    std::atomic<float> loaderLatency { 0.0f };
 
-    moodycamel::BlockingReaderWriterQueue<FileLoadingInformation> loadingQueue { config::numVoices };
+    OverflowPolicy overflowPolicy { OverflowPolicy::drop };
+    size_t loadingQueueCapacity { config::loadingQueueSize };
+    moodycamel::BlockingReaderWriterQueue<FileLoadingInformation> loadingQueue { config::loadingQueueSize };
+    // Takes the requests past the capacity under the grow policy, so that the audio thread never allocates
+    moodycamel::ReaderWriterQueue<FileLoadingInformation> spareLoadingQueue { config::loadingQueueSize + config::numVoices };
+    moodycamel::ReaderWriterQueue<FileLoadingInformation> preloadQueue { config::preloadQueueSize };
+    // The high-water mark, drops and growths are only written by the audio thread, the coalesced loads by the loading thread
+    std::atomic<size_t> highWaterMark { 0 };
+    std::atomic<size_t> numDropped { 0 };
+    std::atomic<size_t> numFailed { 0 }; // only written by the loading thread
+    std::atomic<size_t> numGrown { 0 };
+    std::atomic<size_t> numCoalesced { 0 };
     void loadingThread() noexcept;
+    void loadPreload(const FileLoadingInformation& request) noexcept;
+    std::atomic<bool> stopLoadingThread { false };
+    // Bounded cache of open files, only touched by the loading thread; the most recently used come first
+    SndfileHandle openFile(const SampleHandle& sample) noexcept;
+    struct OpenFile {
+        uint32_t sampleId;
+        SndfileHandle handle;
+    };
+    std::list<OpenFile> openFiles;
+    absl::flat_hash_map<uint32_t, std::list<OpenFile>::iterator> openFileIndex;
+    uint32_t nextSampleId { 0 };
+    uint32_t firstLiveSampleId { 0 }; // the handles with a smaller id were cleared
     void garbageThread() noexcept;
-    bool quitThread { false };
-    std::mutex fileHandleMutex;
-    std::vector<std::shared_ptr<AudioBuffer<float>>> fileHandles;
-    absl::flat_hash_map<absl::string_view, std::shared_ptr<AudioBuffer<float>>> preloadedData;
+    std::atomic<bool> quitThread { false };
+    moodycamel::BlockingReaderWriterQueue<std::shared_ptr<SampleBuffer>> retireQueue { config::retireQueueSize };
+    // Buffers that did not fit in the retire queue, handed over once it has room again; only touched by the audio thread
+    std::vector<std::shared_ptr<SampleBuffer>> retireFallback;
+    void flushRetireFallback() noexcept;
+    // Only written by the audio thread
+    std::atomic<size_t> numRetireOverflows { 0 };
+
+    std::atomic<size_t> memoryBudget { 0 };
+    std::atomic<SampleBuffer::Locking> memoryLocking { SampleBuffer::Locking::none };
+    std::atomic<size_t> preloadedBytes { 0 };
+    // Counted against the budget along with the preloads and the streamed buffers
+    std::atomic<size_t> pinnedBytes { 0 };
+    // Only written by the audio thread
+    std::atomic<size_t> numEvictions { 0 };
+    std::atomic<size_t> evictedBytes { 0 };
+    struct PreloadUpdate {
+        std::shared_ptr<SampleHandle> handle;
+        std::shared_ptr<SampleBuffer> preloadedData;
+    };
+    // Filled by the loading thread and the garbage thread respectively, under the preload mutex
+    moodycamel::ReaderWriterQueue<PreloadUpdate> growthQueue { config::evictionQueueSize };
+    moodycamel::ReaderWriterQueue<PreloadUpdate> evictionQueue { config::evictionQueueSize };
+    // Updates not yet swapped in by the audio thread; the garbage thread waits for them before looking at the preloads again
+    std::atomic<int> numPendingUpdates { 0 };
+    // Held while the preloads are loaded, grown or shrunk
+    std::mutex preloadMutex;
+    absl::flat_hash_map<std::string, FileInformation> preloadedData;
+    // The preloads read when loading an instrument without a memory budget are carved out of its slabs;
+    // the deferred ones and the ones grown or shrunk later are not
+    std::unique_ptr<SlabArena> arena { std::make_unique<SlabArena>() };
     std::thread fileLoadingThread { &FilePool::loadingThread, this };
     std::thread garbageCollectionThread { &FilePool::garbageThread, this };
     LEAK_DETECTOR(FilePool);
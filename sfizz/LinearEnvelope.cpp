@@ -75,7 +75,7 @@ void LinearEnvelope<Type>::reset(Type value)
 }
 
 template <class Type>
-void LinearEnvelope<Type>::getBlock(absl::Span<Type> output)
+bool LinearEnvelope<Type>::getBlock(absl::Span<Type> output)
 {
     absl::c_sort(events, [](const auto& lhs, const auto& rhs) {
         return lhs.first < rhs.first;
@@ -98,6 +98,7 @@ void LinearEnvelope<Type>::getBlock(absl::Span<Type> output)
         fill<Type>(output.subspan(index), currentValue);
 
     clear();
+    return index == 0;
 }
 
 }
\ No newline at end of file
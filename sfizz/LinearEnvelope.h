@@ -41,7 +41,8 @@ public:
     void registerEvent(int timestamp, Type inputValue);
     void clear();
     void reset(Type value = 0.0);
-    void getBlock(absl::Span<Type> output);
+    // Returns true when the whole block holds the same value, so that callers can use it as a scalar
+    bool getBlock(absl::Span<Type> output);
 private:
     std::function<Type(Type)> function { [](Type input) { return input; } };
     static_assert(std::is_arithmetic<Type>::value, "Type should be arithmetic");
@@ -0,0 +1,91 @@
+// Copyright (c) 2019, Paul Ferrand
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "MemoryLock.h"
+#include <cstdint>
+#include <utility>
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+size_t getPageSize() noexcept
+{
+#if defined(_WIN32)
+    SYSTEM_INFO systemInfo;
+    GetSystemInfo(&systemInfo);
+    return static_cast<size_t>(systemInfo.dwPageSize);
+#else
+    return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+const size_t pageSize { getPageSize() };
+
+// First and last page boundaries within a range
+std::pair<uintptr_t, uintptr_t> innerPages(void* data, size_t size) noexcept
+{
+    const auto begin = (reinterpret_cast<uintptr_t>(data) + pageSize - 1) / pageSize * pageSize;
+    const auto end = (reinterpret_cast<uintptr_t>(data) + size) / pageSize * pageSize;
+    return { begin, end };
+}
+}
+
+bool sfz::lockMemory(void* data, size_t size, bool hugePages) noexcept
+{
+    if (data == nullptr || size == 0)
+        return false;
+
+#if defined(_WIN32)
+    (void)hugePages;
+    return VirtualLock(data, size) != 0;
+#else
+#if defined(MADV_HUGEPAGE)
+    if (hugePages) {
+        const auto pages = innerPages(data, size);
+        if (pages.second > pages.first)
+            madvise(reinterpret_cast<void*>(pages.first), pages.second - pages.first, MADV_HUGEPAGE);
+    }
+#else
+    (void)hugePages;
+#endif
+    // mlock faults the whole range in before returning
+    return mlock(data, size) == 0;
+#endif
+}
+
+void sfz::unlockMemory(void* data, size_t size) noexcept
+{
+    const auto pages = innerPages(data, size);
+    if (pages.second <= pages.first)
+        return;
+
+#if defined(_WIN32)
+    VirtualUnlock(reinterpret_cast<void*>(pages.first), pages.second - pages.first);
+#else
+    munlock(reinterpret_cast<void*>(pages.first), pages.second - pages.first);
+#endif
+}
@@ -24,7 +24,9 @@
 #pragma once
 #include "Config.h"
 #include "MathHelpers.h"
+#include "SIMDHelpers.h"
 #include <absl/types/span.h>
+#include <array>
 #include <cmath>
 
 namespace sfz
@@ -115,6 +117,18 @@ public:
         return size;
     }
 
+    // Filter one block per voice, running the filters together with one SIMD lane each;
+    // there must be one input and one output per filter, all of the same size
+    static void processLowpassLanes(absl::Span<OnePoleFilter* const> filters, absl::Span<const absl::Span<const Type>> inputs, absl::Span<const absl::Span<Type>> outputs)
+    {
+        processLanes<false>(filters, inputs, outputs);
+    }
+
+    static void processHighpassLanes(absl::Span<OnePoleFilter* const> filters, absl::Span<const absl::Span<const Type>> inputs, absl::Span<const absl::Span<Type>> outputs)
+    {
+        processLanes<true>(filters, inputs, outputs);
+    }
+
     void reset() { state = 0.0; }
 
 private:
@@ -123,6 +137,47 @@ private:
     Type intermediate { 0.0 };
     Type G { gain / (1 + gain) };
 
+    template <bool Highpass>
+    static void processLanes(absl::Span<OnePoleFilter* const> filters, absl::Span<const absl::Span<const Type>> inputs, absl::Span<const absl::Span<Type>> outputs)
+    {
+        // The widest kernel is SSE, which runs 4 lanes at once
+        constexpr size_t batchSize { 4 };
+        std::array<Type, batchSize> states;
+        std::array<Type, batchSize> gains;
+        std::array<const Type*, batchSize> laneInputs;
+        std::array<Type*, batchSize> laneOutputs;
+
+        ASSERT(inputs.size() == filters.size());
+        ASSERT(outputs.size() == filters.size());
+        const auto numFilters = filters.size();
+        if (numFilters == 0)
+            return;
+
+        const auto size = inputs[0].size();
+        for (size_t first = 0; first < numFilters; first += batchSize) {
+            const auto numLanes = min(numFilters - first, batchSize);
+            for (size_t lane = 0; lane < numLanes; ++lane) {
+                ASSERT(inputs[first + lane].size() == size);
+                ASSERT(outputs[first + lane].size() == size);
+                const auto* filter = filters[first + lane];
+                states[lane] = filter->state;
+                gains[lane] = filter->G;
+                laneInputs[lane] = inputs[first + lane].data();
+                laneOutputs[lane] = outputs[first + lane].data();
+            }
+
+            const auto laneStates = absl::MakeSpan(states.data(), numLanes);
+            const auto laneGains = absl::MakeConstSpan(gains.data(), numLanes);
+            if (Highpass)
+                onePoleHighpassLanes<Type>(laneStates, laneGains, absl::MakeConstSpan(laneInputs.data(), numLanes), absl::MakeConstSpan(laneOutputs.data(), numLanes), static_cast<int>(size));
+            else
+                onePoleLowpassLanes<Type>(laneStates, laneGains, absl::MakeConstSpan(laneInputs.data(), numLanes), absl::MakeConstSpan(laneOutputs.data(), numLanes), static_cast<int>(size));
+
+            for (size_t lane = 0; lane < numLanes; ++lane)
+                filters[first + lane]->state = states[lane];
+        }
+    }
+
     inline void oneLowpass(const Type* in, Type* out)
     {
         intermediate = G * (*in - state);
@@ -64,6 +64,12 @@ bool sfz::Region::parseOpcode(const Opcode& opcode)
     case hash("count"):
         setValueFromOpcode(opcode, sampleCount, Default::sampleCountRange);
         break;
+    case hash("preload_size"):
+        setValueFromOpcode(opcode, preloadSize, Default::preloadSizeRange);
+        break;
+    case hash("sample_quality"):
+        setValueFromOpcode(opcode, sampleQuality, Default::sampleQualityRange);
+        break;
     case hash("loopmode"):
     case hash("loop_mode"):
         switch (hash(opcode.value)) {
@@ -486,6 +492,11 @@ bool sfz::Region::isSwitchedOn() const noexcept
     return keySwitched && previousKeySwitched && sequenceSwitched && pitchSwitched && bpmSwitched && aftertouchSwitched && ccSwitched.all();
 }
 
+bool sfz::Region::isNextInSequence() const noexcept
+{
+    return sequenceLength > 1 && ((sequenceCounter + 1) % sequenceLength) == sequencePosition - 1;
+}
+
 bool sfz::Region::registerNoteOn(int channel, int noteNumber, uint8_t velocity, float randValue) noexcept
 {
     const bool chanOk = channelRange.containsWithEnd(channel);
@@ -631,6 +642,18 @@ float sfz::Region::getBasePitchVariation(int noteNumber, uint8_t velocity) noexc
     return centsFactor(pitchVariationInCents);
 }
 
+float sfz::Region::getMaxPitchRatio() const noexcept
+{
+    // The keytracking is linear so the highest pitch is at one end of the key range
+    auto maxPitchVariationInCents = std::max(pitchKeytrack * (keyRange.getStart() - (int)pitchKeycenter),
+                                             pitchKeytrack * (keyRange.getEnd() - (int)pitchKeycenter));
+    maxPitchVariationInCents += tune;
+    maxPitchVariationInCents += config::centPerSemitone * transpose;
+    maxPitchVariationInCents += std::max(pitchVeltrack, 0);
+    maxPitchVariationInCents += pitchRandom;
+    return centsFactor(maxPitchVariationInCents);
+}
+
 float sfz::Region::getBaseVolumedB(int noteNumber) noexcept
 {
     auto baseVolumedB = volume + volumeDistribution(Random::randomGenerator);
@@ -656,15 +679,19 @@ uint32_t sfz::Region::getDelay() noexcept
 
 uint32_t sfz::Region::trueSampleEnd() const noexcept
 {
+    // Sustain loops play on to the end of the sample once released
+    if (loopMode == SfzLoopMode::loop_sustain)
+        return sampleEnd;
+
     return min(sampleEnd, loopRange.getEnd());
 }
 
 bool sfz::Region::canUsePreloadedData() const noexcept
 {
-    if (preloadedData == nullptr)
+    if (sampleHandle == nullptr || sampleHandle->preloadedData == nullptr)
         return false;
 
-    return trueSampleEnd() < static_cast<uint32_t>(preloadedData->getNumFrames());
+    return trueSampleEnd() < static_cast<uint32_t>(sampleHandle->preloadedData->getNumFrames());
 }
 
 bool sfz::Region::isStereo() const noexcept
@@ -672,7 +699,7 @@ bool sfz::Region::isStereo() const noexcept
     if (isGenerator())
         return 1;
 
-    return (this->preloadedData->getNumChannels() == 2);
+    return (this->sampleHandle->preloadedData->getNumChannels() == 2);
 }
 
 template<class T, class U>
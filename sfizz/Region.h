@@ -28,6 +28,7 @@
 #include "EGDescription.h"
 #include "Opcode.h"
 #include "AudioBuffer.h"
+#include "SampleHandle.h"
 #include "MidiState.h"
 #include <bitset>
 #include <absl/types/optional.h>
@@ -49,6 +50,7 @@ struct Region {
     bool isGenerator() const noexcept { return sample.size() > 0 ? sample[0] == '*' : false; }
     bool shouldLoop() const noexcept { return (loopMode == SfzLoopMode::loop_continuous || loopMode == SfzLoopMode::loop_sustain); }
     bool isSwitchedOn() const noexcept;
+    bool isNextInSequence() const noexcept;
     bool registerNoteOn(int channel, int noteNumber, uint8_t velocity, float randValue) noexcept;
     bool registerNoteOff(int channel, int noteNumber, uint8_t velocity, float randValue) noexcept;
     bool registerCC(int channel, int ccNumber, uint8_t ccValue) noexcept;
@@ -57,6 +59,7 @@ struct Region {
     void registerTempo(float secondsPerQuarter) noexcept;
     bool isStereo() const noexcept;
     float getBasePitchVariation(int noteNumber, uint8_t velocity) noexcept;
+    float getMaxPitchRatio() const noexcept;
     float getNoteGain(int noteNumber, uint8_t velocity) noexcept;
     float getCrossfadeGain(const CCValueArray& ccState) noexcept;
     float getBaseVolumedB(int noteNumber) noexcept;
@@ -78,6 +81,8 @@ struct Region {
     absl::optional<uint32_t> sampleCount {}; // count
     SfzLoopMode loopMode { Default::loopMode }; // loopmode
     Range<uint32_t> loopRange { Default::loopRange }; //loopstart and loopend
+    absl::optional<uint32_t> preloadSize {}; // preload_size
+    absl::optional<int> sampleQuality {}; // sample_quality; the synth setting applies when unset
 
     // Instrument settings: voice lifecycle
     uint32_t group { Default::group }; // group
@@ -154,7 +159,7 @@ struct Region {
     EGDescription filterEG;
 
     double sampleRate { config::defaultSampleRate };
-    std::shared_ptr<AudioBuffer<float>> preloadedData { nullptr };
+    std::shared_ptr<SampleHandle> sampleHandle { nullptr };
 private:
     const MidiState& midiState;
     bool keySwitched { true };
@@ -0,0 +1,340 @@
+// Copyright (c) 2019, Paul Ferrand
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "SIMDAVX2.h"
+#include "Debug.h"
+#include <immintrin.h>
+
+// This file is built with AVX2 enabled, so nothing in here may run before checking that the processor supports it.
+// It also stays away from the inline helpers shared with the other files: the linker could keep the AVX2 build
+// of those for the whole library.
+namespace {
+constexpr int AVX2Width { 8 };
+
+size_t minSize(size_t size1, size_t size2) noexcept
+{
+    return size1 < size2 ? size1 : size2;
+}
+}
+
+void sfz::avx2::readInterleaved(absl::Span<const float> input, absl::Span<float> outputLeft, absl::Span<float> outputRight) noexcept
+{
+    ASSERT(outputLeft.size() >= input.size() / 2);
+    ASSERT(outputRight.size() >= input.size() / 2);
+
+    auto* in = input.data();
+    auto* left = outputLeft.data();
+    auto* right = outputRight.data();
+    const auto* sentinel = in + minSize(input.size(), minSize(outputLeft.size(), outputRight.size()) * 2);
+
+    while (sentinel - in >= 2 * AVX2Width) {
+        const auto mmFirst = _mm256_loadu_ps(in);
+        const auto mmSecond = _mm256_loadu_ps(in + AVX2Width);
+        // The shuffles work within the 128 bit lanes, which leaves the frames in the order 0 1 4 5 2 3 6 7
+        const auto mmLeft = _mm256_shuffle_ps(mmFirst, mmSecond, 0b10001000);
+        const auto mmRight = _mm256_shuffle_ps(mmFirst, mmSecond, 0b11011101);
+        _mm256_storeu_ps(left, _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(mmLeft), 0b11011000)));
+        _mm256_storeu_ps(right, _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(mmRight), 0b11011000)));
+        in += 2 * AVX2Width;
+        left += AVX2Width;
+        right += AVX2Width;
+    }
+
+    while (sentinel - in >= 2) {
+        *left++ = *in++;
+        *right++ = *in++;
+    }
+}
+
+void sfz::avx2::writeInterleaved(absl::Span<const float> inputLeft, absl::Span<const float> inputRight, absl::Span<float> output) noexcept
+{
+    ASSERT(inputLeft.size() <= output.size() / 2);
+    ASSERT(inputRight.size() <= output.size() / 2);
+
+    auto* left = inputLeft.data();
+    auto* right = inputRight.data();
+    auto* out = output.data();
+    const auto* sentinel = out + minSize(output.size(), minSize(inputLeft.size(), inputRight.size()) * 2);
+
+    while (sentinel - out >= 2 * AVX2Width) {
+        const auto mmLeft = _mm256_loadu_ps(left);
+        const auto mmRight = _mm256_loadu_ps(right);
+        // The unpacks work within the 128 bit lanes too: the low one holds the frames 0 1 4 5 and the high one 2 3 6 7
+        const auto mmLow = _mm256_unpacklo_ps(mmLeft, mmRight);
+        const auto mmHigh = _mm256_unpackhi_ps(mmLeft, mmRight);
+        _mm256_storeu_ps(out, _mm256_permute2f128_ps(mmLow, mmHigh, 0x20));
+        _mm256_storeu_ps(out + AVX2Width, _mm256_permute2f128_ps(mmLow, mmHigh, 0x31));
+        out += 2 * AVX2Width;
+        left += AVX2Width;
+        right += AVX2Width;
+    }
+
+    while (sentinel - out >= 2) {
+        *out++ = *left++;
+        *out++ = *right++;
+    }
+}
+
+void sfz::avx2::applyGain(float gain, absl::Span<const float> input, absl::Span<float> output) noexcept
+{
+    auto* in = input.data();
+    auto* out = output.data();
+    const auto* sentinel = out + minSize(input.size(), output.size());
+    const auto mmGain = _mm256_set1_ps(gain);
+
+    while (sentinel - out >= AVX2Width) {
+        _mm256_storeu_ps(out, _mm256_mul_ps(mmGain, _mm256_loadu_ps(in)));
+        in += AVX2Width;
+        out += AVX2Width;
+    }
+
+    while (out < sentinel)
+        *out++ = gain * (*in++);
+}
+
+void sfz::avx2::applyGain(absl::Span<const float> gain, absl::Span<const float> input, absl::Span<float> output) noexcept
+{
+    auto* g = gain.data();
+    auto* in = input.data();
+    auto* out = output.data();
+    const auto* sentinel = out + minSize(gain.size(), minSize(input.size(), output.size()));
+
+    while (sentinel - out >= AVX2Width) {
+        _mm256_storeu_ps(out, _mm256_mul_ps(_mm256_loadu_ps(g), _mm256_loadu_ps(in)));
+        g += AVX2Width;
+        in += AVX2Width;
+        out += AVX2Width;
+    }
+
+    while (out < sentinel)
+        *out++ = (*g++) * (*in++);
+}
+
+void sfz::avx2::multiplyAdd(absl::Span<const float> gain, absl::Span<const float> input, absl::Span<float> output) noexcept
+{
+    auto* g = gain.data();
+    auto* in = input.data();
+    auto* out = output.data();
+    const auto* sentinel = out + minSize(gain.size(), minSize(input.size(), output.size()));
+
+    // No FMA here: it is a separate CPUID flag, and fusing would round differently from the other paths
+    while (sentinel - out >= AVX2Width) {
+        const auto mmProduct = _mm256_mul_ps(_mm256_loadu_ps(g), _mm256_loadu_ps(in));
+        _mm256_storeu_ps(out, _mm256_add_ps(mmProduct, _mm256_loadu_ps(out)));
+        g += AVX2Width;
+        in += AVX2Width;
+        out += AVX2Width;
+    }
+
+    while (out < sentinel)
+        *out++ += (*g++) * (*in++);
+}
+
+float sfz::avx2::linearRamp(absl::Span<float> output, float value, float step) noexcept
+{
+    auto* out = output.data();
+    const auto* sentinel = out + output.size();
+    const auto mmLastLane = _mm256_set1_epi32(AVX2Width - 1);
+    const auto mmStep = _mm256_mul_ps(_mm256_set1_ps(step), _mm256_setr_ps(1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f));
+    auto mmValue = _mm256_set1_ps(value);
+
+    while (sentinel - out >= AVX2Width) {
+        mmValue = _mm256_add_ps(mmValue, mmStep);
+        _mm256_storeu_ps(out, mmValue);
+        mmValue = _mm256_permutevar8x32_ps(mmValue, mmLastLane);
+        out += AVX2Width;
+    }
+
+    value = _mm256_cvtss_f32(mmValue);
+    while (out < sentinel) {
+        value += step;
+        *out++ = value;
+    }
+    return value;
+}
+
+float sfz::avx2::multiplicativeRamp(absl::Span<float> output, float value, float step) noexcept
+{
+    auto* out = output.data();
+    const auto* sentinel = out + output.size();
+    const auto mmLastLane = _mm256_set1_epi32(AVX2Width - 1);
+    alignas(32) float steps[AVX2Width];
+    steps[0] = step;
+    for (int i = 1; i < AVX2Width; ++i)
+        steps[i] = steps[i - 1] * step;
+    const auto mmStep = _mm256_load_ps(steps);
+    auto mmValue = _mm256_set1_ps(value);
+
+    while (sentinel - out >= AVX2Width) {
+        mmValue = _mm256_mul_ps(mmValue, mmStep);
+        _mm256_storeu_ps(out, mmValue);
+        mmValue = _mm256_permutevar8x32_ps(mmValue, mmLastLane);
+        out += AVX2Width;
+    }
+
+    value = _mm256_cvtss_f32(mmValue);
+    while (out < sentinel) {
+        value *= step;
+        *out++ = value;
+    }
+    return value;
+}
+
+void sfz::avx2::cumsum(absl::Span<const float> input, absl::Span<float> output) noexcept
+{
+    ASSERT(output.size() >= input.size());
+    if (input.size() == 0)
+        return;
+
+    auto* in = input.data();
+    auto* out = output.data();
+    const auto* sentinel = in + minSize(input.size(), output.size());
+    const auto mmLastLane = _mm256_set1_epi32(AVX2Width - 1);
+    const auto mmLowLaneEnd = _mm256_set1_epi32(3);
+    auto mmOutput = _mm256_setzero_ps();
+
+    while (sentinel - in >= AVX2Width) {
+        // Prefix sums within the 128 bit lanes, then the sum of the low lane carried over to the high one
+        auto mmSum = _mm256_loadu_ps(in);
+        mmSum = _mm256_add_ps(mmSum, _mm256_castsi256_ps(_mm256_slli_si256(_mm256_castps_si256(mmSum), 4)));
+        mmSum = _mm256_add_ps(mmSum, _mm256_castsi256_ps(_mm256_slli_si256(_mm256_castps_si256(mmSum), 8)));
+        const auto mmCarry = _mm256_blend_ps(_mm256_setzero_ps(), _mm256_permutevar8x32_ps(mmSum, mmLowLaneEnd), 0xF0);
+        mmOutput = _mm256_add_ps(mmOutput, _mm256_add_ps(mmSum, mmCarry));
+        _mm256_storeu_ps(out, mmOutput);
+        mmOutput = _mm256_permutevar8x32_ps(mmOutput, mmLastLane);
+        in += AVX2Width;
+        out += AVX2Width;
+    }
+
+    auto sum = _mm256_cvtss_f32(mmOutput);
+    while (in < sentinel) {
+        sum += *in++;
+        *out++ = sum;
+    }
+}
+
+void sfz::avx2::sfzInterpolationCast(absl::Span<const float> floatJumps, absl::Span<int> jumps, absl::Span<float> leftCoeffs, absl::Span<float> rightCoeffs) noexcept
+{
+    ASSERT(jumps.size() >= floatJumps.size());
+    ASSERT(jumps.size() == leftCoeffs.size());
+    ASSERT(jumps.size() == rightCoeffs.size());
+
+    auto* floatJump = floatJumps.data();
+    auto* jump = jumps.data();
+    auto* leftCoeff = leftCoeffs.data();
+    auto* rightCoeff = rightCoeffs.data();
+    const auto* sentinel = floatJump + minSize(minSize(floatJumps.size(), jumps.size()), minSize(leftCoeffs.size(), rightCoeffs.size()));
+    const auto mmOne = _mm256_set1_ps(1.0f);
+
+    while (sentinel - floatJump >= AVX2Width) {
+        // Truncating like the scalar cast
+        const auto mmFloatJumps = _mm256_loadu_ps(floatJump);
+        const auto mmIndices = _mm256_cvttps_epi32(mmFloatJumps);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(jump), mmIndices);
+        const auto mmRight = _mm256_sub_ps(mmFloatJumps, _mm256_cvtepi32_ps(mmIndices));
+        _mm256_storeu_ps(leftCoeff, _mm256_sub_ps(mmOne, mmRight));
+        _mm256_storeu_ps(rightCoeff, mmRight);
+        floatJump += AVX2Width;
+        jump += AVX2Width;
+        leftCoeff += AVX2Width;
+        rightCoeff += AVX2Width;
+    }
+
+    while (floatJump < sentinel) {
+        *jump = static_cast<int>(*floatJump);
+        *rightCoeff = *floatJump++ - static_cast<float>(*jump++);
+        *leftCoeff++ = 1.0f - *rightCoeff++;
+    }
+}
+
+void sfz::avx2::interpolate(absl::Span<const float> source, absl::Span<const int> indices, absl::Span<const float> leftCoeffs, absl::Span<const float> rightCoeffs, absl::Span<float> output) noexcept
+{
+    ASSERT(output.size() >= indices.size());
+    ASSERT(leftCoeffs.size() >= indices.size());
+    ASSERT(rightCoeffs.size() >= indices.size());
+
+    auto index = indices.data();
+    auto leftCoeff = leftCoeffs.data();
+    auto rightCoeff = rightCoeffs.data();
+    auto out = output.data();
+    const auto sentinel = out + minSize(minSize(indices.size(), leftCoeffs.size()), minSize(rightCoeffs.size(), output.size()));
+
+    // Unaligned loads cost nothing more on AVX2 processors when the data happens to be aligned
+    while (sentinel - out >= AVX2Width) {
+        const auto mmIndices = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(index));
+        const auto mmLeft = _mm256_i32gather_ps(source.data(), mmIndices, sizeof(float));
+        const auto mmRight = _mm256_i32gather_ps(source.data() + 1, mmIndices, sizeof(float));
+        const auto mmOutput = _mm256_add_ps(_mm256_mul_ps(mmLeft, _mm256_loadu_ps(leftCoeff)), _mm256_mul_ps(mmRight, _mm256_loadu_ps(rightCoeff)));
+        _mm256_storeu_ps(out, mmOutput);
+        index += AVX2Width;
+        leftCoeff += AVX2Width;
+        rightCoeff += AVX2Width;
+        out += AVX2Width;
+    }
+
+    const auto* data = source.data();
+    while (out < sentinel) {
+        *out++ = data[*index] * (*leftCoeff++) + data[*index + 1] * (*rightCoeff++);
+        index++;
+    }
+}
+
+void sfz::avx2::interpolateStereo(absl::Span<const float> leftSource, absl::Span<const float> rightSource, absl::Span<const int> indices, absl::Span<const float> leftCoeffs, absl::Span<const float> rightCoeffs, absl::Span<float> leftOutput, absl::Span<float> rightOutput) noexcept
+{
+    ASSERT(leftOutput.size() >= indices.size());
+    ASSERT(rightOutput.size() >= indices.size());
+    ASSERT(leftCoeffs.size() >= indices.size());
+    ASSERT(rightCoeffs.size() >= indices.size());
+
+    auto index = indices.data();
+    auto leftCoeff = leftCoeffs.data();
+    auto rightCoeff = rightCoeffs.data();
+    auto left = leftOutput.data();
+    auto right = rightOutput.data();
+    const auto sentinel = left + minSize(minSize(indices.size(), minSize(leftCoeffs.size(), rightCoeffs.size())), minSize(leftOutput.size(), rightOutput.size()));
+
+    while (sentinel - left >= AVX2Width) {
+        const auto mmIndices = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(index));
+        const auto mmLeftCoeffs = _mm256_loadu_ps(leftCoeff);
+        const auto mmRightCoeffs = _mm256_loadu_ps(rightCoeff);
+        const auto mmLeftFirst = _mm256_i32gather_ps(leftSource.data(), mmIndices, sizeof(float));
+        const auto mmLeftNext = _mm256_i32gather_ps(leftSource.data() + 1, mmIndices, sizeof(float));
+        const auto mmRightFirst = _mm256_i32gather_ps(rightSource.data(), mmIndices, sizeof(float));
+        const auto mmRightNext = _mm256_i32gather_ps(rightSource.data() + 1, mmIndices, sizeof(float));
+        _mm256_storeu_ps(left, _mm256_add_ps(_mm256_mul_ps(mmLeftFirst, mmLeftCoeffs), _mm256_mul_ps(mmLeftNext, mmRightCoeffs)));
+        _mm256_storeu_ps(right, _mm256_add_ps(_mm256_mul_ps(mmRightFirst, mmLeftCoeffs), _mm256_mul_ps(mmRightNext, mmRightCoeffs)));
+        index += AVX2Width;
+        leftCoeff += AVX2Width;
+        rightCoeff += AVX2Width;
+        left += AVX2Width;
+        right += AVX2Width;
+    }
+
+    const auto* leftData = leftSource.data();
+    const auto* rightData = rightSource.data();
+    while (left < sentinel) {
+        *left++ = leftData[*index] * (*leftCoeff) + leftData[*index + 1] * (*rightCoeff);
+        *right++ = rightData[*index] * (*leftCoeff++) + rightData[*index + 1] * (*rightCoeff++);
+        index++;
+    }
+}
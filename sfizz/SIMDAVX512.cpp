@@ -0,0 +1,309 @@
+// Copyright (c) 2019, Paul Ferrand
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "SIMDAVX512.h"
+#include "Debug.h"
+#include <immintrin.h>
+
+// Same rules as the AVX2 kernels: this file is built with AVX-512F enabled, so nothing in here may run before
+// checking the processor, and none of the inline helpers shared with the other files may be used.
+namespace {
+constexpr int AVX512Width { 16 };
+// GCC leaves the pass-through of the unmasked gathers, conversions and permutations undefined, and then
+// warns about it; the zero-masking forms with every lane set compile to the same instructions
+constexpr __mmask16 allLanes { 0xFFFF };
+
+size_t minSize(size_t size1, size_t size2) noexcept
+{
+    return size1 < size2 ? size1 : size2;
+}
+}
+
+void sfz::avx512::readInterleaved(absl::Span<const float> input, absl::Span<float> outputLeft, absl::Span<float> outputRight) noexcept
+{
+    ASSERT(outputLeft.size() >= input.size() / 2);
+    ASSERT(outputRight.size() >= input.size() / 2);
+
+    auto* in = input.data();
+    auto* left = outputLeft.data();
+    auto* right = outputRight.data();
+    const auto* sentinel = in + minSize(input.size(), minSize(outputLeft.size(), outputRight.size()) * 2);
+    // Indices 16 and above select from the second register
+    const auto mmLeftIndices = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+    const auto mmRightIndices = _mm512_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31);
+
+    while (sentinel - in >= 2 * AVX512Width) {
+        const auto mmFirst = _mm512_loadu_ps(in);
+        const auto mmSecond = _mm512_loadu_ps(in + AVX512Width);
+        _mm512_storeu_ps(left, _mm512_permutex2var_ps(mmFirst, mmLeftIndices, mmSecond));
+        _mm512_storeu_ps(right, _mm512_permutex2var_ps(mmFirst, mmRightIndices, mmSecond));
+        in += 2 * AVX512Width;
+        left += AVX512Width;
+        right += AVX512Width;
+    }
+
+    while (sentinel - in >= 2) {
+        *left++ = *in++;
+        *right++ = *in++;
+    }
+}
+
+void sfz::avx512::writeInterleaved(absl::Span<const float> inputLeft, absl::Span<const float> inputRight, absl::Span<float> output) noexcept
+{
+    ASSERT(inputLeft.size() <= output.size() / 2);
+    ASSERT(inputRight.size() <= output.size() / 2);
+
+    auto* left = inputLeft.data();
+    auto* right = inputRight.data();
+    auto* out = output.data();
+    const auto* sentinel = out + minSize(output.size(), minSize(inputLeft.size(), inputRight.size()) * 2);
+    const auto mmLowIndices = _mm512_setr_epi32(0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23);
+    const auto mmHighIndices = _mm512_setr_epi32(8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31);
+
+    while (sentinel - out >= 2 * AVX512Width) {
+        const auto mmLeft = _mm512_loadu_ps(left);
+        const auto mmRight = _mm512_loadu_ps(right);
+        _mm512_storeu_ps(out, _mm512_permutex2var_ps(mmLeft, mmLowIndices, mmRight));
+        _mm512_storeu_ps(out + AVX512Width, _mm512_permutex2var_ps(mmLeft, mmHighIndices, mmRight));
+        out += 2 * AVX512Width;
+        left += AVX512Width;
+        right += AVX512Width;
+    }
+
+    while (sentinel - out >= 2) {
+        *out++ = *left++;
+        *out++ = *right++;
+    }
+}
+
+void sfz::avx512::applyGain(float gain, absl::Span<const float> input, absl::Span<float> output) noexcept
+{
+    auto* in = input.data();
+    auto* out = output.data();
+    const auto* sentinel = out + minSize(input.size(), output.size());
+    const auto mmGain = _mm512_set1_ps(gain);
+
+    while (sentinel - out >= AVX512Width) {
+        _mm512_storeu_ps(out, _mm512_mul_ps(mmGain, _mm512_loadu_ps(in)));
+        in += AVX512Width;
+        out += AVX512Width;
+    }
+
+    while (out < sentinel)
+        *out++ = gain * (*in++);
+}
+
+void sfz::avx512::applyGain(absl::Span<const float> gain, absl::Span<const float> input, absl::Span<float> output) noexcept
+{
+    auto* g = gain.data();
+    auto* in = input.data();
+    auto* out = output.data();
+    const auto* sentinel = out + minSize(gain.size(), minSize(input.size(), output.size()));
+
+    while (sentinel - out >= AVX512Width) {
+        _mm512_storeu_ps(out, _mm512_mul_ps(_mm512_loadu_ps(g), _mm512_loadu_ps(in)));
+        g += AVX512Width;
+        in += AVX512Width;
+        out += AVX512Width;
+    }
+
+    while (out < sentinel)
+        *out++ = (*g++) * (*in++);
+}
+
+void sfz::avx512::multiplyAdd(absl::Span<const float> gain, absl::Span<const float> input, absl::Span<float> output) noexcept
+{
+    auto* g = gain.data();
+    auto* in = input.data();
+    auto* out = output.data();
+    const auto* sentinel = out + minSize(gain.size(), minSize(input.size(), output.size()));
+
+    // Not fused, so that the results match the other paths
+    while (sentinel - out >= AVX512Width) {
+        const auto mmProduct = _mm512_mul_ps(_mm512_loadu_ps(g), _mm512_loadu_ps(in));
+        _mm512_storeu_ps(out, _mm512_add_ps(mmProduct, _mm512_loadu_ps(out)));
+        g += AVX512Width;
+        in += AVX512Width;
+        out += AVX512Width;
+    }
+
+    while (out < sentinel)
+        *out++ += (*g++) * (*in++);
+}
+
+float sfz::avx512::linearRamp(absl::Span<float> output, float value, float step) noexcept
+{
+    auto* out = output.data();
+    const auto* sentinel = out + output.size();
+    const auto mmLastLane = _mm512_set1_epi32(AVX512Width - 1);
+    const auto mmLanes = _mm512_setr_ps(1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f, 9.0f, 10.0f, 11.0f, 12.0f, 13.0f, 14.0f, 15.0f, 16.0f);
+    const auto mmStep = _mm512_mul_ps(_mm512_set1_ps(step), mmLanes);
+    auto mmValue = _mm512_set1_ps(value);
+
+    while (sentinel - out >= AVX512Width) {
+        mmValue = _mm512_add_ps(mmValue, mmStep);
+        _mm512_storeu_ps(out, mmValue);
+        mmValue = _mm512_maskz_permutexvar_ps(allLanes, mmLastLane, mmValue);
+        out += AVX512Width;
+    }
+
+    value = _mm512_cvtss_f32(mmValue);
+    while (out < sentinel) {
+        value += step;
+        *out++ = value;
+    }
+    return value;
+}
+
+float sfz::avx512::multiplicativeRamp(absl::Span<float> output, float value, float step) noexcept
+{
+    auto* out = output.data();
+    const auto* sentinel = out + output.size();
+    const auto mmLastLane = _mm512_set1_epi32(AVX512Width - 1);
+    alignas(64) float steps[AVX512Width];
+    steps[0] = step;
+    for (int i = 1; i < AVX512Width; ++i)
+        steps[i] = steps[i - 1] * step;
+    const auto mmStep = _mm512_load_ps(steps);
+    auto mmValue = _mm512_set1_ps(value);
+
+    while (sentinel - out >= AVX512Width) {
+        mmValue = _mm512_mul_ps(mmValue, mmStep);
+        _mm512_storeu_ps(out, mmValue);
+        mmValue = _mm512_maskz_permutexvar_ps(allLanes, mmLastLane, mmValue);
+        out += AVX512Width;
+    }
+
+    value = _mm512_cvtss_f32(mmValue);
+    while (out < sentinel) {
+        value *= step;
+        *out++ = value;
+    }
+    return value;
+}
+
+void sfz::avx512::sfzInterpolationCast(absl::Span<const float> floatJumps, absl::Span<int> jumps, absl::Span<float> leftCoeffs, absl::Span<float> rightCoeffs) noexcept
+{
+    ASSERT(jumps.size() >= floatJumps.size());
+    ASSERT(jumps.size() == leftCoeffs.size());
+    ASSERT(jumps.size() == rightCoeffs.size());
+
+    auto* floatJump = floatJumps.data();
+    auto* jump = jumps.data();
+    auto* leftCoeff = leftCoeffs.data();
+    auto* rightCoeff = rightCoeffs.data();
+    const auto* sentinel = floatJump + minSize(minSize(floatJumps.size(), jumps.size()), minSize(leftCoeffs.size(), rightCoeffs.size()));
+    const auto mmOne = _mm512_set1_ps(1.0f);
+
+    while (sentinel - floatJump >= AVX512Width) {
+        // Truncating like the scalar cast
+        const auto mmFloatJumps = _mm512_loadu_ps(floatJump);
+        const auto mmIndices = _mm512_maskz_cvttps_epi32(allLanes, mmFloatJumps);
+        _mm512_storeu_si512(jump, mmIndices);
+        const auto mmRight = _mm512_sub_ps(mmFloatJumps, _mm512_maskz_cvtepi32_ps(allLanes, mmIndices));
+        _mm512_storeu_ps(leftCoeff, _mm512_sub_ps(mmOne, mmRight));
+        _mm512_storeu_ps(rightCoeff, mmRight);
+        floatJump += AVX512Width;
+        jump += AVX512Width;
+        leftCoeff += AVX512Width;
+        rightCoeff += AVX512Width;
+    }
+
+    while (floatJump < sentinel) {
+        *jump = static_cast<int>(*floatJump);
+        *rightCoeff = *floatJump++ - static_cast<float>(*jump++);
+        *leftCoeff++ = 1.0f - *rightCoeff++;
+    }
+}
+
+void sfz::avx512::interpolate(absl::Span<const float> source, absl::Span<const int> indices, absl::Span<const float> leftCoeffs, absl::Span<const float> rightCoeffs, absl::Span<float> output) noexcept
+{
+    ASSERT(output.size() >= indices.size());
+    ASSERT(leftCoeffs.size() >= indices.size());
+    ASSERT(rightCoeffs.size() >= indices.size());
+
+    auto* index = indices.data();
+    auto* leftCoeff = leftCoeffs.data();
+    auto* rightCoeff = rightCoeffs.data();
+    auto* out = output.data();
+    const auto* sentinel = out + minSize(minSize(indices.size(), leftCoeffs.size()), minSize(rightCoeffs.size(), output.size()));
+
+    while (sentinel - out >= AVX512Width) {
+        const auto mmIndices = _mm512_loadu_si512(index);
+        const auto mmLeft = _mm512_mask_i32gather_ps(_mm512_setzero_ps(), allLanes, mmIndices, source.data(), sizeof(float));
+        const auto mmRight = _mm512_mask_i32gather_ps(_mm512_setzero_ps(), allLanes, mmIndices, source.data() + 1, sizeof(float));
+        const auto mmOutput = _mm512_add_ps(_mm512_mul_ps(mmLeft, _mm512_loadu_ps(leftCoeff)), _mm512_mul_ps(mmRight, _mm512_loadu_ps(rightCoeff)));
+        _mm512_storeu_ps(out, mmOutput);
+        index += AVX512Width;
+        leftCoeff += AVX512Width;
+        rightCoeff += AVX512Width;
+        out += AVX512Width;
+    }
+
+    const auto* data = source.data();
+    while (out < sentinel) {
+        *out++ = data[*index] * (*leftCoeff++) + data[*index + 1] * (*rightCoeff++);
+        index++;
+    }
+}
+
+void sfz::avx512::interpolateStereo(absl::Span<const float> leftSource, absl::Span<const float> rightSource, absl::Span<const int> indices, absl::Span<const float> leftCoeffs, absl::Span<const float> rightCoeffs, absl::Span<float> leftOutput, absl::Span<float> rightOutput) noexcept
+{
+    ASSERT(leftOutput.size() >= indices.size());
+    ASSERT(rightOutput.size() >= indices.size());
+    ASSERT(leftCoeffs.size() >= indices.size());
+    ASSERT(rightCoeffs.size() >= indices.size());
+
+    auto* index = indices.data();
+    auto* leftCoeff = leftCoeffs.data();
+    auto* rightCoeff = rightCoeffs.data();
+    auto* left = leftOutput.data();
+    auto* right = rightOutput.data();
+    const auto* sentinel = left + minSize(minSize(indices.size(), minSize(leftCoeffs.size(), rightCoeffs.size())), minSize(leftOutput.size(), rightOutput.size()));
+
+    while (sentinel - left >= AVX512Width) {
+        const auto mmIndices = _mm512_loadu_si512(index);
+        const auto mmLeftCoeffs = _mm512_loadu_ps(leftCoeff);
+        const auto mmRightCoeffs = _mm512_loadu_ps(rightCoeff);
+        const auto mmLeftFirst = _mm512_mask_i32gather_ps(_mm512_setzero_ps(), allLanes, mmIndices, leftSource.data(), sizeof(float));
+        const auto mmLeftNext = _mm512_mask_i32gather_ps(_mm512_setzero_ps(), allLanes, mmIndices, leftSource.data() + 1, sizeof(float));
+        const auto mmRightFirst = _mm512_mask_i32gather_ps(_mm512_setzero_ps(), allLanes, mmIndices, rightSource.data(), sizeof(float));
+        const auto mmRightNext = _mm512_mask_i32gather_ps(_mm512_setzero_ps(), allLanes, mmIndices, rightSource.data() + 1, sizeof(float));
+        _mm512_storeu_ps(left, _mm512_add_ps(_mm512_mul_ps(mmLeftFirst, mmLeftCoeffs), _mm512_mul_ps(mmLeftNext, mmRightCoeffs)));
+        _mm512_storeu_ps(right, _mm512_add_ps(_mm512_mul_ps(mmRightFirst, mmLeftCoeffs), _mm512_mul_ps(mmRightNext, mmRightCoeffs)));
+        index += AVX512Width;
+        leftCoeff += AVX512Width;
+        rightCoeff += AVX512Width;
+        left += AVX512Width;
+        right += AVX512Width;
+    }
+
+    const auto* leftData = leftSource.data();
+    const auto* rightData = rightSource.data();
+    while (left < sentinel) {
+        *left++ = leftData[*index] * (*leftCoeff) + leftData[*index + 1] * (*rightCoeff);
+        *right++ = rightData[*index] * (*leftCoeff++) + rightData[*index + 1] * (*rightCoeff++);
+        index++;
+    }
+}
@@ -23,6 +23,20 @@
 
 #include "SIMDHelpers.h"
 
+sfz::SIMDPath sfz::getSupportedSIMDPath() noexcept
+{
+    return SIMDPath::scalar;
+}
+
+sfz::SIMDPath sfz::getSIMDPath() noexcept
+{
+    return SIMDPath::scalar;
+}
+
+void sfz::setSIMDPath(SIMDPath path [[maybe_unused]]) noexcept
+{
+}
+
 template <>
 void sfz::readInterleaved<float, true>(absl::Span<const float> input, absl::Span<float> outputLeft, absl::Span<float> outputRight) noexcept
 {
@@ -173,4 +187,78 @@ template <>
 void sfz::diff<float, true>(absl::Span<const float> input, absl::Span<float> output) noexcept
 {
     diff<float, false>(input, output);
-}
\ No newline at end of file
+}
+
+template <>
+void sfz::int16ToFloat<float, true>(absl::Span<const int16_t> input, absl::Span<float> output) noexcept
+{
+    int16ToFloat<float, false>(input, output);
+}
+
+template <>
+void sfz::interpolate<float, true>(absl::Span<const float> source, absl::Span<const int> indices, absl::Span<const float> leftCoeffs, absl::Span<const float> rightCoeffs, absl::Span<float> output) noexcept
+{
+    interpolate<float, false>(source, indices, leftCoeffs, rightCoeffs, output);
+}
+
+template <>
+void sfz::interpolateStereo<float, true>(absl::Span<const float> leftSource, absl::Span<const float> rightSource, absl::Span<const int> indices, absl::Span<const float> leftCoeffs, absl::Span<const float> rightCoeffs, absl::Span<float> leftOutput, absl::Span<float> rightOutput) noexcept
+{
+    interpolateStereo<float, false>(leftSource, rightSource, indices, leftCoeffs, rightCoeffs, leftOutput, rightOutput);
+}
+
+template <>
+void sfz::tablePan<float, true>(absl::Span<const float> panEnvelope, absl::Span<float> leftBuffer, absl::Span<float> rightBuffer) noexcept
+{
+    tablePan<float, false>(panEnvelope, leftBuffer, rightBuffer);
+}
+
+template <>
+void sfz::onePoleLowpassLanes<float, true>(absl::Span<float> states, absl::Span<const float> gains, absl::Span<const float* const> inputs, absl::Span<float* const> outputs, int size) noexcept
+{
+    onePoleLowpassLanes<float, false>(states, gains, inputs, outputs, size);
+}
+
+template <>
+void sfz::onePoleHighpassLanes<float, true>(absl::Span<float> states, absl::Span<const float> gains, absl::Span<const float* const> inputs, absl::Span<float* const> outputs, int size) noexcept
+{
+    onePoleHighpassLanes<float, false>(states, gains, inputs, outputs, size);
+}
+
+template <>
+void sfz::mixStereo<float, true>(float leftToLeft, float rightToLeft, float leftToRight, float rightToRight, absl::Span<float> leftBuffer, absl::Span<float> rightBuffer) noexcept
+{
+    mixStereo<float, false>(leftToLeft, rightToLeft, leftToRight, rightToRight, leftBuffer, rightBuffer);
+}
+
+template <>
+void sfz::applyGainAndPan<float, true>(absl::Span<const float> amplitudeEnvelope, absl::Span<const float> egEnvelope, absl::Span<const float> volumeEnvelope,
+    absl::Span<const float> panEnvelope, absl::Span<float> leftBuffer, absl::Span<float> rightBuffer) noexcept
+{
+    applyGainAndPan<float, false>(amplitudeEnvelope, egEnvelope, volumeEnvelope, panEnvelope, leftBuffer, rightBuffer);
+}
+
+template <>
+void sfz::applyGainWidthAndPosition<float, true>(absl::Span<const float> amplitudeEnvelope, absl::Span<const float> egEnvelope, absl::Span<const float> volumeEnvelope,
+    absl::Span<const float> widthEnvelope, absl::Span<const float> positionEnvelope, absl::Span<float> leftBuffer, absl::Span<float> rightBuffer) noexcept
+{
+    applyGainWidthAndPosition<float, false>(amplitudeEnvelope, egEnvelope, volumeEnvelope, widthEnvelope, positionEnvelope, leftBuffer, rightBuffer);
+}
+
+template <>
+void sfz::interpolateHermite<float, true>(absl::Span<const float> source, absl::Span<const int> indices, absl::Span<const float> coeffs, absl::Span<float> output) noexcept
+{
+    interpolateHermite<float, false>(source, indices, coeffs, output);
+}
+
+template <>
+void sfz::interpolateSinc<float, true>(absl::Span<const float> source, absl::Span<const int> indices, absl::Span<const float> coeffs, absl::Span<float> output) noexcept
+{
+    interpolateSinc<float, false>(source, indices, coeffs, output);
+}
+
+template <>
+void sfz::phaseIndex<float, true>(float step, int& position, float& phase, int end, int loopStart, bool loop, absl::Span<int> indices, absl::Span<float> leftCoeffs, absl::Span<float> rightCoeffs) noexcept
+{
+    phaseIndex<float, false>(step, position, phase, end, loopStart, loop, indices, leftCoeffs, rightCoeffs);
+}
@@ -31,6 +31,31 @@
 
 namespace sfz
 {
+// Instruction sets the float kernels run on; on x86 the widest one the processor supports is selected at runtime
+enum class SIMDPath { scalar, sse, avx2, avx512 };
+// Widest path supported by the build and the processor
+SIMDPath getSupportedSIMDPath() noexcept;
+// Path the kernels currently dispatch to
+SIMDPath getSIMDPath() noexcept;
+// Lower the path, e.g. to compare the kernels; the requests above the supported path are clamped to it.
+// Not meant to be called while rendering.
+void setSIMDPath(SIMDPath path) noexcept;
+
+inline const char* simdPathName(SIMDPath path) noexcept
+{
+    switch (path) {
+    case SIMDPath::scalar:
+        return "scalar";
+    case SIMDPath::sse:
+        return "SSE";
+    case SIMDPath::avx2:
+        return "AVX2";
+    case SIMDPath::avx512:
+        return "AVX-512";
+    }
+    return "unknown";
+}
+
 template <class T>
 inline void snippetRead(const T*& input, T*& outputLeft, T*& outputRight)
 {
@@ -217,6 +242,61 @@ float loopingSFZIndex(absl::Span<const T> jumps, absl::Span<T> leftCoeffs, absl:
 template <>
 float loopingSFZIndex<float, true>(absl::Span<const float> jumps, absl::Span<float> leftCoeff, absl::Span<float> rightCoeff, absl::Span<int> indices, float floatIndex, float loopEnd, float loopStart) noexcept;
 
+// Index and coefficients of the frame at `phase + step * (offset + 1)` past `basePosition`. Past `end` the
+// index wraps back by as many loop lengths as needed if `loopLength` is positive; otherwise the rest of the
+// spans stay on `end` and this returns false.
+template <class T>
+inline bool snippetPhaseIndex(T step, T phase, size_t offset, int basePosition, int end, int loopLength, absl::Span<int> indices, absl::Span<T> leftCoeffs, absl::Span<T> rightCoeffs)
+{
+    const auto value = phase + step * static_cast<T>(offset + 1);
+    const auto whole = static_cast<int>(value);
+    indices[offset] = basePosition + whole;
+    rightCoeffs[offset] = value - static_cast<T>(whole);
+    leftCoeffs[offset] = static_cast<T>(1.0) - rightCoeffs[offset];
+    if (indices[offset] <= end)
+        return true;
+
+    if (loopLength > 0) {
+        const auto numWraps = (indices[offset] - end + loopLength - 1) / loopLength;
+        indices[offset] -= numWraps * loopLength;
+        return true;
+    }
+
+    std::fill(indices.begin() + offset, indices.end(), end);
+    std::fill(leftCoeffs.begin() + offset, leftCoeffs.end(), static_cast<T>(0.0));
+    std::fill(rightCoeffs.begin() + offset, rightCoeffs.end(), static_cast<T>(1.0));
+    return false;
+}
+
+// Phase accumulator for a source read at a constant step: fills the indices and interpolation coefficients of
+// the block in one pass. When looping, the frames from `loopStart` to `end` included repeat, however many times
+// they wrap within the block; otherwise the indices stay on `end` once they reach it. The position and phase
+// are updated for the next block; keeping the integer part apart keeps the precision on long samples.
+template <class T, bool SIMD = SIMDConfig::phaseIndex>
+void phaseIndex(T step, int& position, T& phase, int end, int loopStart, bool loop, absl::Span<int> indices, absl::Span<T> leftCoeffs, absl::Span<T> rightCoeffs) noexcept
+{
+    ASSERT(indices.size() == leftCoeffs.size());
+    ASSERT(indices.size() == rightCoeffs.size());
+    const auto size = min(indices.size(), leftCoeffs.size(), rightCoeffs.size());
+    if (size == 0)
+        return;
+
+    indices = indices.first(size);
+    leftCoeffs = leftCoeffs.first(size);
+    rightCoeffs = rightCoeffs.first(size);
+    const auto loopLength = loop ? end - loopStart + 1 : 0;
+    for (size_t offset = 0; offset < size; ++offset) {
+        if (!snippetPhaseIndex(step, phase, offset, position, end, loopLength, indices, leftCoeffs, rightCoeffs))
+            break;
+    }
+
+    position = indices.back();
+    phase = rightCoeffs.back();
+}
+
+template <>
+void phaseIndex<float, true>(float step, int& position, float& phase, int end, int loopStart, bool loop, absl::Span<int> indices, absl::Span<float> leftCoeffs, absl::Span<float> rightCoeffs) noexcept;
+
 template <class T>
 inline void snippetGain(T gain, const T*& input, T*& output)
 {
@@ -331,6 +411,48 @@ float linearRamp<float, true>(absl::Span<float> output, float start, float step)
 template <>
 float multiplicativeRamp<float, true>(absl::Span<float> output, float start, float step) noexcept;
 
+// One-pole filters of several voices at once, one per lane. The gains are the normalized G = g / (1 + g)
+// of the filters, and the states are updated in place.
+template <class T, bool SIMD = SIMDConfig::onePoleLanes>
+void onePoleLowpassLanes(absl::Span<T> states, absl::Span<const T> gains, absl::Span<const T* const> inputs, absl::Span<T* const> outputs, int size) noexcept
+{
+    ASSERT(gains.size() >= states.size());
+    ASSERT(inputs.size() >= states.size());
+    ASSERT(outputs.size() >= states.size());
+    for (size_t lane = 0; lane < states.size(); ++lane) {
+        auto state = states[lane];
+        for (int frame = 0; frame < size; ++frame) {
+            const auto intermediate = gains[lane] * (inputs[lane][frame] - state);
+            outputs[lane][frame] = intermediate + state;
+            state = outputs[lane][frame] + intermediate;
+        }
+        states[lane] = state;
+    }
+}
+
+template <class T, bool SIMD = SIMDConfig::onePoleLanes>
+void onePoleHighpassLanes(absl::Span<T> states, absl::Span<const T> gains, absl::Span<const T* const> inputs, absl::Span<T* const> outputs, int size) noexcept
+{
+    ASSERT(gains.size() >= states.size());
+    ASSERT(inputs.size() >= states.size());
+    ASSERT(outputs.size() >= states.size());
+    for (size_t lane = 0; lane < states.size(); ++lane) {
+        auto state = states[lane];
+        for (int frame = 0; frame < size; ++frame) {
+            const auto intermediate = gains[lane] * (inputs[lane][frame] - state);
+            outputs[lane][frame] = inputs[lane][frame] - intermediate - state;
+            state += 2 * intermediate;
+        }
+        states[lane] = state;
+    }
+}
+
+template <>
+void onePoleLowpassLanes<float, true>(absl::Span<float> states, absl::Span<const float> gains, absl::Span<const float* const> inputs, absl::Span<float* const> outputs, int size) noexcept;
+
+template <>
+void onePoleHighpassLanes<float, true>(absl::Span<float> states, absl::Span<const float> gains, absl::Span<const float* const> inputs, absl::Span<float* const> outputs, int size) noexcept;
+
 template <class T>
 inline void snippetAdd(const T*& input, T*& output)
 {
@@ -452,6 +574,176 @@ void pan(absl::Span<const T> panEnvelope, absl::Span<T> leftBuffer, absl::Span<T
 template <>
 void pan<float, true>(absl::Span<const float> panEnvelope, absl::Span<float> leftBuffer, absl::Span<float> rightBuffer) noexcept;
 
+// Equal-power pan law: cos(x * pi / 2) for x between 0 and 1, linearly interpolated between the
+// entries; sin(x * pi / 2) is cos((1 - x) * pi / 2) and is read from the same table
+struct PanTable {
+    static constexpr int size { config::panTableSize };
+    PanTable() noexcept
+    {
+        for (int i = 0; i < size; ++i)
+            values[i] = static_cast<float>(std::cos(i * piTwo<double> / (size - 1)));
+        // Read when interpolating at x = 1
+        values[size] = values[size - 1];
+    }
+    alignas(16) float values[size + 1];
+};
+
+// Built on first use; the voices build it when they are created
+inline const PanTable& getPanTable() noexcept
+{
+    static const PanTable table;
+    return table;
+}
+
+template <class T>
+inline T panGain(const PanTable& table, T x)
+{
+    const auto position = clamp<T>(x, 0, 1) * (PanTable::size - 1);
+    const auto index = static_cast<int>(position);
+    const auto frac = position - static_cast<T>(index);
+    return table.values[index] + frac * (table.values[index + 1] - table.values[index]);
+}
+
+// Gains of the left and right channels for a pan between -1 and 1
+template <class T>
+inline void panGains(const PanTable& table, T pan, T& left, T& right)
+{
+    left = panGain(table, static_cast<T>(0.5) + static_cast<T>(0.5) * pan);
+    right = panGain(table, static_cast<T>(0.5) - static_cast<T>(0.5) * pan);
+}
+
+template <class T>
+inline void snippetTablePan(const PanTable& table, const T*& pan, T*& left, T*& right)
+{
+    T leftGain;
+    T rightGain;
+    panGains(table, *pan++, leftGain, rightGain);
+    *left++ *= leftGain;
+    *right++ *= rightGain;
+}
+
+// Same as pan, with the pan law read from the pan table instead of computed for each frame
+template <class T, bool SIMD = SIMDConfig::tablePan>
+void tablePan(absl::Span<const T> panEnvelope, absl::Span<T> leftBuffer, absl::Span<T> rightBuffer) noexcept
+{
+    ASSERT(leftBuffer.size() >= panEnvelope.size());
+    ASSERT(rightBuffer.size() >= panEnvelope.size());
+    const auto& table = getPanTable();
+    auto* pan = panEnvelope.begin();
+    auto* left = leftBuffer.begin();
+    auto* right = rightBuffer.begin();
+    auto* sentinel = pan + min(panEnvelope.size(), leftBuffer.size(), rightBuffer.size());
+    while (pan < sentinel)
+        snippetTablePan(table, pan, left, right);
+}
+
+template <>
+void tablePan<float, true>(absl::Span<const float> panEnvelope, absl::Span<float> leftBuffer, absl::Span<float> rightBuffer) noexcept;
+
+template <class T>
+inline void snippetMixStereo(T leftToLeft, T rightToLeft, T leftToRight, T rightToRight, T*& left, T*& right)
+{
+    const auto leftValue = *left;
+    *left++ = leftToLeft * leftValue + rightToLeft * (*right);
+    *right = leftToRight * leftValue + rightToRight * (*right);
+    right++;
+}
+
+// Mixes both buffers in place with constant gains: left = leftToLeft * left + rightToLeft * right and
+// right = leftToRight * left + rightToRight * right
+template <class T, bool SIMD = SIMDConfig::mixStereo>
+void mixStereo(T leftToLeft, T rightToLeft, T leftToRight, T rightToRight, absl::Span<T> leftBuffer, absl::Span<T> rightBuffer) noexcept
+{
+    ASSERT(leftBuffer.size() == rightBuffer.size());
+    auto* left = leftBuffer.begin();
+    auto* right = rightBuffer.begin();
+    auto* sentinel = left + std::min(leftBuffer.size(), rightBuffer.size());
+    while (left < sentinel)
+        snippetMixStereo(leftToLeft, rightToLeft, leftToRight, rightToRight, left, right);
+}
+
+template <>
+void mixStereo<float, true>(float leftToLeft, float rightToLeft, float leftToRight, float rightToRight, absl::Span<float> leftBuffer, absl::Span<float> rightBuffer) noexcept;
+
+template <class T>
+inline void snippetGainAndPan(const PanTable& table, const T*& amplitude, const T*& eg, const T*& volume, const T*& pan, T*& left, T*& right)
+{
+    T leftGain;
+    T rightGain;
+    panGains(table, *pan++, leftGain, rightGain);
+    const auto sample = *left * (*amplitude++) * (*eg++) * (*volume++);
+    *left++ = sample * leftGain;
+    *right++ = sample * rightGain;
+}
+
+// Gain and pan stage of the mono voices in a single pass: scales the left buffer by the amplitude,
+// EG and volume envelopes and spreads it over both buffers with the pan envelope, normalized between -1 and 1;
+// the pan law is read from the pan table
+template <class T, bool SIMD = SIMDConfig::gainAndPan>
+void applyGainAndPan(absl::Span<const T> amplitudeEnvelope, absl::Span<const T> egEnvelope, absl::Span<const T> volumeEnvelope,
+    absl::Span<const T> panEnvelope, absl::Span<T> leftBuffer, absl::Span<T> rightBuffer) noexcept
+{
+    ASSERT(leftBuffer.size() >= panEnvelope.size());
+    ASSERT(rightBuffer.size() >= panEnvelope.size());
+    auto* amplitude = amplitudeEnvelope.begin();
+    auto* eg = egEnvelope.begin();
+    auto* volume = volumeEnvelope.begin();
+    auto* pan = panEnvelope.begin();
+    auto* left = leftBuffer.begin();
+    auto* right = rightBuffer.begin();
+    auto* sentinel = left + min(min(amplitudeEnvelope.size(), egEnvelope.size(), volumeEnvelope.size()), panEnvelope.size(), std::min(leftBuffer.size(), rightBuffer.size()));
+    const auto& table = getPanTable();
+    while (left < sentinel)
+        snippetGainAndPan(table, amplitude, eg, volume, pan, left, right);
+}
+
+template <>
+void applyGainAndPan<float, true>(absl::Span<const float> amplitudeEnvelope, absl::Span<const float> egEnvelope, absl::Span<const float> volumeEnvelope,
+    absl::Span<const float> panEnvelope, absl::Span<float> leftBuffer, absl::Span<float> rightBuffer) noexcept;
+
+template <class T>
+inline void snippetGainWidthAndPosition(const PanTable& table, const T*& amplitude, const T*& eg, const T*& volume, const T*& width, const T*& position, T*& left, T*& right)
+{
+    T sideGain;
+    T midGain;
+    T leftSideGain;
+    T rightSideGain;
+    panGains(table, *width++, sideGain, midGain);
+    panGains(table, *position++, leftSideGain, rightSideGain);
+    const auto gain = (*amplitude++) * (*eg++) * (*volume++) * sqrtTwoInv<T>;
+    const auto mid = (*left + *right) * gain * midGain;
+    const auto side = (*left - *right) * gain * sideGain;
+    *left++ = (mid + side * leftSideGain) * sqrtTwoInv<T>;
+    *right++ = (mid + side * rightSideGain) * sqrtTwoInv<T>;
+}
+
+// Gain and stereo image stage of the stereo voices in a single pass: scales both buffers by the amplitude,
+// EG and volume envelopes, applies the width envelope to their mid/side decomposition and spreads the
+// side channel with the position envelope; both envelopes are normalized between -1 and 1 and use the pan law
+// of the pan table
+template <class T, bool SIMD = SIMDConfig::gainAndPan>
+void applyGainWidthAndPosition(absl::Span<const T> amplitudeEnvelope, absl::Span<const T> egEnvelope, absl::Span<const T> volumeEnvelope,
+    absl::Span<const T> widthEnvelope, absl::Span<const T> positionEnvelope, absl::Span<T> leftBuffer, absl::Span<T> rightBuffer) noexcept
+{
+    ASSERT(leftBuffer.size() >= widthEnvelope.size());
+    ASSERT(rightBuffer.size() >= widthEnvelope.size());
+    auto* amplitude = amplitudeEnvelope.begin();
+    auto* eg = egEnvelope.begin();
+    auto* volume = volumeEnvelope.begin();
+    auto* width = widthEnvelope.begin();
+    auto* position = positionEnvelope.begin();
+    auto* left = leftBuffer.begin();
+    auto* right = rightBuffer.begin();
+    auto* sentinel = left + min(min(amplitudeEnvelope.size(), egEnvelope.size(), volumeEnvelope.size()), std::min(widthEnvelope.size(), positionEnvelope.size()), std::min(leftBuffer.size(), rightBuffer.size()));
+    const auto& table = getPanTable();
+    while (left < sentinel)
+        snippetGainWidthAndPosition(table, amplitude, eg, volume, width, position, left, right);
+}
+
+template <>
+void applyGainWidthAndPosition<float, true>(absl::Span<const float> amplitudeEnvelope, absl::Span<const float> egEnvelope, absl::Span<const float> volumeEnvelope,
+    absl::Span<const float> widthEnvelope, absl::Span<const float> positionEnvelope, absl::Span<float> leftBuffer, absl::Span<float> rightBuffer) noexcept;
+
 template <class T, bool SIMD = SIMDConfig::mean>
 T mean(absl::Span<const T> vector) noexcept
 {
@@ -546,6 +838,198 @@ void sfzInterpolationCast(absl::Span<const T> floatJumps, absl::Span<int> jumps,
 template<>
 void sfzInterpolationCast<float, true>(absl::Span<const float> floatJumps, absl::Span<int> jumps, absl::Span<float> leftCoeffs, absl::Span<float> rightCoeffs) noexcept;
 
+template <class T>
+inline void snippetInterpolate(const T* source, const int*& index, const float*& leftCoeff, const float*& rightCoeff, float*& output)
+{
+    *output++ = source[*index] * (*leftCoeff++) + source[*index + 1] * (*rightCoeff++);
+    index++;
+}
+
+// Linear interpolation between each indexed frame of the source and the next one; the
+// source must hold one frame past the largest index
+template <class T, bool SIMD = SIMDConfig::interpolate>
+void interpolate(absl::Span<const T> source, absl::Span<const int> indices, absl::Span<const float> leftCoeffs, absl::Span<const float> rightCoeffs, absl::Span<float> output) noexcept
+{
+    ASSERT(output.size() >= indices.size());
+    ASSERT(leftCoeffs.size() >= indices.size());
+    ASSERT(rightCoeffs.size() >= indices.size());
+
+    auto index = indices.data();
+    auto leftCoeff = leftCoeffs.data();
+    auto rightCoeff = rightCoeffs.data();
+    auto out = output.data();
+    const auto sentinel = out + min(indices.size(), leftCoeffs.size(), rightCoeffs.size(), output.size());
+    while (out < sentinel)
+        snippetInterpolate(source.data(), index, leftCoeff, rightCoeff, out);
+}
+
+template <>
+void interpolate<float, true>(absl::Span<const float> source, absl::Span<const int> indices, absl::Span<const float> leftCoeffs, absl::Span<const float> rightCoeffs, absl::Span<float> output) noexcept;
+
+template <class T>
+inline void snippetInterpolateStereo(const T* leftSource, const T* rightSource, const int*& index, const float*& leftCoeff, const float*& rightCoeff, float*& leftOutput, float*& rightOutput)
+{
+    *leftOutput++ = leftSource[*index] * (*leftCoeff) + leftSource[*index + 1] * (*rightCoeff);
+    *rightOutput++ = rightSource[*index] * (*leftCoeff++) + rightSource[*index + 1] * (*rightCoeff++);
+    index++;
+}
+
+// Both channels of a stereo source at once, sharing the indices and coefficients
+template <class T, bool SIMD = SIMDConfig::interpolate>
+void interpolateStereo(absl::Span<const T> leftSource, absl::Span<const T> rightSource, absl::Span<const int> indices, absl::Span<const float> leftCoeffs, absl::Span<const float> rightCoeffs, absl::Span<float> leftOutput, absl::Span<float> rightOutput) noexcept
+{
+    ASSERT(leftOutput.size() >= indices.size());
+    ASSERT(rightOutput.size() >= indices.size());
+    ASSERT(leftCoeffs.size() >= indices.size());
+    ASSERT(rightCoeffs.size() >= indices.size());
+
+    auto index = indices.data();
+    auto leftCoeff = leftCoeffs.data();
+    auto rightCoeff = rightCoeffs.data();
+    auto left = leftOutput.data();
+    auto right = rightOutput.data();
+    const auto sentinel = left + min(indices.size(), leftCoeffs.size(), rightCoeffs.size(), std::min(leftOutput.size(), rightOutput.size()));
+    while (left < sentinel)
+        snippetInterpolateStereo(leftSource.data(), rightSource.data(), index, leftCoeff, rightCoeff, left, right);
+}
+
+template <>
+void interpolateStereo<float, true>(absl::Span<const float> leftSource, absl::Span<const float> rightSource, absl::Span<const int> indices, absl::Span<const float> leftCoeffs, absl::Span<const float> rightCoeffs, absl::Span<float> leftOutput, absl::Span<float> rightOutput) noexcept;
+
+// Frame of the source, or silence outside of it
+template <class T>
+inline float sourceFrame(const T* source, int size, int index)
+{
+    return (index >= 0 && index < size) ? static_cast<float>(source[index]) : 0.0f;
+}
+
+template <class T>
+inline void snippetInterpolateHermite(const T* source, int size, const int*& index, const float*& coeff, float*& output)
+{
+    const auto i = *index++;
+    const auto t = *coeff++;
+    float x0, x1, x2, x3;
+    if (i >= 1 && i + 2 < size) {
+        x0 = static_cast<float>(source[i - 1]);
+        x1 = static_cast<float>(source[i]);
+        x2 = static_cast<float>(source[i + 1]);
+        x3 = static_cast<float>(source[i + 2]);
+    } else {
+        x0 = sourceFrame(source, size, i - 1);
+        x1 = sourceFrame(source, size, i);
+        x2 = sourceFrame(source, size, i + 1);
+        x3 = sourceFrame(source, size, i + 2);
+    }
+    // Catmull-Rom spline through the 4 frames around the read position
+    const auto c1 = 0.5f * (x2 - x0);
+    const auto c2 = x0 - 2.5f * x1 + 2.0f * x2 - 0.5f * x3;
+    const auto c3 = 0.5f * (x3 - x0) + 1.5f * (x1 - x2);
+    *output++ = ((c3 * t + c2) * t + c1) * t + x1;
+}
+
+// Cubic Hermite interpolation around each indexed frame, where the coefficients are the fractional
+// parts of the read positions (the right coefficients of the linear interpolation); the frames
+// outside of the source are read as silence
+template <class T, bool SIMD = SIMDConfig::interpolateHermite>
+void interpolateHermite(absl::Span<const T> source, absl::Span<const int> indices, absl::Span<const float> coeffs, absl::Span<float> output) noexcept
+{
+    ASSERT(output.size() >= indices.size());
+    ASSERT(coeffs.size() >= indices.size());
+
+    auto index = indices.data();
+    auto coeff = coeffs.data();
+    auto out = output.data();
+    const auto size = static_cast<int>(source.size());
+    const auto sentinel = out + min(indices.size(), coeffs.size(), output.size());
+    while (out < sentinel)
+        snippetInterpolateHermite(source.data(), size, index, coeff, out);
+}
+
+template <>
+void interpolateHermite<float, true>(absl::Span<const float> source, absl::Span<const int> indices, absl::Span<const float> coeffs, absl::Span<float> output) noexcept;
+
+// Polyphase windowed-sinc filter; the taps of each phase are followed by their difference with the
+// next phase, so that the filter is linearly interpolated between phases
+struct SincTable {
+    static constexpr int numTaps { config::sincTaps };
+    static constexpr int numPhases { config::sincPhases };
+    // Frames read before the indexed frame
+    static constexpr int numTapsBefore { numTaps / 2 - 1 };
+    SincTable() noexcept
+    {
+        constexpr double halfWidth { numTaps / 2 };
+        for (int phase = 0; phase <= numPhases; ++phase) {
+            const double t = static_cast<double>(phase) / numPhases;
+            double sum { 0.0 };
+            for (int tap = 0; tap < numTaps; ++tap) {
+                const double x = tap - numTapsBefore - t;
+                const double sinc = x == 0.0 ? 1.0 : std::sin(pi<double> * config::sincCutoff * x) / (pi<double> * config::sincCutoff * x);
+                // Blackman window spanning all the taps
+                const double window = 0.42 + 0.5 * std::cos(pi<double> * x / halfWidth) + 0.08 * std::cos(twoPi<double> * x / halfWidth);
+                taps[phase][tap] = static_cast<float>(sinc * window);
+                sum += sinc * window;
+            }
+            // Unity gain at DC for every phase
+            for (auto& tap : taps[phase])
+                tap = static_cast<float>(tap / sum);
+        }
+        for (int phase = 0; phase <= numPhases; ++phase) {
+            for (int tap = 0; tap < numTaps; ++tap)
+                deltas[phase][tap] = phase < numPhases ? taps[phase + 1][tap] - taps[phase][tap] : 0.0f;
+        }
+    }
+    alignas(16) float taps[numPhases + 1][numTaps];
+    alignas(16) float deltas[numPhases + 1][numTaps];
+};
+
+// Built on first use; the voices build it when they are created
+inline const SincTable& getSincTable() noexcept
+{
+    static const SincTable table;
+    return table;
+}
+
+template <class T>
+inline void snippetInterpolateSinc(const T* source, int size, const SincTable& table, const int*& index, const float*& coeff, float*& output)
+{
+    const auto first = *index++ - SincTable::numTapsBefore;
+    const auto position = *coeff++ * SincTable::numPhases;
+    const auto phase = static_cast<int>(position);
+    const auto phaseCoeff = position - static_cast<float>(phase);
+    const auto* taps = table.taps[phase];
+    const auto* deltas = table.deltas[phase];
+    float sum { 0.0f };
+    if (first >= 0 && first + SincTable::numTaps <= size) {
+        for (int tap = 0; tap < SincTable::numTaps; ++tap)
+            sum += static_cast<float>(source[first + tap]) * (taps[tap] + phaseCoeff * deltas[tap]);
+    } else {
+        for (int tap = 0; tap < SincTable::numTaps; ++tap)
+            sum += sourceFrame(source, size, first + tap) * (taps[tap] + phaseCoeff * deltas[tap]);
+    }
+    *output++ = sum;
+}
+
+// Windowed-sinc interpolation around each indexed frame, with the same coefficients as the Hermite
+// interpolation; the frames outside of the source are read as silence
+template <class T, bool SIMD = SIMDConfig::interpolateSinc>
+void interpolateSinc(absl::Span<const T> source, absl::Span<const int> indices, absl::Span<const float> coeffs, absl::Span<float> output) noexcept
+{
+    ASSERT(output.size() >= indices.size());
+    ASSERT(coeffs.size() >= indices.size());
+
+    const auto& table = getSincTable();
+    auto index = indices.data();
+    auto coeff = coeffs.data();
+    auto out = output.data();
+    const auto size = static_cast<int>(source.size());
+    const auto sentinel = out + min(indices.size(), coeffs.size(), output.size());
+    while (out < sentinel)
+        snippetInterpolateSinc(source.data(), size, table, index, coeff, out);
+}
+
+template <>
+void interpolateSinc<float, true>(absl::Span<const float> source, absl::Span<const int> indices, absl::Span<const float> coeffs, absl::Span<float> output) noexcept;
+
 template <class T>
 inline void snippetDiff(const T*& input, T*& output)
 {
@@ -573,4 +1057,25 @@ void diff(absl::Span<const T> input, absl::Span<T> output) noexcept
 template <>
 void cumsum<float, true>(absl::Span<const float> input, absl::Span<float> output) noexcept;
 
+template <class T>
+inline void snippetInt16ToFloat(const int16_t*& input, T*& output)
+{
+    *output++ = static_cast<T>(*input++);
+}
+
+// The values are not rescaled to [-1, 1]; callers fold the 1/32768 factor in their own gains
+template <class T, bool SIMD = SIMDConfig::int16ToFloat>
+void int16ToFloat(absl::Span<const int16_t> input, absl::Span<T> output) noexcept
+{
+    ASSERT(output.size() >= input.size());
+    auto* in = input.begin();
+    auto* out = output.begin();
+    auto* sentinel = out + min(input.size(), output.size());
+    while (out < sentinel)
+        snippetInt16ToFloat(in, out);
+}
+
+template <>
+void int16ToFloat<float, true>(absl::Span<const int16_t> input, absl::Span<float> output) noexcept;
+
 } // namespace sfz
\ No newline at end of file
@@ -22,7 +22,11 @@
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "SIMDHelpers.h"
+#include "SIMDAVX2.h"
+#include "SIMDAVX512.h"
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <xmmintrin.h>
 #if HAVE_X86INTRIN_H
 #include <x86intrin.h>
@@ -40,6 +44,66 @@ using Type = float;
 [[maybe_unused]] constexpr uintptr_t ByteAlignment { TypeAlignment * sizeof(Type) };
 [[maybe_unused]] constexpr uintptr_t ByteAlignmentMask { ByteAlignment - 1 };
 
+sfz::SIMDPath detectSIMDPath()
+{
+    using sfz::SIMDPath;
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return SIMDPath::sse;
+    // The OS must save the AVX registers on context switches, and the AVX-512 ones for AVX-512
+    __cpuid(info, 1);
+    if (!(info[2] & (1 << 27)) || !(info[2] & (1 << 28)))
+        return SIMDPath::sse;
+    const auto savedRegisters = _xgetbv(0);
+    if ((savedRegisters & 0x6) != 0x6)
+        return SIMDPath::sse;
+    __cpuidex(info, 7, 0);
+    if ((info[1] & (1 << 16)) && (savedRegisters & 0xe6) == 0xe6)
+        return SIMDPath::avx512;
+    if (info[1] & (1 << 5))
+        return SIMDPath::avx2;
+    return SIMDPath::sse;
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return SIMDPath::avx512;
+    if (__builtin_cpu_supports("avx2"))
+        return SIMDPath::avx2;
+    return SIMDPath::sse;
+#endif
+}
+
+const sfz::SIMDPath supportedPath { detectSIMDPath() };
+std::atomic<sfz::SIMDPath> selectedPath { supportedPath };
+
+bool useAVX2()
+{
+    return selectedPath.load(std::memory_order_relaxed) >= sfz::SIMDPath::avx2;
+}
+
+bool useAVX512()
+{
+    return selectedPath.load(std::memory_order_relaxed) >= sfz::SIMDPath::avx512;
+}
+
+sfz::SIMDPath sfz::getSupportedSIMDPath() noexcept
+{
+    return supportedPath;
+}
+
+sfz::SIMDPath sfz::getSIMDPath() noexcept
+{
+    return selectedPath;
+}
+
+void sfz::setSIMDPath(SIMDPath path) noexcept
+{
+    // The SSE kernels are the floor of the x86 builds
+    selectedPath = std::max(SIMDPath::sse, std::min(path, supportedPath));
+}
+
 struct AlignmentSentinels {
     float* nextAligned;
     float* lastAligned;
@@ -75,9 +139,46 @@ bool unaligned(const float* ptr1, const float* ptr2, const float* ptr3, const fl
     return unaligned(ptr1) || unaligned(ptr2) || unaligned(ptr3) || unaligned(ptr4);
 }
 
+// Left and right gains of 4 pans between -1 and 1, read from the pan table
+void tablePanGains(const sfz::PanTable& table, __m128 mmPan, __m128& mmLeftGain, __m128& mmRightGain)
+{
+    const auto mmHalf = _mm_set_ps1(0.5f);
+    const auto mmScale = _mm_set_ps1(static_cast<float>(sfz::PanTable::size - 1));
+    const auto mmPanHalf = _mm_mul_ps(mmHalf, _mm_max_ps(_mm_min_ps(mmPan, _mm_set_ps1(1.0f)), _mm_set_ps1(-1.0f)));
+    const auto mmLeftPosition = _mm_mul_ps(_mm_add_ps(mmHalf, mmPanHalf), mmScale);
+    const auto mmRightPosition = _mm_mul_ps(_mm_sub_ps(mmHalf, mmPanHalf), mmScale);
+    const auto mmLeftIndex = _mm_cvttps_epi32(mmLeftPosition);
+    const auto mmRightIndex = _mm_cvttps_epi32(mmRightPosition);
+    alignas(16) int leftIndices[TypeAlignment];
+    alignas(16) int rightIndices[TypeAlignment];
+    _mm_store_si128(reinterpret_cast<__m128i*>(leftIndices), mmLeftIndex);
+    _mm_store_si128(reinterpret_cast<__m128i*>(rightIndices), mmRightIndex);
+
+    // SSE has no gather so the entries are loaded one by one
+    const auto* values = table.values;
+    const auto mmLeftFirst = _mm_setr_ps(values[leftIndices[0]], values[leftIndices[1]], values[leftIndices[2]], values[leftIndices[3]]);
+    const auto mmLeftNext = _mm_setr_ps(values[leftIndices[0] + 1], values[leftIndices[1] + 1], values[leftIndices[2] + 1], values[leftIndices[3] + 1]);
+    const auto mmRightFirst = _mm_setr_ps(values[rightIndices[0]], values[rightIndices[1]], values[rightIndices[2]], values[rightIndices[3]]);
+    const auto mmRightNext = _mm_setr_ps(values[rightIndices[0] + 1], values[rightIndices[1] + 1], values[rightIndices[2] + 1], values[rightIndices[3] + 1]);
+    const auto mmLeftFrac = _mm_sub_ps(mmLeftPosition, _mm_cvtepi32_ps(mmLeftIndex));
+    const auto mmRightFrac = _mm_sub_ps(mmRightPosition, _mm_cvtepi32_ps(mmRightIndex));
+    mmLeftGain = _mm_add_ps(mmLeftFirst, _mm_mul_ps(mmLeftFrac, _mm_sub_ps(mmLeftNext, mmLeftFirst)));
+    mmRightGain = _mm_add_ps(mmRightFirst, _mm_mul_ps(mmRightFrac, _mm_sub_ps(mmRightNext, mmRightFirst)));
+}
+
 template <>
 void sfz::readInterleaved<float, true>(absl::Span<const float> input, absl::Span<float> outputLeft, absl::Span<float> outputRight) noexcept
 {
+    if (useAVX512()) {
+        avx512::readInterleaved(input, outputLeft, outputRight);
+        return;
+    }
+
+    if (useAVX2()) {
+        avx2::readInterleaved(input, outputLeft, outputRight);
+        return;
+    }
+
     // The size of the outputs is not big enough for the input...
     ASSERT(outputLeft.size() >= input.size() / 2);
     ASSERT(outputRight.size() >= input.size() / 2);
@@ -118,6 +219,16 @@ void sfz::readInterleaved<float, true>(absl::Span<const float> input, absl::Span
 template <>
 void sfz::writeInterleaved<float, true>(absl::Span<const float> inputLeft, absl::Span<const float> inputRight, absl::Span<float> output) noexcept
 {
+    if (useAVX512()) {
+        avx512::writeInterleaved(inputLeft, inputRight, output);
+        return;
+    }
+
+    if (useAVX2()) {
+        avx2::writeInterleaved(inputLeft, inputRight, output);
+        return;
+    }
+
     // The size of the output is not big enough for the inputs...
     ASSERT(inputLeft.size() <= output.size() / 2);
     ASSERT(inputRight.size() <= output.size() / 2);
@@ -263,6 +374,16 @@ void sfz::sin<float, true>(absl::Span<const float> input, absl::Span<float> outp
 template <>
 void sfz::applyGain<float, true>(float gain, absl::Span<const float> input, absl::Span<float> output) noexcept
 {
+    if (useAVX512()) {
+        avx512::applyGain(gain, input, output);
+        return;
+    }
+
+    if (useAVX2()) {
+        avx2::applyGain(gain, input, output);
+        return;
+    }
+
     auto* in = input.begin();
     auto* out = output.begin();
     const auto size = std::min(output.size(), input.size());
@@ -285,6 +406,16 @@ void sfz::applyGain<float, true>(float gain, absl::Span<const float> input, absl
 template <>
 void sfz::applyGain<float, true>(absl::Span<const float> gain, absl::Span<const float> input, absl::Span<float> output) noexcept
 {
+    if (useAVX512()) {
+        avx512::applyGain(gain, input, output);
+        return;
+    }
+
+    if (useAVX2()) {
+        avx2::applyGain(gain, input, output);
+        return;
+    }
+
     auto* in = input.begin();
     auto* out = output.begin();
     auto* g = gain.begin();
@@ -308,6 +439,16 @@ void sfz::applyGain<float, true>(absl::Span<const float> gain, absl::Span<const
 template <>
 void sfz::multiplyAdd<float, true>(absl::Span<const float> gain, absl::Span<const float> input, absl::Span<float> output) noexcept
 {
+    if (useAVX512()) {
+        avx512::multiplyAdd(gain, input, output);
+        return;
+    }
+
+    if (useAVX2()) {
+        avx2::multiplyAdd(gain, input, output);
+        return;
+    }
+
     auto* in = input.begin();
     auto* out = output.begin();
     auto* g = gain.begin();
@@ -450,9 +591,84 @@ float sfz::saturatingSFZIndex<float, true>(absl::Span<const float> jumps,
     return floatIndex;
 }
 
+template <>
+void sfz::phaseIndex<float, true>(float step, int& position, float& phase, int end, int loopStart, bool loop, absl::Span<int> indices, absl::Span<float> leftCoeffs, absl::Span<float> rightCoeffs) noexcept
+{
+    ASSERT(indices.size() == leftCoeffs.size());
+    ASSERT(indices.size() == rightCoeffs.size());
+    const auto size = min(indices.size(), leftCoeffs.size(), rightCoeffs.size());
+    if (size == 0)
+        return;
+
+    indices = indices.first(size);
+    leftCoeffs = leftCoeffs.first(size);
+    rightCoeffs = rightCoeffs.first(size);
+    const auto loopLength = loop ? end - loopStart + 1 : 0;
+    constexpr int maxExactFloatInteger { 1 << 24 };
+    const auto basePosition = position;
+    size_t offset { 0 };
+    bool saturated { false };
+    const auto* lastAligned = prevAligned(leftCoeffs.end());
+    while (unaligned(reinterpret_cast<float*>(indices.data() + offset), leftCoeffs.data() + offset, rightCoeffs.data() + offset)
+        && leftCoeffs.data() + offset < lastAligned && !saturated)
+        saturated = !snippetPhaseIndex(step, phase, offset++, basePosition, end, loopLength, indices, leftCoeffs, rightCoeffs);
+
+    const auto mmStep = _mm_set1_ps(step);
+    const auto mmPhase = _mm_set1_ps(phase);
+    const auto mmBasePosition = _mm_set1_epi32(basePosition);
+    const auto mmEnd = _mm_set1_epi32(end);
+    const auto mmLoopStart = _mm_set1_epi32(loopStart);
+    const auto mmLoopLength = _mm_set1_epi32(loopLength);
+    const auto mmFloatLoopLength = _mm_set1_ps(static_cast<float>(loopLength));
+    const auto mmLoopLengthMinusOne = _mm_set1_ps(static_cast<float>(loopLength - 1));
+    auto mmCounter = _mm_setr_ps(offset + 1.0f, offset + 2.0f, offset + 3.0f, offset + 4.0f);
+    while (leftCoeffs.data() + offset < lastAligned && !saturated) {
+        const auto mmValue = _mm_add_ps(mmPhase, _mm_mul_ps(mmStep, mmCounter));
+        const auto mmWhole = _mm_cvttps_epi32(mmValue);
+        auto mmIndices = _mm_add_epi32(mmWhole, mmBasePosition);
+        const auto mmOver = _mm_cmpgt_epi32(mmIndices, mmEnd);
+        if (_mm_movemask_epi8(mmOver) != 0) {
+            if (loopLength <= 0 || loopLength >= maxExactFloatInteger) {
+                // Saturating, which only happens once, or looping over a length that floats cannot hold exactly
+                for (auto last = offset + TypeAlignment; offset < last && !saturated; ++offset)
+                    saturated = !snippetPhaseIndex(step, phase, offset, basePosition, end, loopLength, indices, leftCoeffs, rightCoeffs);
+                mmCounter = _mm_add_ps(mmCounter, _mm_set1_ps(static_cast<float>(TypeAlignment)));
+                continue;
+            }
+
+            // Wrap back by ceil((index - end) / loopLength) loop lengths; the distances past the end are small
+            // enough to be exact as floats, and the rounding of the division is corrected afterwards
+            const auto mmDistance = _mm_cvtepi32_ps(_mm_and_si128(mmOver, _mm_sub_epi32(mmIndices, mmEnd)));
+            const auto mmNumWraps = _mm_cvttps_epi32(_mm_div_ps(_mm_add_ps(mmDistance, mmLoopLengthMinusOne), mmFloatLoopLength));
+            mmIndices = _mm_sub_epi32(mmIndices, _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(mmNumWraps), mmFloatLoopLength)));
+            mmIndices = _mm_sub_epi32(mmIndices, _mm_and_si128(_mm_cmpgt_epi32(mmIndices, mmEnd), mmLoopLength));
+            mmIndices = _mm_add_epi32(mmIndices, _mm_and_si128(mmOver, _mm_and_si128(_mm_cmplt_epi32(mmIndices, mmLoopStart), mmLoopLength)));
+        }
+
+        const auto mmRight = _mm_sub_ps(mmValue, _mm_cvtepi32_ps(mmWhole));
+        _mm_store_si128(reinterpret_cast<__m128i*>(indices.data() + offset), mmIndices);
+        _mm_store_ps(rightCoeffs.data() + offset, mmRight);
+        _mm_store_ps(leftCoeffs.data() + offset, _mm_sub_ps(_mm_set1_ps(1.0f), mmRight));
+        offset += TypeAlignment;
+        mmCounter = _mm_add_ps(mmCounter, _mm_set1_ps(static_cast<float>(TypeAlignment)));
+    }
+
+    while (offset < size && !saturated)
+        saturated = !snippetPhaseIndex(step, phase, offset++, basePosition, end, loopLength, indices, leftCoeffs, rightCoeffs);
+
+    position = indices.back();
+    phase = rightCoeffs.back();
+}
+
 template <>
 float sfz::linearRamp<float, true>(absl::Span<float> output, float value, float step) noexcept
 {
+    if (useAVX512())
+        return avx512::linearRamp(output, value, step);
+
+    if (useAVX2())
+        return avx2::linearRamp(output, value, step);
+
     auto* out = output.begin();
     const auto* lastAligned = prevAligned(output.end());
 
@@ -478,6 +694,12 @@ float sfz::linearRamp<float, true>(absl::Span<float> output, float value, float
 template <>
 float sfz::multiplicativeRamp<float, true>(absl::Span<float> output, float value, float step) noexcept
 {
+    if (useAVX512())
+        return avx512::multiplicativeRamp(output, value, step);
+
+    if (useAVX2())
+        return avx2::multiplicativeRamp(output, value, step);
+
     auto* out = output.begin();
     const auto* lastAligned = prevAligned(output.end());
 
@@ -500,6 +722,95 @@ float sfz::multiplicativeRamp<float, true>(absl::Span<float> output, float value
     return value;
 }
 
+// One step of 4 one-pole filters, one per lane
+template <bool Highpass>
+inline __m128 onePoleStep(__m128 mmInput, __m128& mmState, __m128 mmGain)
+{
+    const auto mmIntermediate = _mm_mul_ps(mmGain, _mm_sub_ps(mmInput, mmState));
+    if (Highpass) {
+        const auto mmOutput = _mm_sub_ps(_mm_sub_ps(mmInput, mmIntermediate), mmState);
+        mmState = _mm_add_ps(mmState, _mm_add_ps(mmIntermediate, mmIntermediate));
+        return mmOutput;
+    }
+
+    const auto mmOutput = _mm_add_ps(mmIntermediate, mmState);
+    mmState = _mm_add_ps(mmOutput, mmIntermediate);
+    return mmOutput;
+}
+
+// The filters only depend on their own past, so 4 voices go through the lanes together: the blocks are
+// read and written 4 frames at a time and transposed so that each register holds one frame of every voice
+template <bool Highpass>
+void onePoleLanes(absl::Span<float> states, absl::Span<const float> gains, absl::Span<const float* const> inputs, absl::Span<float* const> outputs, int size) noexcept
+{
+    ASSERT(gains.size() >= states.size());
+    ASSERT(inputs.size() >= states.size());
+    ASSERT(outputs.size() >= states.size());
+
+    size_t lane = 0;
+    for (; lane + TypeAlignment <= states.size(); lane += TypeAlignment) {
+        auto mmState = _mm_loadu_ps(&states[lane]);
+        const auto mmGain = _mm_loadu_ps(&gains[lane]);
+        const auto* in0 = inputs[lane];
+        const auto* in1 = inputs[lane + 1];
+        const auto* in2 = inputs[lane + 2];
+        const auto* in3 = inputs[lane + 3];
+        auto* out0 = outputs[lane];
+        auto* out1 = outputs[lane + 1];
+        auto* out2 = outputs[lane + 2];
+        auto* out3 = outputs[lane + 3];
+
+        int frame = 0;
+        for (; frame + static_cast<int>(TypeAlignment) <= size; frame += TypeAlignment) {
+            auto mmFrame0 = _mm_loadu_ps(in0 + frame);
+            auto mmFrame1 = _mm_loadu_ps(in1 + frame);
+            auto mmFrame2 = _mm_loadu_ps(in2 + frame);
+            auto mmFrame3 = _mm_loadu_ps(in3 + frame);
+            _MM_TRANSPOSE4_PS(mmFrame0, mmFrame1, mmFrame2, mmFrame3);
+            mmFrame0 = onePoleStep<Highpass>(mmFrame0, mmState, mmGain);
+            mmFrame1 = onePoleStep<Highpass>(mmFrame1, mmState, mmGain);
+            mmFrame2 = onePoleStep<Highpass>(mmFrame2, mmState, mmGain);
+            mmFrame3 = onePoleStep<Highpass>(mmFrame3, mmState, mmGain);
+            _MM_TRANSPOSE4_PS(mmFrame0, mmFrame1, mmFrame2, mmFrame3);
+            _mm_storeu_ps(out0 + frame, mmFrame0);
+            _mm_storeu_ps(out1 + frame, mmFrame1);
+            _mm_storeu_ps(out2 + frame, mmFrame2);
+            _mm_storeu_ps(out3 + frame, mmFrame3);
+        }
+
+        alignas(16) float lastFrame[TypeAlignment];
+        for (; frame < size; ++frame) {
+            const auto mmInput = _mm_set_ps(in3[frame], in2[frame], in1[frame], in0[frame]);
+            _mm_store_ps(lastFrame, onePoleStep<Highpass>(mmInput, mmState, mmGain));
+            out0[frame] = lastFrame[0];
+            out1[frame] = lastFrame[1];
+            out2[frame] = lastFrame[2];
+            out3[frame] = lastFrame[3];
+        }
+        _mm_storeu_ps(&states[lane], mmState);
+    }
+
+    if (lane == states.size())
+        return;
+
+    if (Highpass)
+        sfz::onePoleHighpassLanes<float, false>(states.subspan(lane), gains.subspan(lane), inputs.subspan(lane), outputs.subspan(lane), size);
+    else
+        sfz::onePoleLowpassLanes<float, false>(states.subspan(lane), gains.subspan(lane), inputs.subspan(lane), outputs.subspan(lane), size);
+}
+
+template <>
+void sfz::onePoleLowpassLanes<float, true>(absl::Span<float> states, absl::Span<const float> gains, absl::Span<const float* const> inputs, absl::Span<float* const> outputs, int size) noexcept
+{
+    onePoleLanes<false>(states, gains, inputs, outputs, size);
+}
+
+template <>
+void sfz::onePoleHighpassLanes<float, true>(absl::Span<float> states, absl::Span<const float> gains, absl::Span<const float* const> inputs, absl::Span<float* const> outputs, int size) noexcept
+{
+    onePoleLanes<true>(states, gains, inputs, outputs, size);
+}
+
 template <>
 void sfz::add<float, true>(absl::Span<const float> input, absl::Span<float> output) noexcept
 {
@@ -627,10 +938,10 @@ void sfz::pan<float, true>(absl::Span<const float> panEnvelope, absl::Span<float
     while (pan < lastAligned) {
         auto mmPan = _mm_load_ps(pan);
         mmPan = _mm_add_ps(mmOne, mmPan);
-        mmPan = _mm_mul_ps(mmOne, mmPiFour);
+        mmPan = _mm_mul_ps(mmPan, mmPiFour);
         sincos_ps(mmPan, &mmSin, &mmCos);
         auto mmLeft = _mm_mul_ps(mmCos, _mm_load_ps(left));
-        auto mmRight = _mm_mul_ps(mmCos, _mm_load_ps(left));
+        auto mmRight = _mm_mul_ps(mmSin, _mm_load_ps(right));
         _mm_store_ps(left, mmLeft);
         _mm_store_ps(right, mmRight);
         left += TypeAlignment;
@@ -642,6 +953,153 @@ void sfz::pan<float, true>(absl::Span<const float> panEnvelope, absl::Span<float
         snippetPan(pan, left, right);
 }
 
+template <>
+void sfz::tablePan<float, true>(absl::Span<const float> panEnvelope, absl::Span<float> leftBuffer, absl::Span<float> rightBuffer) noexcept
+{
+    ASSERT(leftBuffer.size() >= panEnvelope.size());
+    ASSERT(rightBuffer.size() >= panEnvelope.size());
+    const auto& table = getPanTable();
+    auto* pan = panEnvelope.begin();
+    auto* left = leftBuffer.begin();
+    auto* right = rightBuffer.begin();
+    auto* sentinel = pan + min(panEnvelope.size(), leftBuffer.size(), rightBuffer.size());
+    const auto* lastAligned = prevAligned(sentinel);
+
+    while (unaligned(pan, left, right) && pan < lastAligned)
+        snippetTablePan(table, pan, left, right);
+
+    __m128 mmLeftGain;
+    __m128 mmRightGain;
+    while (pan < lastAligned) {
+        tablePanGains(table, _mm_load_ps(pan), mmLeftGain, mmRightGain);
+        _mm_store_ps(left, _mm_mul_ps(mmLeftGain, _mm_load_ps(left)));
+        _mm_store_ps(right, _mm_mul_ps(mmRightGain, _mm_load_ps(right)));
+        left += TypeAlignment;
+        right += TypeAlignment;
+        pan += TypeAlignment;
+    }
+
+    while (pan < sentinel)
+        snippetTablePan(table, pan, left, right);
+}
+
+template <>
+void sfz::mixStereo<float, true>(float leftToLeft, float rightToLeft, float leftToRight, float rightToRight, absl::Span<float> leftBuffer, absl::Span<float> rightBuffer) noexcept
+{
+    ASSERT(leftBuffer.size() == rightBuffer.size());
+    auto* left = leftBuffer.begin();
+    auto* right = rightBuffer.begin();
+    auto* sentinel = left + std::min(leftBuffer.size(), rightBuffer.size());
+    const auto* lastAligned = prevAligned(sentinel);
+
+    while (unaligned(left, right) && left < lastAligned)
+        snippetMixStereo(leftToLeft, rightToLeft, leftToRight, rightToRight, left, right);
+
+    const auto mmLeftToLeft = _mm_set_ps1(leftToLeft);
+    const auto mmRightToLeft = _mm_set_ps1(rightToLeft);
+    const auto mmLeftToRight = _mm_set_ps1(leftToRight);
+    const auto mmRightToRight = _mm_set_ps1(rightToRight);
+    while (left < lastAligned) {
+        const auto mmLeft = _mm_load_ps(left);
+        const auto mmRight = _mm_load_ps(right);
+        _mm_store_ps(left, _mm_add_ps(_mm_mul_ps(mmLeftToLeft, mmLeft), _mm_mul_ps(mmRightToLeft, mmRight)));
+        _mm_store_ps(right, _mm_add_ps(_mm_mul_ps(mmLeftToRight, mmLeft), _mm_mul_ps(mmRightToRight, mmRight)));
+        left += TypeAlignment;
+        right += TypeAlignment;
+    }
+
+    while (left < sentinel)
+        snippetMixStereo(leftToLeft, rightToLeft, leftToRight, rightToRight, left, right);
+}
+
+template <>
+void sfz::applyGainAndPan<float, true>(absl::Span<const float> amplitudeEnvelope, absl::Span<const float> egEnvelope, absl::Span<const float> volumeEnvelope,
+    absl::Span<const float> panEnvelope, absl::Span<float> leftBuffer, absl::Span<float> rightBuffer) noexcept
+{
+    ASSERT(leftBuffer.size() >= panEnvelope.size());
+    ASSERT(rightBuffer.size() >= panEnvelope.size());
+    auto* amplitude = amplitudeEnvelope.begin();
+    auto* eg = egEnvelope.begin();
+    auto* volume = volumeEnvelope.begin();
+    auto* pan = panEnvelope.begin();
+    auto* left = leftBuffer.begin();
+    auto* right = rightBuffer.begin();
+    auto* sentinel = left + min(min(amplitudeEnvelope.size(), egEnvelope.size(), volumeEnvelope.size()), panEnvelope.size(), std::min(leftBuffer.size(), rightBuffer.size()));
+    const auto* lastAligned = prevAligned(sentinel);
+    const auto& table = getPanTable();
+
+    while ((unaligned(amplitude, eg, volume, pan) || unaligned(left, right)) && left < lastAligned)
+        snippetGainAndPan(table, amplitude, eg, volume, pan, left, right);
+
+    __m128 mmLeftGain;
+    __m128 mmRightGain;
+    while (left < lastAligned) {
+        const auto mmGain = _mm_mul_ps(_mm_mul_ps(_mm_load_ps(amplitude), _mm_load_ps(eg)), _mm_load_ps(volume));
+        const auto mmSample = _mm_mul_ps(mmGain, _mm_load_ps(left));
+        tablePanGains(table, _mm_load_ps(pan), mmLeftGain, mmRightGain);
+        _mm_store_ps(left, _mm_mul_ps(mmSample, mmLeftGain));
+        _mm_store_ps(right, _mm_mul_ps(mmSample, mmRightGain));
+        amplitude += TypeAlignment;
+        eg += TypeAlignment;
+        volume += TypeAlignment;
+        pan += TypeAlignment;
+        left += TypeAlignment;
+        right += TypeAlignment;
+    }
+
+    while (left < sentinel)
+        snippetGainAndPan(table, amplitude, eg, volume, pan, left, right);
+}
+
+template <>
+void sfz::applyGainWidthAndPosition<float, true>(absl::Span<const float> amplitudeEnvelope, absl::Span<const float> egEnvelope, absl::Span<const float> volumeEnvelope,
+    absl::Span<const float> widthEnvelope, absl::Span<const float> positionEnvelope, absl::Span<float> leftBuffer, absl::Span<float> rightBuffer) noexcept
+{
+    ASSERT(leftBuffer.size() >= widthEnvelope.size());
+    ASSERT(rightBuffer.size() >= widthEnvelope.size());
+    auto* amplitude = amplitudeEnvelope.begin();
+    auto* eg = egEnvelope.begin();
+    auto* volume = volumeEnvelope.begin();
+    auto* width = widthEnvelope.begin();
+    auto* position = positionEnvelope.begin();
+    auto* left = leftBuffer.begin();
+    auto* right = rightBuffer.begin();
+    auto* sentinel = left + min(min(amplitudeEnvelope.size(), egEnvelope.size(), volumeEnvelope.size()), std::min(widthEnvelope.size(), positionEnvelope.size()), std::min(leftBuffer.size(), rightBuffer.size()));
+    const auto* lastAligned = prevAligned(sentinel);
+    const auto& table = getPanTable();
+
+    while ((unaligned(amplitude, eg, volume) || unaligned(width, position, left, right)) && left < lastAligned)
+        snippetGainWidthAndPosition(table, amplitude, eg, volume, width, position, left, right);
+
+    const auto mmSqrtTwoInv = _mm_set_ps1(sqrtTwoInv<float>);
+    __m128 mmSideGain;
+    __m128 mmMidGain;
+    __m128 mmLeftSideGain;
+    __m128 mmRightSideGain;
+    while (left < lastAligned) {
+        auto mmGain = _mm_mul_ps(_mm_mul_ps(_mm_load_ps(amplitude), _mm_load_ps(eg)), _mm_load_ps(volume));
+        mmGain = _mm_mul_ps(mmGain, mmSqrtTwoInv);
+        const auto mmLeft = _mm_load_ps(left);
+        const auto mmRight = _mm_load_ps(right);
+        tablePanGains(table, _mm_load_ps(width), mmSideGain, mmMidGain);
+        tablePanGains(table, _mm_load_ps(position), mmLeftSideGain, mmRightSideGain);
+        const auto mmMid = _mm_mul_ps(_mm_mul_ps(_mm_add_ps(mmLeft, mmRight), mmGain), mmMidGain);
+        const auto mmSide = _mm_mul_ps(_mm_mul_ps(_mm_sub_ps(mmLeft, mmRight), mmGain), mmSideGain);
+        _mm_store_ps(left, _mm_mul_ps(_mm_add_ps(mmMid, _mm_mul_ps(mmSide, mmLeftSideGain)), mmSqrtTwoInv));
+        _mm_store_ps(right, _mm_mul_ps(_mm_add_ps(mmMid, _mm_mul_ps(mmSide, mmRightSideGain)), mmSqrtTwoInv));
+        amplitude += TypeAlignment;
+        eg += TypeAlignment;
+        volume += TypeAlignment;
+        width += TypeAlignment;
+        position += TypeAlignment;
+        left += TypeAlignment;
+        right += TypeAlignment;
+    }
+
+    while (left < sentinel)
+        snippetGainWidthAndPosition(table, amplitude, eg, volume, width, position, left, right);
+}
+
 template <>
 float sfz::mean<float, true>(absl::Span<const float> vector) noexcept
 {
@@ -714,6 +1172,11 @@ float sfz::meanSquared<float, true>(absl::Span<const float> vector) noexcept
 template <>
 void sfz::cumsum<float, true>(absl::Span<const float> input, absl::Span<float> output) noexcept
 {
+    if (useAVX2()) {
+        avx2::cumsum(input, output);
+        return;
+    }
+
     ASSERT(output.size() >= input.size());
     if (input.size() == 0)
         return;
@@ -746,6 +1209,16 @@ void sfz::cumsum<float, true>(absl::Span<const float> input, absl::Span<float> o
 template <>
 void sfz::sfzInterpolationCast<float, true>(absl::Span<const float> floatJumps, absl::Span<int> jumps, absl::Span<float> leftCoeffs, absl::Span<float> rightCoeffs) noexcept
 {
+    if (useAVX512()) {
+        avx512::sfzInterpolationCast(floatJumps, jumps, leftCoeffs, rightCoeffs);
+        return;
+    }
+
+    if (useAVX2()) {
+        avx2::sfzInterpolationCast(floatJumps, jumps, leftCoeffs, rightCoeffs);
+        return;
+    }
+
     ASSERT(jumps.size() >= floatJumps.size());
     ASSERT(jumps.size() == leftCoeffs.size());
     ASSERT(jumps.size() == rightCoeffs.size());
@@ -762,7 +1235,8 @@ void sfz::sfzInterpolationCast<float, true>(absl::Span<const float> floatJumps,
 
     while (floatJump < lastAligned) {
         auto mmFloatJumps = _mm_load_ps(floatJump);
-        auto mmIndices = _mm_cvtps_epi32(_mm_sub_ps(mmFloatJumps, _mm_set_ps1(0.4999999552965164184570312f)));
+        // Truncating like the scalar cast, which keeps the exact integers on their own frame
+        auto mmIndices = _mm_cvttps_epi32(mmFloatJumps);
         _mm_store_si128(reinterpret_cast<__m128i*>(jump), mmIndices);
 
         auto mmRight = _mm_sub_ps(mmFloatJumps, _mm_cvtepi32_ps(mmIndices));
@@ -809,4 +1283,236 @@ void sfz::diff<float, true>(absl::Span<const float> input, absl::Span<float> out
 
     while (in < sentinel)
         snippetDiff(in, out);
-}
\ No newline at end of file
+}
+
+template <>
+void sfz::int16ToFloat<float, true>(absl::Span<const int16_t> input, absl::Span<float> output) noexcept
+{
+    ASSERT(output.size() >= input.size());
+    auto* in = input.begin();
+    auto* out = output.begin();
+    auto* sentinel = out + min(input.size(), output.size());
+    const auto* lastAligned = prevAligned(sentinel);
+
+    while (unaligned(out) && out < lastAligned)
+        snippetInt16ToFloat<float>(in, out);
+
+    // The input is only 8 bytes per 4 floats so it is loaded unaligned
+    while (out < lastAligned) {
+        const auto mmInput = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(in));
+        const auto mmExtended = _mm_srai_epi32(_mm_unpacklo_epi16(mmInput, mmInput), 16);
+        _mm_store_ps(out, _mm_cvtepi32_ps(mmExtended));
+        out += TypeAlignment;
+        in += TypeAlignment;
+    }
+
+    while (out < sentinel)
+        snippetInt16ToFloat<float>(in, out);
+}
+
+template <>
+void sfz::interpolate<float, true>(absl::Span<const float> source, absl::Span<const int> indices, absl::Span<const float> leftCoeffs, absl::Span<const float> rightCoeffs, absl::Span<float> output) noexcept
+{
+    if (useAVX512()) {
+        avx512::interpolate(source, indices, leftCoeffs, rightCoeffs, output);
+        return;
+    }
+
+    if (useAVX2()) {
+        avx2::interpolate(source, indices, leftCoeffs, rightCoeffs, output);
+        return;
+    }
+
+    ASSERT(output.size() >= indices.size());
+    ASSERT(leftCoeffs.size() >= indices.size());
+    ASSERT(rightCoeffs.size() >= indices.size());
+
+    auto index = indices.data();
+    auto leftCoeff = leftCoeffs.data();
+    auto rightCoeff = rightCoeffs.data();
+    auto out = output.data();
+    const auto sentinel = out + min(indices.size(), leftCoeffs.size(), rightCoeffs.size(), output.size());
+    const auto* lastAligned = prevAligned(sentinel);
+
+    while (unaligned(out, leftCoeff, rightCoeff) && out < lastAligned)
+        snippetInterpolate(source.data(), index, leftCoeff, rightCoeff, out);
+
+    // SSE has no gather so the frames are loaded one by one, but the blend runs 4 frames at a time
+    const auto* data = source.data();
+    while (out < lastAligned) {
+        const auto mmFirst = _mm_setr_ps(data[index[0]], data[index[1]], data[index[2]], data[index[3]]);
+        const auto mmNext = _mm_setr_ps(data[index[0] + 1], data[index[1] + 1], data[index[2] + 1], data[index[3] + 1]);
+        _mm_store_ps(out, _mm_add_ps(_mm_mul_ps(mmFirst, _mm_load_ps(leftCoeff)), _mm_mul_ps(mmNext, _mm_load_ps(rightCoeff))));
+        index += TypeAlignment;
+        leftCoeff += TypeAlignment;
+        rightCoeff += TypeAlignment;
+        out += TypeAlignment;
+    }
+
+    while (out < sentinel)
+        snippetInterpolate(source.data(), index, leftCoeff, rightCoeff, out);
+}
+
+template <>
+void sfz::interpolateStereo<float, true>(absl::Span<const float> leftSource, absl::Span<const float> rightSource, absl::Span<const int> indices, absl::Span<const float> leftCoeffs, absl::Span<const float> rightCoeffs, absl::Span<float> leftOutput, absl::Span<float> rightOutput) noexcept
+{
+    if (useAVX512()) {
+        avx512::interpolateStereo(leftSource, rightSource, indices, leftCoeffs, rightCoeffs, leftOutput, rightOutput);
+        return;
+    }
+
+    if (useAVX2()) {
+        avx2::interpolateStereo(leftSource, rightSource, indices, leftCoeffs, rightCoeffs, leftOutput, rightOutput);
+        return;
+    }
+
+    ASSERT(leftOutput.size() >= indices.size());
+    ASSERT(rightOutput.size() >= indices.size());
+    ASSERT(leftCoeffs.size() >= indices.size());
+    ASSERT(rightCoeffs.size() >= indices.size());
+
+    auto index = indices.data();
+    auto leftCoeff = leftCoeffs.data();
+    auto rightCoeff = rightCoeffs.data();
+    auto left = leftOutput.data();
+    auto right = rightOutput.data();
+    const auto sentinel = left + min(indices.size(), leftCoeffs.size(), rightCoeffs.size(), std::min(leftOutput.size(), rightOutput.size()));
+    const auto* lastAligned = prevAligned(sentinel);
+
+    while (unaligned(left, right, leftCoeff, rightCoeff) && left < lastAligned)
+        snippetInterpolateStereo(leftSource.data(), rightSource.data(), index, leftCoeff, rightCoeff, left, right);
+
+    const auto* leftData = leftSource.data();
+    const auto* rightData = rightSource.data();
+    while (left < lastAligned) {
+        const auto mmLeftCoeffs = _mm_load_ps(leftCoeff);
+        const auto mmRightCoeffs = _mm_load_ps(rightCoeff);
+        const auto mmLeftFirst = _mm_setr_ps(leftData[index[0]], leftData[index[1]], leftData[index[2]], leftData[index[3]]);
+        const auto mmLeftNext = _mm_setr_ps(leftData[index[0] + 1], leftData[index[1] + 1], leftData[index[2] + 1], leftData[index[3] + 1]);
+        _mm_store_ps(left, _mm_add_ps(_mm_mul_ps(mmLeftFirst, mmLeftCoeffs), _mm_mul_ps(mmLeftNext, mmRightCoeffs)));
+        const auto mmRightFirst = _mm_setr_ps(rightData[index[0]], rightData[index[1]], rightData[index[2]], rightData[index[3]]);
+        const auto mmRightNext = _mm_setr_ps(rightData[index[0] + 1], rightData[index[1] + 1], rightData[index[2] + 1], rightData[index[3] + 1]);
+        _mm_store_ps(right, _mm_add_ps(_mm_mul_ps(mmRightFirst, mmLeftCoeffs), _mm_mul_ps(mmRightNext, mmRightCoeffs)));
+        index += TypeAlignment;
+        leftCoeff += TypeAlignment;
+        rightCoeff += TypeAlignment;
+        left += TypeAlignment;
+        right += TypeAlignment;
+    }
+
+    while (left < sentinel)
+        snippetInterpolateStereo(leftSource.data(), rightSource.data(), index, leftCoeff, rightCoeff, left, right);
+}
+
+template <>
+void sfz::interpolateHermite<float, true>(absl::Span<const float> source, absl::Span<const int> indices, absl::Span<const float> coeffs, absl::Span<float> output) noexcept
+{
+    ASSERT(output.size() >= indices.size());
+    ASSERT(coeffs.size() >= indices.size());
+
+    auto index = indices.data();
+    auto coeff = coeffs.data();
+    auto out = output.data();
+    const auto size = static_cast<int>(source.size());
+    const auto sentinel = out + min(indices.size(), coeffs.size(), output.size());
+    const auto* lastAligned = prevAligned(sentinel);
+
+    while (unaligned(out, coeff) && out < lastAligned)
+        snippetInterpolateHermite(source.data(), size, index, coeff, out);
+
+    const auto* data = source.data();
+    const auto mmHalf = _mm_set1_ps(0.5f);
+    const auto mmOneAndHalf = _mm_set1_ps(1.5f);
+    const auto mmTwo = _mm_set1_ps(2.0f);
+    const auto mmTwoAndHalf = _mm_set1_ps(2.5f);
+    while (out < lastAligned) {
+        // Frames close to the edges of the source go through the scalar path
+        const auto minIndex = std::min(std::min(index[0], index[1]), std::min(index[2], index[3]));
+        const auto maxIndex = std::max(std::max(index[0], index[1]), std::max(index[2], index[3]));
+        if (minIndex < 1 || maxIndex + 2 >= size) {
+            for (unsigned i = 0; i < TypeAlignment; ++i)
+                snippetInterpolateHermite(source.data(), size, index, coeff, out);
+            continue;
+        }
+
+        const auto x0 = _mm_setr_ps(data[index[0] - 1], data[index[1] - 1], data[index[2] - 1], data[index[3] - 1]);
+        const auto x1 = _mm_setr_ps(data[index[0]], data[index[1]], data[index[2]], data[index[3]]);
+        const auto x2 = _mm_setr_ps(data[index[0] + 1], data[index[1] + 1], data[index[2] + 1], data[index[3] + 1]);
+        const auto x3 = _mm_setr_ps(data[index[0] + 2], data[index[1] + 2], data[index[2] + 2], data[index[3] + 2]);
+        const auto t = _mm_load_ps(coeff);
+        const auto c1 = _mm_mul_ps(mmHalf, _mm_sub_ps(x2, x0));
+        auto c2 = _mm_sub_ps(x0, _mm_mul_ps(mmTwoAndHalf, x1));
+        c2 = _mm_add_ps(c2, _mm_mul_ps(mmTwo, x2));
+        c2 = _mm_sub_ps(c2, _mm_mul_ps(mmHalf, x3));
+        const auto c3 = _mm_add_ps(_mm_mul_ps(mmHalf, _mm_sub_ps(x3, x0)), _mm_mul_ps(mmOneAndHalf, _mm_sub_ps(x1, x2)));
+        auto mmOut = _mm_add_ps(_mm_mul_ps(c3, t), c2);
+        mmOut = _mm_add_ps(_mm_mul_ps(mmOut, t), c1);
+        mmOut = _mm_add_ps(_mm_mul_ps(mmOut, t), x1);
+        _mm_store_ps(out, mmOut);
+        index += TypeAlignment;
+        coeff += TypeAlignment;
+        out += TypeAlignment;
+    }
+
+    while (out < sentinel)
+        snippetInterpolateHermite(source.data(), size, index, coeff, out);
+}
+
+template <>
+void sfz::interpolateSinc<float, true>(absl::Span<const float> source, absl::Span<const int> indices, absl::Span<const float> coeffs, absl::Span<float> output) noexcept
+{
+    ASSERT(output.size() >= indices.size());
+    ASSERT(coeffs.size() >= indices.size());
+    static_assert(SincTable::numTaps == 2 * TypeAlignment, "The SSE kernel handles 8 taps per frame");
+
+    const auto& table = getSincTable();
+    auto index = indices.data();
+    auto coeff = coeffs.data();
+    auto out = output.data();
+    const auto size = static_cast<int>(source.size());
+    const auto sentinel = out + min(indices.size(), coeffs.size(), output.size());
+    const auto* lastAligned = prevAligned(sentinel);
+
+    while (unaligned(out) && out < lastAligned)
+        snippetInterpolateSinc(source.data(), size, table, index, coeff, out);
+
+    // Each frame is a dot product of the 8 source frames around it with the taps of its phase;
+    // 4 frames are summed at once by transposing their partial sums
+    const auto* data = source.data();
+    const auto mmPhases = _mm_set1_ps(static_cast<float>(SincTable::numPhases));
+    while (out < lastAligned) {
+        const auto minIndex = std::min(std::min(index[0], index[1]), std::min(index[2], index[3]));
+        const auto maxIndex = std::max(std::max(index[0], index[1]), std::max(index[2], index[3]));
+        if (minIndex < SincTable::numTapsBefore || maxIndex - SincTable::numTapsBefore + SincTable::numTaps > size) {
+            for (unsigned i = 0; i < TypeAlignment; ++i)
+                snippetInterpolateSinc(source.data(), size, table, index, coeff, out);
+            continue;
+        }
+
+        const auto mmPosition = _mm_mul_ps(_mm_loadu_ps(coeff), mmPhases);
+        const auto mmPhase = _mm_cvttps_epi32(mmPosition);
+        alignas(16) float phaseCoeffs[TypeAlignment];
+        alignas(16) int phases[TypeAlignment];
+        _mm_store_ps(phaseCoeffs, _mm_sub_ps(mmPosition, _mm_cvtepi32_ps(mmPhase)));
+        _mm_store_si128(reinterpret_cast<__m128i*>(phases), mmPhase);
+
+        __m128 sums[TypeAlignment];
+        for (unsigned i = 0; i < TypeAlignment; ++i) {
+            const auto* taps = table.taps[phases[i]];
+            const auto* deltas = table.deltas[phases[i]];
+            const auto* frames = data + index[i] - SincTable::numTapsBefore;
+            const auto mmPhaseCoeff = _mm_set1_ps(phaseCoeffs[i]);
+            const auto mmTaps0 = _mm_add_ps(_mm_load_ps(taps), _mm_mul_ps(mmPhaseCoeff, _mm_load_ps(deltas)));
+            const auto mmTaps1 = _mm_add_ps(_mm_load_ps(taps + 4), _mm_mul_ps(mmPhaseCoeff, _mm_load_ps(deltas + 4)));
+            sums[i] = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(frames), mmTaps0), _mm_mul_ps(_mm_loadu_ps(frames + 4), mmTaps1));
+        }
+        _MM_TRANSPOSE4_PS(sums[0], sums[1], sums[2], sums[3]);
+        _mm_store_ps(out, _mm_add_ps(_mm_add_ps(sums[0], sums[1]), _mm_add_ps(sums[2], sums[3])));
+        index += TypeAlignment;
+        coeff += TypeAlignment;
+        out += TypeAlignment;
+    }
+
+    while (out < sentinel)
+        snippetInterpolateSinc(source.data(), size, table, index, coeff, out);
+}
@@ -0,0 +1,135 @@
+// Copyright (c) 2019, Paul Ferrand
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#pragma once
+#include "AudioBuffer.h"
+#include "MemoryLock.h"
+#include <atomic>
+#include <cstdint>
+
+namespace sfz {
+// Audio data read from a file. 16 bit files are kept as integers, which takes
+// half the memory of floats; anything else is converted to floats on read.
+class SampleBuffer {
+public:
+    enum class Format { float32, int16 };
+    // Gain that brings the 16 bit integer samples back to [-1, 1]
+    static constexpr float int16Gain { 1.0f / 32768.0f };
+
+    // Locked samples stay in RAM, so that the audio thread never waits on a page fault to read them
+    enum class Locking { none, locked, lockedHugePages };
+    // With an arena the channels are carved out of its slabs instead of the heap
+    SampleBuffer(Format format, int numChannels, int numFrames, Locking locking = Locking::none, SlabArena* arena = nullptr)
+        : format(format)
+    {
+        if (format == Format::int16)
+            int16Buffer = makeBuffer<int16_t>(numChannels, numFrames, arena);
+        else
+            floatBuffer = makeBuffer<float>(numChannels, numFrames, arena);
+
+        if (locking == Locking::none || numChannels == 0 || numFrames == 0)
+            return;
+
+        // Locking before the samples are written lets the huge pages back the buffer from the start;
+        // the channels are contiguous so they are locked at once
+        if (lockMemory(getStorage(), getStorageBytes(), locking == Locking::lockedHugePages))
+            lockedBytes = getStorageBytes();
+        totalLockedBytes() += lockedBytes;
+    }
+    ~SampleBuffer()
+    {
+        if (lockedBytes == 0)
+            return;
+
+        unlockMemory(getStorage(), lockedBytes);
+        totalLockedBytes() -= lockedBytes;
+    }
+
+    Format getFormat() const noexcept { return format; }
+    size_t getNumFrames() const noexcept { return format == Format::int16 ? int16Buffer->getNumFrames() : floatBuffer->getNumFrames(); }
+    int getNumChannels() const noexcept { return format == Format::int16 ? int16Buffer->getNumChannels() : floatBuffer->getNumChannels(); }
+    size_t getNumBytes() const noexcept
+    {
+        const size_t sampleSize = format == Format::int16 ? sizeof(int16_t) : sizeof(float);
+        return getNumFrames() * getNumChannels() * sampleSize;
+    }
+
+    AudioBuffer<float>& getFloatBuffer() noexcept
+    {
+        ASSERT(format == Format::float32);
+        return *floatBuffer;
+    }
+    const AudioBuffer<float>& getFloatBuffer() const noexcept
+    {
+        ASSERT(format == Format::float32);
+        return *floatBuffer;
+    }
+    AudioBuffer<int16_t>& getInt16Buffer() noexcept
+    {
+        ASSERT(format == Format::int16);
+        return *int16Buffer;
+    }
+    const AudioBuffer<int16_t>& getInt16Buffer() const noexcept
+    {
+        ASSERT(format == Format::int16);
+        return *int16Buffer;
+    }
+    // The whole storage is locked, including the padding of the channels
+    size_t getStorageBytes() const noexcept
+    {
+        if (format == Format::int16)
+            return int16Buffer->getChannelStride() * getNumChannels() * sizeof(int16_t);
+        return floatBuffer->getChannelStride() * getNumChannels() * sizeof(float);
+    }
+    size_t getLockedBytes() const noexcept { return lockedBytes; }
+    bool isInArena() const noexcept { return format == Format::int16 ? int16Buffer->isInArena() : floatBuffer->isInArena(); }
+    // Sample memory locked in the whole process, which is what the system limit applies to
+    static size_t getTotalLockedBytes() noexcept { return totalLockedBytes(); }
+
+private:
+    template <class T>
+    static std::unique_ptr<AudioBuffer<T>> makeBuffer(int numChannels, int numFrames, SlabArena* arena)
+    {
+        if (arena != nullptr)
+            return std::make_unique<AudioBuffer<T>>(numChannels, numFrames, *arena);
+        return std::make_unique<AudioBuffer<T>>(numChannels, numFrames);
+    }
+    void* getStorage() noexcept
+    {
+        if (format == Format::int16)
+            return int16Buffer->channelWriter(0);
+        return floatBuffer->channelWriter(0);
+    }
+    static std::atomic<size_t>& totalLockedBytes() noexcept
+    {
+        static std::atomic<size_t> total { 0 };
+        return total;
+    }
+    Format format;
+    size_t lockedBytes { 0 };
+    std::unique_ptr<AudioBuffer<float>> floatBuffer;
+    std::unique_ptr<AudioBuffer<int16_t>> int16Buffer;
+    LEAK_DETECTOR(SampleBuffer);
+};
+} // namespace sfz
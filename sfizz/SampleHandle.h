@@ -0,0 +1,47 @@
+// Copyright (c) 2019, Paul Ferrand
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#pragma once
+#include "SampleBuffer.h"
+#include "ghc/fs_std.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace sfz {
+// All the regions playing the same file share its handle, so that the file pool
+// can grow the preloaded data without keeping a copy around for each region.
+struct SampleHandle {
+    std::shared_ptr<SampleBuffer> preloadedData { nullptr };
+    // Resolved once at load time; the ids are never reused so the loader can key its open files on them
+    fs::path path;
+    uint32_t id { 0 };
+    // Counted by the audio thread; the least played files are the first to lose their preload under memory pressure
+    std::atomic<uint32_t> numPlays { 0 };
+    // Audio thread only: the full preload of a deferred file, grown in the background once a region can play it,
+    // and whether a preload request is on its way
+    uint32_t deferredPreloadEnd { 0 };
+    bool preloadPending { false };
+};
+} // namespace sfz
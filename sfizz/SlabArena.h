@@ -0,0 +1,103 @@
+// Copyright (c) 2019, Paul Ferrand
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+#include "Config.h"
+#include "LeakDetector.h"
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+
+namespace sfz {
+// Hands out storage from a few large slabs rather than one heap block per request. A block keeps its slab
+// alive, so the slabs are freed at once when the arena and all the blocks carved out of them are gone;
+// nothing is ever freed on its own. Allocating is thread-safe.
+class SlabArena {
+public:
+    SlabArena(size_t slabSize = config::arenaSlabSize)
+        : slabSize(slabSize)
+    {
+    }
+
+    // Returns an empty pointer when the system is out of memory
+    std::shared_ptr<char> allocate(size_t size, size_t alignment) noexcept
+    {
+        std::lock_guard<std::mutex> guard { arenaMutex };
+        // Blocks larger than a slab get a slab of their own, which leaves the current one free for the next blocks
+        const auto paddedSize = size + alignment;
+        if (paddedSize > slabSize) {
+            auto slab = newSlab(paddedSize);
+            if (slab == nullptr)
+                return {};
+            return { slab, align(slab.get(), alignment) };
+        }
+
+        auto* block = currentSlab != nullptr ? align(currentSlab.get() + slabOffset, alignment) : nullptr;
+        if (block == nullptr || block + size > currentSlab.get() + slabSize) {
+            currentSlab = newSlab(slabSize);
+            if (currentSlab == nullptr)
+                return {};
+            block = align(currentSlab.get(), alignment);
+        }
+        slabOffset = static_cast<size_t>(block + size - currentSlab.get());
+        return { currentSlab, block };
+    }
+
+    size_t getNumSlabs() const noexcept
+    {
+        std::lock_guard<std::mutex> guard { arenaMutex };
+        return numSlabs;
+    }
+    // Bytes reserved by all the slabs allocated so far, including the ones already freed
+    size_t getReservedBytes() const noexcept
+    {
+        std::lock_guard<std::mutex> guard { arenaMutex };
+        return reservedBytes;
+    }
+
+private:
+    std::shared_ptr<char> newSlab(size_t size) noexcept
+    {
+        auto* data = static_cast<char*>(std::malloc(size));
+        if (data == nullptr)
+            return {};
+
+        numSlabs++;
+        reservedBytes += size;
+        return { data, std::free };
+    }
+    static char* align(char* pointer, size_t alignment) noexcept
+    {
+        const auto address = reinterpret_cast<uintptr_t>(pointer);
+        return pointer + (alignment - address % alignment) % alignment;
+    }
+    const size_t slabSize;
+    std::shared_ptr<char> currentSlab;
+    size_t slabOffset { 0 };
+    size_t numSlabs { 0 };
+    size_t reservedBytes { 0 };
+    mutable std::mutex arenaMutex;
+    LEAK_DETECTOR(SlabArena);
+};
+} // namespace sfz
@@ -29,6 +29,7 @@
 #include "ScopedFTZ.h"
 #include "StringViewHelpers.h"
 #include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_set.h"
 #include <algorithm>
 #include <chrono>
 #include <iostream>
@@ -38,7 +39,7 @@ using namespace std::literals;
 sfz::Synth::Synth()
 {
     for (int i = 0; i < config::numVoices; ++i)
-        voices.push_back(std::make_unique<Voice>(midiState));
+        voices.push_back(std::make_unique<Voice>(midiState, filePool));
     voiceViewArray.reserve(config::numVoices);
 }
 
@@ -113,12 +114,17 @@ void sfz::Synth::clear()
         std::this_thread::sleep_for(1ms);
     }
     
-    for (auto &voice: voices)
+    // The audio thread is kept out, so the voices let go of their data here rather than through the retire queue
+    for (auto &voice: voices) {
+        voice->releaseFileData();
         voice->reset();
+    }
     for (auto& list: noteActivationLists)
         list.clear();
     for (auto& list: ccActivationLists)
         list.clear();
+    for (auto& list: keyswitchLists)
+        list.clear();
     regions.clear();
     filePool.clear();
     hasGlobal = false;
@@ -214,13 +220,40 @@ bool sfz::Synth::loadSfzFile(const fs::path& filename)
 
     filePool.setRootDirectory(this->rootDirectory);
 
+    // Regions behind a keyswitch other than sw_default cannot play until the keyswitch is pressed.
+    // Regions also gated by sw_up, sw_down or sw_previous follow the keyboard state rather than
+    // a single key, so they are always preloaded.
+    auto isReachable = [&](const Region& region) {
+        if (!lazyKeyswitchPreload || !region.keyswitch)
+            return true;
+
+        if (region.keyswitchUp || region.keyswitchDown || region.previousNote)
+            return true;
+
+        return defaultSwitch && *defaultSwitch == *region.keyswitch && region.keyswitchRange.containsWithEnd(*defaultSwitch);
+    };
+
+    absl::flat_hash_map<std::string, FilePool::PreloadRequest> preloadRequests;
+    absl::flat_hash_set<std::string> reachableFiles;
+    for (auto& region : regions) {
+        if (region->isGenerator())
+            continue;
+
+        preloadRequests[region->sample].add(region->offset + region->offsetRandom, region->getMaxPitchRatio(), region->preloadSize);
+        if (isReachable(*region))
+            reachableFiles.insert(region->sample);
+    }
+    for (auto& request : preloadRequests)
+        request.second.deferred = !reachableFiles.contains(request.first);
+    filePool.preloadFiles(preloadRequests, progressCallback);
+
     auto lastRegion = regions.end() - 1;
     auto currentRegion = regions.begin();
     while (currentRegion <= lastRegion) {
         auto region = currentRegion->get();
 
         if (!region->isGenerator()) {
-            auto fileInformation = filePool.getFileInformation(region->sample, region->offset + region->offsetRandom);
+            auto fileInformation = filePool.getFileInformation(region->sample, preloadRequests[region->sample]);
             if (!fileInformation) {
                 DBG("Removing the region with sample " << region->sample);
                 std::iter_swap(currentRegion, lastRegion);
@@ -229,8 +262,11 @@ bool sfz::Synth::loadSfzFile(const fs::path& filename)
             }
             region->sampleEnd = std::min(region->sampleEnd, fileInformation->end);
             region->loopRange.shrinkIfSmaller(fileInformation->loopBegin, fileInformation->loopEnd);
-            region->preloadedData = fileInformation->preloadedData;
+            region->sampleHandle = fileInformation->sampleHandle;
             region->sampleRate = fileInformation->sampleRate;
+
+            if (region->keyswitch)
+                keyswitchLists[*region->keyswitch].push_back(region);
         }
 
         for (auto note = 0; note < 128; note++) {
@@ -334,6 +370,18 @@ void sfz::Synth::setSampleRate(float sampleRate) noexcept
         voice->setSampleRate(sampleRate);
 }
 
+void sfz::Synth::setSampleQuality(int quality) noexcept
+{
+    AtomicDisabler callbackDisabler { canEnterCallback };
+    while (inCallback) {
+        std::this_thread::sleep_for(1ms);
+    }
+
+    sampleQuality = Default::sampleQualityRange.clamp(quality);
+    for (auto& voice : voices)
+        voice->setSampleQuality(sampleQuality);
+}
+
 void sfz::Synth::renderBlock(AudioSpan<float> buffer) noexcept
 {
     ScopedFTZ ftz;
@@ -343,6 +391,7 @@ void sfz::Synth::renderBlock(AudioSpan<float> buffer) noexcept
         return;
 
     AtomicGuard callbackGuard { inCallback };
+    filePool.applyPreloadUpdates(voices);
 
     auto tempSpan = AudioSpan<float>(tempBuffer).first(buffer.getNumFrames());
     for (auto& voice : voices) {
@@ -365,6 +414,9 @@ void sfz::Synth::noteOn(int delay, int channel, int noteNumber, uint8_t velocity
 
     auto randValue = randNoteDistribution(Random::randomGenerator);
 
+    if (lazyKeyswitchPreload)
+        preloadKeyswitches(noteNumber);
+
     for (auto& region : noteActivationLists[noteNumber]) {
         if (region->registerNoteOn(channel, noteNumber, velocity, randValue)) {
             for (auto& voice : voices) {
@@ -379,10 +431,40 @@ void sfz::Synth::noteOn(int delay, int channel, int noteNumber, uint8_t velocity
             voice->startVoice(region, delay, channel, noteNumber, velocity, Voice::TriggerType::NoteOn);
             if (!region->isGenerator()) {
                 voice->expectFileData(fileTicket);
-                filePool.enqueueLoading(voice, &region->sample, region->trueSampleEnd(), fileTicket++);
+                filePool.enqueueLoading(voice, region->sampleHandle, region->trueSampleEnd(), fileTicket++);
             }
         }
     }
+
+    // Warm the regions this note triggers next so that they do not race the loader
+    for (auto& region : noteActivationLists[noteNumber]) {
+        if (region->isGenerator() || !region->keyRange.containsWithEnd(noteNumber))
+            continue;
+
+        if (!(region->isRelease() && region->isSwitchedOn()) && !region->isNextInSequence())
+            continue;
+
+        const auto prefetchEnd = std::min(region->trueSampleEnd(), region->offset + region->offsetRandom + static_cast<uint32_t>(config::prefetchSize));
+        if (region->sampleHandle->preloadedData->getNumFrames() < prefetchEnd)
+            filePool.enqueuePreload(region->sampleHandle, prefetchEnd);
+    }
+}
+
+void sfz::Synth::preloadKeyswitches(int noteNumber) noexcept
+{
+    auto preloadKeyswitch = [&](int keyswitch) {
+        for (auto* region : keyswitchLists[keyswitch])
+            filePool.enqueuePreload(region->sampleHandle, region->sampleHandle->deferredPreloadEnd);
+        return !keyswitchLists[keyswitch].empty();
+    };
+
+    // The articulations next to the selected one are the most likely to come next
+    if (preloadKeyswitch(noteNumber)) {
+        if (noteNumber > 0)
+            preloadKeyswitch(noteNumber - 1);
+        if (noteNumber < 127)
+            preloadKeyswitch(noteNumber + 1);
+    }
 }
 
 void sfz::Synth::noteOff(int delay, int channel, int noteNumber, uint8_t velocity [[maybe_unused]]) noexcept
@@ -412,7 +494,7 @@ void sfz::Synth::noteOff(int delay, int channel, int noteNumber, uint8_t velocit
             voice->startVoice(region, delay, channel, noteNumber, replacedVelocity, Voice::TriggerType::NoteOff);
             if (!region->isGenerator()) {
                 voice->expectFileData(fileTicket);
-                filePool.enqueueLoading(voice, &region->sample, region->trueSampleEnd(), fileTicket++);
+                filePool.enqueueLoading(voice, region->sampleHandle, region->trueSampleEnd(), fileTicket++);
             }
         }
     }
@@ -442,7 +524,7 @@ void sfz::Synth::cc(int delay, int channel, int ccNumber, uint8_t ccValue) noexc
             voice->startVoice(region, delay, channel, ccNumber, ccValue, Voice::TriggerType::CC);
             if (!region->isGenerator()) {
                 voice->expectFileData(fileTicket);
-                filePool.enqueueLoading(voice, &region->sample, region->trueSampleEnd(), fileTicket++);
+                filePool.enqueueLoading(voice, region->sampleHandle, region->trueSampleEnd(), fileTicket++);
             }
         }
     }
@@ -476,3 +558,78 @@ size_t sfz::Synth::getNumPreloadedSamples() const noexcept
 {
     return filePool.getNumPreloadedSamples();
 }
+
+size_t sfz::Synth::getPreloadedBytes() const noexcept
+{
+    return filePool.getPreloadedBytes();
+}
+
+void sfz::Synth::setPreloadSize(uint32_t numFrames) noexcept
+{
+    filePool.setPreloadSize(numFrames);
+}
+
+void sfz::Synth::setPreloadDuration(float seconds) noexcept
+{
+    filePool.setPreloadDuration(seconds);
+}
+
+void sfz::Synth::setAdaptivePreload() noexcept
+{
+    filePool.setAdaptivePreload();
+}
+
+void sfz::Synth::setCacheDirectory(const fs::path& directory) noexcept
+{
+    filePool.setCacheDirectory(directory);
+}
+
+void sfz::Synth::setProgressCallback(FilePool::ProgressCallback callback) noexcept
+{
+    progressCallback = std::move(callback);
+}
+
+void sfz::Synth::setLoadingQueueCapacity(size_t capacity) noexcept
+{
+    AtomicDisabler callbackDisabler { canEnterCallback };
+    while (inCallback) {
+        std::this_thread::sleep_for(1ms);
+    }
+
+    filePool.setLoadingQueueCapacity(capacity);
+}
+
+void sfz::Synth::setLoadingOverflowPolicy(FilePool::OverflowPolicy policy) noexcept
+{
+    AtomicDisabler callbackDisabler { canEnterCallback };
+    while (inCallback) {
+        std::this_thread::sleep_for(1ms);
+    }
+
+    filePool.setOverflowPolicy(policy);
+}
+
+sfz::FilePool::LoadingStats sfz::Synth::getLoadingStats() const noexcept
+{
+    return filePool.getLoadingStats();
+}
+
+void sfz::Synth::resetLoadingStats() noexcept
+{
+    filePool.resetLoadingStats();
+}
+
+void sfz::Synth::setMemoryBudget(size_t bytes) noexcept
+{
+    filePool.setMemoryBudget(bytes);
+}
+
+sfz::FilePool::MemoryStats sfz::Synth::getMemoryStats() const noexcept
+{
+    return filePool.getMemoryStats();
+}
+
+void sfz::Synth::setMemoryLocking(SampleBuffer::Locking locking) noexcept
+{
+    filePool.setMemoryLocking(locking);
+}
@@ -48,9 +48,36 @@ public:
     const Region* getRegionView(int idx) const noexcept;
     std::set<absl::string_view> getUnknownOpcodes() const noexcept;
     size_t getNumPreloadedSamples() const noexcept;
+    size_t getPreloadedBytes() const noexcept;
+    // The preloading policy applies on the next call to loadSfzFile
+    void setPreloadSize(uint32_t numFrames) noexcept;
+    void setPreloadDuration(float seconds) noexcept;
+    void setAdaptivePreload() noexcept;
+    // Decoded preloads are kept in this directory to speed up the next loads; an empty path disables the cache
+    void setCacheDirectory(const fs::path& directory) noexcept;
+    // Called after each file during loadSfzFile, from the preload worker threads and the calling thread;
+    // the calls never overlap but may come from different threads. The callback must not call back into
+    // the synth, and any UI state it updates has to be handed over to the UI thread.
+    void setProgressCallback(FilePool::ProgressCallback callback) noexcept;
+    // Only preload the head of the files behind a keyswitch other than sw_default, and preload the rest
+    // in the background when a keyswitch selects them; applies on the next call to loadSfzFile
+    void setLazyKeyswitchPreload(bool lazy) noexcept { lazyKeyswitchPreload = lazy; }
+    void setLoadingQueueCapacity(size_t capacity) noexcept;
+    void setLoadingOverflowPolicy(FilePool::OverflowPolicy policy) noexcept;
+    FilePool::LoadingStats getLoadingStats() const noexcept;
+    void resetLoadingStats() noexcept;
+    // Bytes of sample data the synth may keep in memory; 0 means no limit
+    void setMemoryBudget(size_t bytes) noexcept;
+    FilePool::MemoryStats getMemoryStats() const noexcept;
+    // Lock the sample data in RAM to avoid page faults in the audio thread; applies on the next call to loadSfzFile
+    void setMemoryLocking(SampleBuffer::Locking locking) noexcept;
 
     void setSamplesPerBlock(int samplesPerBlock) noexcept;
     void setSampleRate(float sampleRate) noexcept;
+    // Interpolation quality of the regions without a sample_quality opcode: 0 and 1 are linear,
+    // 2 is cubic Hermite and 3 and above are windowed sinc
+    void setSampleQuality(int quality) noexcept;
+    int getSampleQuality() const noexcept { return sampleQuality; }
     void renderBlock(AudioSpan<float> buffer) noexcept;
     void noteOn(int delay, int channel, int noteNumber, uint8_t velocity) noexcept;
     void noteOff(int delay, int channel, int noteNumber, uint8_t velocity) noexcept;
@@ -80,6 +107,9 @@ private:
     std::vector<Opcode> groupOpcodes;
 
     FilePool filePool;
+    FilePool::ProgressCallback progressCallback;
+    bool lazyKeyswitchPreload { false };
+    void preloadKeyswitches(int noteNumber) noexcept;
     MidiState midiState;
     Voice* findFreeVoice() noexcept;
     std::vector<CCNamePair> ccNames;
@@ -92,10 +122,12 @@ private:
     VoicePtrVector voiceViewArray;
     std::array<RegionPtrVector, 128> noteActivationLists;
     std::array<RegionPtrVector, 128> ccActivationLists;
+    std::array<RegionPtrVector, 128> keyswitchLists; // Sample regions selected by each sw_last key
 
     AudioBuffer<float> tempBuffer { 2, config::defaultSamplesPerBlock };
     int samplesPerBlock { config::defaultSamplesPerBlock };
     float sampleRate { config::defaultSampleRate };
+    int sampleQuality { Default::sampleQuality };
 
     std::uniform_real_distribution<float> randNoteDistribution { 0, 1 };
     unsigned fileTicket { 1 };
@@ -22,6 +22,7 @@
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "Voice.h"
+#include "FilePool.h"
 #include "AudioSpan.h"
 #include "Config.h"
 #include "Defaults.h"
@@ -31,9 +32,13 @@
 #include "absl/algorithm/container.h"
 #include <memory>
 
-sfz::Voice::Voice(const MidiState& midiState)
+sfz::Voice::Voice(const MidiState& midiState, FilePool& filePool)
     : midiState(midiState)
+    , filePool(filePool)
 {
+    // Keep the tables of the windowed-sinc interpolation and the pan law out of the audio thread
+    getSincTable();
+    getPanTable();
 }
 
 void sfz::Voice::startVoice(Region* region, int delay, int channel, int number, uint8_t value, sfz::Voice::TriggerType triggerType) noexcept
@@ -118,13 +123,26 @@ void sfz::Voice::prepareEGEnvelope(int delay, uint8_t velocity) noexcept
         normalizePercents(region->amplitudeEG.getStart(midiState.cc, velocity)));
 }
 
-void sfz::Voice::setFileData(std::shared_ptr<AudioBuffer<float>> file, unsigned ticket) noexcept
+void sfz::Voice::setFileData(std::shared_ptr<SampleBuffer> file, unsigned ticket) noexcept
 {
-    if (ticket != this->ticket)
-        return;
+    // The loader never touches the voice state; the audio thread picks the data up in pollFileData
+    if (!fileDataMailbox.try_enqueue({ std::move(file), ticket })) {
+        DBG("The file data mailbox of a voice is full, dropping the data");
+    }
+}
 
-    fileData = std::move(file);
-    dataReady.store(true);
+void sfz::Voice::pollFileData() noexcept
+{
+    FileDataDelivery delivery;
+    while (fileDataMailbox.try_dequeue(delivery)) {
+        if (delivery.ticket == ticket && !dataReady) {
+            fileData = std::move(delivery.data);
+            dataReady = true;
+        } else {
+            // Data for a note this voice does not play anymore
+            filePool.retire(std::move(delivery.data));
+        }
+    }
 }
 
 bool sfz::Voice::isFree() const noexcept
@@ -219,10 +237,16 @@ void sfz::Voice::setSamplesPerBlock(int samplesPerBlock) noexcept
     tempBuffer1.resize(samplesPerBlock);
     tempBuffer2.resize(samplesPerBlock);
     tempBuffer3.resize(samplesPerBlock);
+    tempBuffer4.resize(samplesPerBlock);
+    tempBuffer5.resize(samplesPerBlock);
     indexBuffer.resize(samplesPerBlock);
+    for (auto& decodeBuffer : decodeBuffers)
+        decodeBuffer.resize(config::decodeWindowFactor * samplesPerBlock + config::sincTaps);
     tempSpan1 = absl::MakeSpan(tempBuffer1);
     tempSpan2 = absl::MakeSpan(tempBuffer2);
     tempSpan3 = absl::MakeSpan(tempBuffer3);
+    tempSpan4 = absl::MakeSpan(tempBuffer4);
+    tempSpan5 = absl::MakeSpan(tempBuffer5);
     indexSpan = absl::MakeSpan(indexBuffer);
 }
 
@@ -230,6 +254,7 @@ void sfz::Voice::renderBlock(AudioSpan<float> buffer) noexcept
 {
     ASSERT(static_cast<int>(buffer.getNumFrames()) <= samplesPerBlock);
     buffer.fill(0.0f);
+    pollFileData();
 
     if (state == State::idle || region == nullptr) {
         powerHistory.push(0.0);
@@ -259,91 +284,70 @@ void sfz::Voice::renderBlock(AudioSpan<float> buffer) noexcept
 void sfz::Voice::processMono(AudioSpan<float> buffer) noexcept
 {
     const auto numSamples = buffer.getNumFrames();
+    auto amplitudeSpan = tempSpan1.first(numSamples);
+    auto egSpan = tempSpan2.first(numSamples);
+    auto volumeSpan = tempSpan3.first(numSamples);
+    auto panSpan = tempSpan4.first(numSamples);
     auto leftBuffer = buffer.getSpan(0);
     auto rightBuffer = buffer.getSpan(1);
 
-    auto span1 = tempSpan1.first(numSamples);
-    auto span2 = tempSpan2.first(numSamples);
-
-    // Amplitude envelope
-    amplitudeEnvelope.getBlock(span1);
-    applyGain<float>(span1, leftBuffer);
-
-    // AmpEG envelope
-    egEnvelope.getBlock(span1);
-    applyGain<float>(span1, leftBuffer);
-
-    // Volume envelope
-    volumeEnvelope.getBlock(span1);
-    applyGain<float>(span1, leftBuffer);
+    // The envelopes render their own blocks and are applied together in a single pass.
+    // We assume that the pan envelope is already normalized between -1 and 1
+    bool constant = amplitudeEnvelope.getBlock(amplitudeSpan);
+    constant &= egEnvelope.getBlock(egSpan);
+    constant &= volumeEnvelope.getBlock(volumeSpan);
+    constant &= panEnvelope.getBlock(panSpan);
+    if (numSamples == 0)
+        return;
 
-    // Prepare for stereo output
-    copy<float>(leftBuffer, rightBuffer);
+    if (!constant) {
+        applyGainAndPan<float>(amplitudeSpan, egSpan, volumeSpan, panSpan, leftBuffer, rightBuffer);
+        return;
+    }
 
-    panEnvelope.getBlock(span1);
-    // We assume that the pan envelope is already normalized between -1 and 1
-    // Check bm_pan for your architecture to check if it's interesting to use the pan helper instead
-    fill<float>(span2, 1.0f);
-    add<float>(span1, span2);
-    applyGain<float>(piFour<float>, span2);
-    cos<float>(span2, span1);
-    sin<float>(span2, span2);
-    applyGain<float>(span1, leftBuffer);
-    applyGain<float>(span2, rightBuffer);
+    // Without any change in the block, e.g. for sustained notes, the gains are scalars
+    const auto gain = amplitudeSpan.front() * egSpan.front() * volumeSpan.front();
+    const auto circlePan = piFour<float> * (1.0f + panSpan.front());
+    applyGain<float>(gain * std::sin(circlePan), leftBuffer, rightBuffer);
+    applyGain<float>(gain * std::cos(circlePan), leftBuffer);
 }
 
 void sfz::Voice::processStereo(AudioSpan<float> buffer) noexcept
 {
     const auto numSamples = buffer.getNumFrames();
-    auto span1 = tempSpan1.first(numSamples);
-    auto span2 = tempSpan2.first(numSamples);
-    auto span3 = tempSpan3.first(numSamples);
+    auto amplitudeSpan = tempSpan1.first(numSamples);
+    auto egSpan = tempSpan2.first(numSamples);
+    auto volumeSpan = tempSpan3.first(numSamples);
+    auto widthSpan = tempSpan4.first(numSamples);
+    auto positionSpan = tempSpan5.first(numSamples);
     auto leftBuffer = buffer.getSpan(0);
     auto rightBuffer = buffer.getSpan(1);
 
-    // Amplitude envelope
-    amplitudeEnvelope.getBlock(span1);
-    buffer.applyGain(span1);
-
-    // AmpEG envelope
-    egEnvelope.getBlock(span1);
-    buffer.applyGain(span1);
-
-    // Volume envelope
-    volumeEnvelope.getBlock(span1);
-    buffer.applyGain(span1);
-
-    // Create mid/side from left/right in the output buffer
-    copy<float>(rightBuffer, span1);
-    add<float>(leftBuffer, rightBuffer);
-    subtract<float>(span1, leftBuffer);
-    applyGain<float>(sqrtTwoInv<float>, leftBuffer);
-    applyGain<float>(sqrtTwoInv<float>, rightBuffer);
-
-    // Apply the width process
-    widthEnvelope.getBlock(span1);
-    fill<float>(span2, 1.0f);
-    add<float>(span1, span2);
-    applyGain<float>(piFour<float>, span2);
-    cos<float>(span2, span1);
-    sin<float>(span2, span2);
-    applyGain<float>(span1, leftBuffer);
-    applyGain<float>(span2, rightBuffer);
-
-    // Apply a position to the "left" channel which is supposed to be our mid channel
+    // The width is applied on the mid/side decomposition of the voice, and the position
+    // spreads its side channel over the output; see applyGainWidthAndPosition
     // TODO: add panning here too?
-    positionEnvelope.getBlock(span1);
-    fill<float>(span2, 1.0f);
-    add<float>(span1, span2);
-    applyGain<float>(piFour<float>, span2);
-    cos<float>(span2, span1);
-    sin<float>(span2, span2);
-    copy<float>(leftBuffer, span3);
-    copy<float>(rightBuffer, leftBuffer);
-    multiplyAdd<float>(span1, span3, leftBuffer);
-    multiplyAdd<float>(span2, span3, rightBuffer);
-    applyGain<float>(sqrtTwoInv<float>, leftBuffer);
-    applyGain<float>(sqrtTwoInv<float>, rightBuffer);
+    bool constant = amplitudeEnvelope.getBlock(amplitudeSpan);
+    constant &= egEnvelope.getBlock(egSpan);
+    constant &= volumeEnvelope.getBlock(volumeSpan);
+    constant &= widthEnvelope.getBlock(widthSpan);
+    constant &= positionEnvelope.getBlock(positionSpan);
+    if (numSamples == 0)
+        return;
+
+    if (!constant) {
+        applyGainWidthAndPosition<float>(amplitudeSpan, egSpan, volumeSpan, widthSpan, positionSpan, leftBuffer, rightBuffer);
+        return;
+    }
+
+    // Without any change in the block the whole stage folds into a constant mix of both channels
+    const auto gain = amplitudeSpan.front() * egSpan.front() * volumeSpan.front() * 0.5f;
+    const auto circleWidth = piFour<float> * (1.0f + widthSpan.front());
+    const auto circlePosition = piFour<float> * (1.0f + positionSpan.front());
+    const auto mid = gain * std::sin(circleWidth);
+    const auto side = gain * std::cos(circleWidth);
+    const auto leftSide = side * std::cos(circlePosition);
+    const auto rightSide = side * std::sin(circlePosition);
+    mixStereo<float>(mid + leftSide, mid - leftSide, mid + rightSide, mid - rightSide, leftBuffer, rightBuffer);
 }
 
 void sfz::Voice::fillWithData(AudioSpan<float> buffer) noexcept
@@ -351,86 +355,111 @@ void sfz::Voice::fillWithData(AudioSpan<float> buffer) noexcept
     if (buffer.getNumFrames() == 0)
         return;
 
-    auto source { [&]() {
-        if (region->canUsePreloadedData())
-            return AudioSpan<const float>(*region->preloadedData);
-        else if (!dataReady)
-            return AudioSpan<const float>(*region->preloadedData);
+    auto& source { [&]() -> SampleBuffer& {
+        if (region->canUsePreloadedData() || !dataReady)
+            return *region->sampleHandle->preloadedData;
         else
-            return AudioSpan<const float>(*fileData);
+            return *fileData;
     }() };
 
     auto indices = indexSpan.first(buffer.getNumFrames());
-    auto jumps = tempSpan1.first(buffer.getNumFrames());
     auto leftCoeffs = tempSpan1.first(buffer.getNumFrames());
     auto rightCoeffs = tempSpan2.first(buffer.getNumFrames());
 
-    fill<float>(jumps, pitchRatio * speedRatio);
-    jumps[0] += floatPositionOffset;
-    cumsum<float>(jumps, jumps);
-    sfzInterpolationCast<float>(jumps, indices, leftCoeffs, rightCoeffs);
-    add<int>(sourcePosition, indices);
-
+    // Sustain loops only loop until the note is released
+    const auto looping = region->loopMode == SfzLoopMode::loop_continuous
+        || (region->loopMode == SfzLoopMode::loop_sustain && state != State::release);
+    const auto playbackEnd = looping ? min(region->trueSampleEnd(), region->loopRange.getEnd()) : region->trueSampleEnd();
     //FIXME : all this casting is driving me crazy
-    const auto sampleEnd = min(static_cast<int>(region->trueSampleEnd()), static_cast<int>(source.getNumFrames())) - 1;
-    if (region->shouldLoop() && region->loopRange.getEnd() <= source.getNumFrames()) {
-        const auto offset = sampleEnd - static_cast<int>(region->loopRange.getStart());
-        for (auto* index = indices.begin(); index < indices.end(); ++index) {
-            if (*index > sampleEnd) {
-                const auto remainingElements = static_cast<size_t>(std::distance(index, indices.end()));
-                subtract<int>(offset, { index, remainingElements });
-            }
+    const auto sampleEnd = min(static_cast<int>(playbackEnd), static_cast<int>(source.getNumFrames())) - 1;
+    const auto loop = looping && region->loopRange.getEnd() <= source.getNumFrames();
+    phaseIndex<float>(pitchRatio * speedRatio, sourcePosition, floatPositionOffset, sampleEnd,
+        static_cast<int>(region->loopRange.getStart()), loop, indices, leftCoeffs, rightCoeffs);
+
+    const auto quality = region->sampleQuality.value_or(sampleQuality);
+    if (source.getFormat() == SampleBuffer::Format::int16) {
+        // The conversion gain is folded into the linear interpolation coefficients, and applied afterwards otherwise
+        const bool linear = quality <= 1;
+        if (linear) {
+            applyGain<float>(SampleBuffer::int16Gain, leftCoeffs);
+            applyGain<float>(SampleBuffer::int16Gain, rightCoeffs);
         }
-    } else {
-        for (auto* index = indices.begin(); index < indices.end(); ++index) {
-            if (*index > sampleEnd) {
-                const auto remainingElements = static_cast<size_t>(std::distance(index, indices.end()));
-                fill<int>(indices.last(remainingElements), sampleEnd);
-                fill<float>(leftCoeffs.last(remainingElements), 0.0f);
-                fill<float>(rightCoeffs.last(remainingElements), 1.0f);
-                break;
-            }
+        auto& int16Source = source.getInt16Buffer();
+        int firstIndex { 0 };
+        if (decodeWindow(int16Source, indices, quality, firstIndex)) {
+            // The window starts with the first frame read in this block
+            AudioSpan<const float> window { { decodeBuffers[0].data(), decodeBuffers[1].data() }, int16Source.getNumChannels(), 0, decodeBuffers[0].size() };
+            subtract<int>(firstIndex, indices);
+            interpolate<float>(window, indices, leftCoeffs, rightCoeffs, quality, buffer);
+            add<int>(firstIndex, indices);
+        } else {
+            interpolate<int16_t>(AudioSpan<const int16_t>(int16Source), indices, leftCoeffs, rightCoeffs, quality, buffer);
         }
-    }
-
-    auto ind = indices.data();
-    auto leftCoeff = leftCoeffs.data();
-    auto rightCoeff = rightCoeffs.data();
-    auto left = buffer.getChannel(0);
-    auto leftSource = source.getChannel(0);
-    if (source.getNumChannels() == 1) {
-        while (ind < indices.end()) {
-            *left = leftSource[*ind] * (*leftCoeff) + leftSource[*ind + 1] * (*rightCoeff);
-            left++;
-            ind++;
-            leftCoeff++;
-            rightCoeff++;
+        if (!linear) {
+            for (int channel = 0; channel < int16Source.getNumChannels(); ++channel)
+                applyGain<float>(SampleBuffer::int16Gain, buffer.getSpan(channel));
         }
     } else {
-        auto right = buffer.getChannel(1);
-        auto rightSource = source.getChannel(1);
-        while (ind < indices.end()) {
-            *left = leftSource[*ind] * (*leftCoeff) + leftSource[*ind + 1] * (*rightCoeff);
-            *right = rightSource[*ind] * (*leftCoeff) + rightSource[*ind + 1] * (*rightCoeff);
-            left++;
-            right++;
-            ind++;
-            leftCoeff++;
-            rightCoeff++;
-        }
+        interpolate<float>(AudioSpan<const float>(source.getFloatBuffer()), indices, leftCoeffs, rightCoeffs, quality, buffer);
     }
 
-    sourcePosition = indices.back();
-    floatPositionOffset = rightCoeffs.back();
-
-    if (state != State::release && !region->shouldLoop() && sourcePosition == sampleEnd) {
-        DBG("Releasing " << region->sample);
+    if (!looping && sourcePosition == sampleEnd) {
         auto last = std::distance(indices.begin(), absl::c_find(indices, sampleEnd));
-        release(last);
+        if (state != State::release) {
+            DBG("Releasing " << region->sample);
+            release(last);
+        }
         buffer.subspan(last).fill(0.0f);
     }
 }
 
+bool sfz::Voice::decodeWindow(const AudioBuffer<int16_t>& source, absl::Span<const int> indices, int quality, int& firstIndex) noexcept
+{
+    // Decode the part of the source read by this block, if it fits, so that
+    // the interpolation itself runs on floats; the frames around the indices
+    // that the interpolation reads are included
+    const auto framesBefore = quality >= 3 ? SincTable::numTapsBefore : (quality == 2 ? 1 : 0);
+    const auto framesAfter = quality >= 3 ? SincTable::numTaps - SincTable::numTapsBefore - 1 : (quality == 2 ? 2 : 1);
+    const auto minMax = std::minmax_element(indices.begin(), indices.end());
+    firstIndex = std::max(*minMax.first - framesBefore, 0);
+    const auto windowSize = static_cast<size_t>(*minMax.second + framesAfter - firstIndex + 1);
+    if (windowSize > decodeBuffers[0].size())
+        return false;
+
+    const auto availableFrames = std::min(windowSize, source.getNumFrames() - firstIndex);
+    for (int channel = 0; channel < source.getNumChannels(); ++channel) {
+        const auto decoded = absl::MakeSpan(decodeBuffers[channel]);
+        int16ToFloat<float>(source.getConstSpan(channel).subspan(firstIndex, availableFrames), decoded);
+        fill<float>(decoded.subspan(availableFrames, windowSize - availableFrames), 0.0f);
+    }
+    return true;
+}
+
+template <class T>
+void sfz::Voice::interpolate(AudioSpan<const T> source, absl::Span<const int> indices,
+    absl::Span<const float> leftCoeffs, absl::Span<const float> rightCoeffs, int quality, AudioSpan<float> buffer) noexcept
+{
+    // The higher quality kernels only need the fractional parts of the positions, which are the right coefficients
+    if (quality >= 3) {
+        for (int channel = 0; channel < source.getNumChannels(); ++channel)
+            sfz::interpolateSinc<T>(source.getConstSpan(channel), indices, rightCoeffs, buffer.getSpan(channel));
+        return;
+    }
+
+    if (quality == 2) {
+        for (int channel = 0; channel < source.getNumChannels(); ++channel)
+            sfz::interpolateHermite<T>(source.getConstSpan(channel), indices, rightCoeffs, buffer.getSpan(channel));
+        return;
+    }
+
+    if (source.getNumChannels() == 1) {
+        sfz::interpolate<T>(source.getConstSpan(0), indices, leftCoeffs, rightCoeffs, buffer.getSpan(0));
+    } else {
+        sfz::interpolateStereo<T>(source.getConstSpan(0), source.getConstSpan(1), indices, leftCoeffs, rightCoeffs,
+            buffer.getSpan(0), buffer.getSpan(1));
+    }
+}
+
 void sfz::Voice::fillWithGenerator(AudioSpan<float> buffer) noexcept
 {
     if (region->sample != "*sine")
@@ -483,8 +512,8 @@ sfz::Voice::TriggerType sfz::Voice::getTriggerType() const noexcept
 
 void sfz::Voice::reset() noexcept
 {
-    dataReady.store(false);
-    fileData.reset();
+    dataReady = false;
+    filePool.retire(std::move(fileData));
     state = State::idle;
     if (region != nullptr) {
         DBG("Reset voice with sample " << region->sample);
@@ -495,6 +524,12 @@ void sfz::Voice::reset() noexcept
     noteIsOff = false;
 }
 
+void sfz::Voice::releaseFileData() noexcept
+{
+    dataReady = false;
+    fileData.reset();
+}
+
 void sfz::Voice::garbageCollect() noexcept
 {
     if (state == State::idle && region == nullptr) {
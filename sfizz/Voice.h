@@ -28,18 +28,22 @@
 #include "HistoricalBuffer.h"
 #include "Region.h"
 #include "AudioBuffer.h"
+#include "SampleBuffer.h"
 #include "MidiState.h"
 #include "AudioSpan.h"
 #include "LeakDetector.h"
+#include "readerwriterqueue.h"
 #include <absl/types/span.h>
 #include <atomic>
 #include <memory>
 
 namespace sfz {
+class FilePool;
+
 class Voice {
 public:
     Voice() = delete;
-    Voice(const MidiState& midiState);
+    Voice(const MidiState& midiState, FilePool& filePool);
     enum class TriggerType {
         NoteOn,
         NoteOff,
@@ -47,11 +51,14 @@ public:
     };
     void setSampleRate(float sampleRate) noexcept;
     void setSamplesPerBlock(int samplesPerBlock) noexcept;
+    // Interpolation quality of the regions without a sample_quality opcode
+    void setSampleQuality(int quality) noexcept { sampleQuality = quality; }
     
     void startVoice(Region* region, int delay, int channel, int number, uint8_t value, TriggerType triggerType) noexcept;
 
     void expectFileData(unsigned ticket);
-    void setFileData(std::shared_ptr<AudioBuffer<float>> file, unsigned ticket) noexcept;
+    // Called by the loader thread; wait-free
+    void setFileData(std::shared_ptr<SampleBuffer> file, unsigned ticket) noexcept;
     void registerNoteOff(int delay, int channel, int noteNumber, uint8_t velocity) noexcept;
     void registerCC(int delay, int channel, int ccNumber, uint8_t ccValue) noexcept;
     void registerPitchWheel(int delay, int channel, int pitch) noexcept;
@@ -62,19 +69,29 @@ public:
     void renderBlock(AudioSpan<float, 2> buffer) noexcept;
 
     bool isFree() const noexcept;
+    const Region* getRegion() const noexcept { return region; }
     bool canBeStolen() const noexcept;
     int getTriggerNumber() const noexcept;
     int getTriggerChannel() const noexcept;
     uint8_t getTriggerValue() const noexcept;
     TriggerType getTriggerType() const noexcept;
 
+    // Called from the audio thread, which hands the file data over to the garbage thread
     void reset() noexcept;
+    // Drop the file data on the calling thread, while the audio thread is kept out of the synth
+    void releaseFileData() noexcept;
+    // Called from the other threads; an idle voice frees its file data in place
     void garbageCollect() noexcept;
 
     float getMeanSquaredAverage() const noexcept;
     uint32_t getSourcePosition() const noexcept;
 private:
+    void pollFileData() noexcept;
     void fillWithData(AudioSpan<float> buffer) noexcept;
+    template <class T>
+    void interpolate(AudioSpan<const T> source, absl::Span<const int> indices,
+        absl::Span<const float> leftCoeffs, absl::Span<const float> rightCoeffs, int quality, AudioSpan<float> buffer) noexcept;
+    bool decodeWindow(const AudioBuffer<int16_t>& source, absl::Span<const int> indices, int quality, int& firstIndex) noexcept;
     void fillWithGenerator(AudioSpan<float> buffer) noexcept;
     void prepareEGEnvelope(int delay, uint8_t velocity) noexcept;
     void processMono(AudioSpan<float> buffer) noexcept;
@@ -109,23 +126,36 @@ private:
     int sourcePosition { 0 };
     int initialDelay { 0 };
 
-    std::atomic<bool> dataReady { false };
-    std::shared_ptr<AudioBuffer<float>> fileData { nullptr };
+    // Only touched by the audio thread; the loader hands the file data over through the mailbox
+    bool dataReady { false };
+    std::shared_ptr<SampleBuffer> fileData { nullptr };
     unsigned ticket { 0 };
+    struct FileDataDelivery {
+        std::shared_ptr<SampleBuffer> data;
+        unsigned ticket { 0 };
+    };
+    moodycamel::ReaderWriterQueue<FileDataDelivery> fileDataMailbox { config::fileDataMailboxSize };
 
     Buffer<float> tempBuffer1;
     Buffer<float> tempBuffer2;
     Buffer<float> tempBuffer3;
+    Buffer<float> tempBuffer4;
+    Buffer<float> tempBuffer5;
     Buffer<int> indexBuffer;
+    std::array<Buffer<float>, 2> decodeBuffers;
     absl::Span<float> tempSpan1 { absl::MakeSpan(tempBuffer1) };
     absl::Span<float> tempSpan2 { absl::MakeSpan(tempBuffer2) };
     absl::Span<float> tempSpan3 { absl::MakeSpan(tempBuffer3) };
+    absl::Span<float> tempSpan4 { absl::MakeSpan(tempBuffer4) };
+    absl::Span<float> tempSpan5 { absl::MakeSpan(tempBuffer5) };
     absl::Span<int> indexSpan { absl::MakeSpan(indexBuffer) };
 
     int samplesPerBlock { config::defaultSamplesPerBlock };
     float sampleRate { config::defaultSampleRate };
+    int sampleQuality { Default::sampleQuality };
 
     const MidiState& midiState;
+    FilePool& filePool;
     ADSREnvelope<float> egEnvelope;
     LinearEnvelope<float> volumeEnvelope; // dB events but the envelope output is linear gain
     LinearEnvelope<float> amplitudeEnvelope; // linear events
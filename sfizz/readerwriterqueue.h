@@ -490,6 +490,22 @@ public:
 		return result;
 	}
 
+	// Returns the total number of items that could be enqueued without incurring
+	// an allocation when this queue is empty.
+	// Safe to call from both the producer and consumer threads.
+	inline size_t max_capacity() const AE_NO_TSAN
+	{
+		size_t result = 0;
+		Block* frontBlock_ = frontBlock.load();
+		Block* block = frontBlock_;
+		do {
+			fence(memory_order_acquire);
+			result += block->sizeMask;
+			block = block->next.load();
+		} while (block != frontBlock_);
+		return result;
+	}
+
 
 private:
 	enum AllocationMode { CanAlloc, CannotAlloc };
@@ -888,6 +904,14 @@ public:
 		return sema->availableApprox();
 	}
 
+	// Returns the total number of items that could be enqueued without incurring
+	// an allocation when this queue is empty.
+	// Safe to call from both the producer and consumer threads.
+	AE_FORCEINLINE size_t max_capacity() const AE_NO_TSAN
+	{
+		return inner.max_capacity();
+	}
+
 
 private:
 	// Disable copying & assignment
@@ -208,4 +208,53 @@ TEST_CASE("[ADSREnvelope] Hold with release 2")
     absl::c_fill(output, -1.0);
     envelope.getBlock(absl::MakeSpan(output));
     REQUIRE(approxEqual<float>(output, expected));
-}
\ No newline at end of file
+}
+
+TEST_CASE("[ADSREnvelope] Constant blocks")
+{
+    sfz::ADSREnvelope<float> envelope;
+    std::array<float, 4> output;
+    REQUIRE(envelope.getBlock(absl::MakeSpan(output)));
+    // Delay, attack, then sustain
+    envelope.reset(2, 2, 1.0, 4);
+    REQUIRE(envelope.getBlock(absl::MakeSpan(output)));
+    REQUIRE(!envelope.getBlock(absl::MakeSpan(output)));
+    REQUIRE(envelope.getBlock(absl::MakeSpan(output)));
+    REQUIRE(approxEqual<float>(output, { 1.0, 1.0, 1.0, 1.0 }));
+    // The release only breaks the block where it starts
+    envelope.startRelease(5);
+    REQUIRE(envelope.getBlock(absl::MakeSpan(output)));
+    REQUIRE(!envelope.getBlock(absl::MakeSpan(output)));
+}
+
+TEST_CASE("[ADSREnvelope] Decay with depth")
+{
+    sfz::ADSREnvelope<float> envelope;
+    envelope.reset(2, 4, 0.5, 0, 2, 0, 0.0, 0.5);
+    std::array<float, 6> output;
+    std::array<float, 6> expected { 0.25, 0.5, 0.353553, 0.25, 0.25, 0.25 };
+    envelope.getBlock(absl::MakeSpan(output));
+    REQUIRE(approxEqual<float>(output, expected));
+}
+
+TEST_CASE("[ADSREnvelope] Release across blocks")
+{
+    sfz::ADSREnvelope<float> envelope;
+    envelope.reset(2, 4, 0.5, 2, 2, 2);
+    envelope.startRelease(9);
+    std::array<float, 16> output;
+    std::array<float, 16> expected { 0.0, 0.0, 0.5, 1.0, 1.0, 1.0, 0.707107, 0.5, 0.5, 0.05, 0.005, 0.0005, 0.00005, 0.0, 0.0, 0.0 };
+    // The release starts in the middle of the second block and ends in the fourth one
+    for (size_t offset = 0; offset < output.size(); offset += 5)
+        envelope.getBlock(absl::MakeSpan(output).subspan(offset, 5));
+    REQUIRE(approxEqual<float>(output, expected));
+    REQUIRE(!envelope.isSmoothing());
+
+    // Releasing again does nothing once the release started
+    envelope.reset(2, 4);
+    envelope.startRelease(2);
+    envelope.getBlock(absl::MakeSpan(output).first(3));
+    envelope.startRelease(0);
+    envelope.getBlock(absl::MakeSpan(output).subspan(3, 5));
+    REQUIRE(approxEqual<float>(absl::MakeConstSpan(output).first(8), { 0.5, 1.0, 0.08409f, 0.00707f, 0.000594604f, 0.00005f, 0.0f, 0.0f }));
+}
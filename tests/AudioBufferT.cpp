@@ -99,4 +99,62 @@ TEST_CASE("[AudioSpan] Constructions")
     sfz::AudioSpan<const float> manualConstSpan { { buffer.channelReader(0), buffer.channelReader(1) }, buffer.getNumFrames() };
     sfz::AudioSpan<float> manualSpan2 { {buffer.getSpan(0), buffer.getSpan(1) } };
     sfz::AudioSpan<const float> manualConstSpan2 { {buffer.getConstSpan(0), buffer.getConstSpan(1) } };
-}
\ No newline at end of file
+}
+
+TEST_CASE("[AudioBuffer] Contiguous channels")
+{
+    sfz::AudioBuffer<float> buffer(2, 10);
+    REQUIRE(buffer.getChannelStride() >= buffer.getNumFrames());
+    REQUIRE(buffer.channelReader(1) == buffer.channelReader(0) + buffer.getChannelStride());
+    REQUIRE(reinterpret_cast<uintptr_t>(buffer.channelReader(0)) % sfz::SIMDConfig::defaultAlignment == 0);
+    REQUIRE(reinterpret_cast<uintptr_t>(buffer.channelReader(1)) % sfz::SIMDConfig::defaultAlignment == 0);
+    REQUIRE(!buffer.isInArena());
+}
+
+TEST_CASE("[AudioBuffer] Resize and add channels")
+{
+    sfz::AudioBuffer<float> buffer(1, 5);
+    for (size_t frameIdx = 0; frameIdx < buffer.getNumFrames(); ++frameIdx)
+        buffer.getSample(0, frameIdx) = static_cast<float>(frameIdx);
+
+    REQUIRE(buffer.resize(20));
+    REQUIRE(buffer.getNumFrames() == 20);
+    buffer.addChannel();
+    REQUIRE(buffer.getNumChannels() == 2);
+    REQUIRE(buffer.getSpan(1).size() == 20);
+    for (size_t frameIdx = 0; frameIdx < 5; ++frameIdx)
+        REQUIRE(buffer.getSample(0, frameIdx) == static_cast<float>(frameIdx));
+}
+
+TEST_CASE("[AudioBuffer] Arena storage")
+{
+    sfz::SlabArena arena { 4096 };
+    {
+        sfz::AudioBuffer<float> first(2, 100, arena);
+        sfz::AudioBuffer<int16_t> second(1, 33, arena);
+        REQUIRE(first.isInArena());
+        REQUIRE(second.isInArena());
+        REQUIRE(arena.getNumSlabs() == 1);
+        REQUIRE(first.channelReader(1) == first.channelReader(0) + first.getChannelStride());
+        REQUIRE(reinterpret_cast<uintptr_t>(second.channelReader(0)) % sfz::SIMDConfig::defaultAlignment == 0);
+        // Reading a frame past the last channel stays within the buffer's own storage
+        REQUIRE(reinterpret_cast<const char*>(second.channelReader(0)) > reinterpret_cast<const char*>(first.channelReaderEnd(1)));
+        std::fill(first.channelWriter(0), first.channelWriterEnd(1), 1.0f);
+        std::fill(second.channelWriter(0), second.channelWriterEnd(0), int16_t { 2 });
+        REQUIRE(std::all_of(first.channelReader(0), first.channelReaderEnd(1), [](float value) { return value == 1.0f; }));
+
+        // Larger than a slab
+        sfz::AudioBuffer<float> large(2, 4096, arena);
+        REQUIRE(large.isInArena());
+        REQUIRE(arena.getNumSlabs() == 2);
+        sfz::AudioBuffer<float> next(1, 10, arena);
+        REQUIRE(arena.getNumSlabs() == 2);
+
+        // Moving keeps the storage in the arena
+        sfz::AudioBuffer<float> moved { std::move(first) };
+        REQUIRE(moved.isInArena());
+        REQUIRE(moved.getSample(1, 99) == 1.0f);
+        REQUIRE(first.getNumChannels() == 0);
+    }
+    REQUIRE(arena.getReservedBytes() > 4096);
+}
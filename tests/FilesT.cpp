@@ -24,6 +24,11 @@
 #include "Synth.h"
 #include "catch2/catch.hpp"
 #include "../sfizz/ghc/fs_std.hpp"
+#include "absl/algorithm/container.h"
+#include <sndfile.hh>
+#include <fstream>
+#include <limits>
+#include <numeric>
 using namespace Catch::literals;
 
 TEST_CASE("[Files] Single region (regions_one.sfz)")
@@ -315,4 +320,787 @@ TEST_CASE("[Files] wrong (overlapping) replacement for defines")
     REQUIRE( synth.getRegionView(2)->amplitudeCC );
     REQUIRE( synth.getRegionView(2)->amplitudeCC->first == 10 );
     REQUIRE( synth.getRegionView(2)->amplitudeCC->second == 34.0f );
-}
\ No newline at end of file
+}
+
+TEST_CASE("[Files] Parallel preloading reports its progress")
+{
+    sfz::Synth synth;
+    std::vector<std::pair<int, int>> progress;
+    synth.setProgressCallback([&](int loaded, int total) { progress.emplace_back(loaded, total); });
+    synth.loadSfzFile(fs::current_path() / "tests/TestFiles/Regions/regions_many.sfz");
+    REQUIRE( synth.getNumRegions() == 3 );
+    REQUIRE( synth.getNumPreloadedSamples() == 3 );
+    REQUIRE( progress.size() == 3 );
+    for (size_t i = 0; i < progress.size(); ++i) {
+        REQUIRE( progress[i].first == static_cast<int>(i + 1) );
+        REQUIRE( progress[i].second == 3 );
+    }
+}
+
+TEST_CASE("[Files] Files shared between regions are preloaded once")
+{
+    sfz::Synth synth;
+    synth.loadSfzFile(fs::current_path() / "tests/TestFiles/basic_hierarchy.sfz");
+    REQUIRE( synth.getNumRegions() == 8 );
+    REQUIRE( synth.getNumPreloadedSamples() == 2 );
+    for (int i = 0; i < synth.getNumRegions(); ++i)
+        REQUIRE( synth.getRegionView(i)->sampleHandle != nullptr );
+}
+
+TEST_CASE("[Files] Sample paths are resolved once per file")
+{
+    sfz::Synth synth;
+    synth.loadSfzFile(fs::current_path() / "tests/TestFiles/basic_hierarchy.sfz");
+    REQUIRE( synth.getNumRegions() == 8 );
+    for (int i = 0; i < synth.getNumRegions(); ++i) {
+        const auto region = synth.getRegionView(i);
+        REQUIRE( fs::exists(region->sampleHandle->path) );
+        for (int j = 0; j < i; ++j) {
+            const auto otherRegion = synth.getRegionView(j);
+            const bool sameFile = region->sample == otherRegion->sample;
+            REQUIRE( (region->sampleHandle->id == otherRegion->sampleHandle->id) == sameFile );
+        }
+    }
+}
+
+TEST_CASE("[Files] Preload size policies")
+{
+    sfz::Synth synth;
+    const auto sfzFile = fs::current_path() / "tests/TestFiles/Regions/preload_size.sfz";
+
+    synth.setPreloadSize(100);
+    synth.loadSfzFile(sfzFile);
+    REQUIRE( synth.getNumRegions() == 3 );
+    // preload_size=0 preloads the whole file
+    REQUIRE( synth.getRegionView(0)->sampleHandle->preloadedData->getNumFrames() == synth.getRegionView(0)->sampleEnd );
+    REQUIRE( synth.getRegionView(1)->sampleHandle->preloadedData->getNumFrames() == 1500 );
+    REQUIRE( synth.getRegionView(2)->sampleHandle->preloadedData->getNumFrames() == 100 );
+    size_t expectedBytes { 0 };
+    for (int i = 0; i < synth.getNumRegions(); ++i) {
+        auto data = synth.getRegionView(i)->sampleHandle->preloadedData;
+        REQUIRE( data->getFormat() == sfz::SampleBuffer::Format::int16 );
+        expectedBytes += data->getNumFrames() * data->getNumChannels() * sizeof(int16_t);
+    }
+    REQUIRE( synth.getPreloadedBytes() == expectedBytes );
+
+    synth.setPreloadDuration(0.01f);
+    synth.loadSfzFile(sfzFile);
+    auto region = synth.getRegionView(2);
+    REQUIRE( region->sampleHandle->preloadedData->getNumFrames() == static_cast<size_t>(std::ceil(0.01f * region->sampleRate)) );
+    REQUIRE( synth.getRegionView(1)->sampleHandle->preloadedData->getNumFrames() == 1500 );
+
+    synth.setAdaptivePreload();
+    synth.loadSfzFile(sfzFile);
+    region = synth.getRegionView(2);
+    const auto minimumFrames = static_cast<size_t>(sfz::config::minimumLoaderLatency * region->sampleRate * region->getMaxPitchRatio());
+    REQUIRE( region->sampleHandle->preloadedData->getNumFrames() >= std::min(minimumFrames, static_cast<size_t>(region->sampleEnd)) );
+}
+
+TEST_CASE("[Files] Adaptive preloading follows the pitch range")
+{
+    sfz::Synth synth;
+    synth.setAdaptivePreload();
+    synth.loadSfzFile(fs::current_path() / "tests/TestFiles/Regions/regions_many.sfz");
+    REQUIRE( synth.getNumRegions() == 3 );
+    auto region = synth.getRegionView(0);
+    const auto expectedFrames = std::ceil(sfz::config::adaptivePreloadMargin * sfz::config::minimumLoaderLatency * region->sampleRate * region->getMaxPitchRatio());
+    REQUIRE( region->sampleHandle->preloadedData->getNumFrames() == std::min(static_cast<size_t>(expectedFrames), static_cast<size_t>(region->sampleEnd)) );
+}
+
+TEST_CASE("[Files] Growing a preload updates every region using the file")
+{
+    sfz::FilePool filePool;
+    filePool.setRootDirectory(fs::current_path() / "tests/TestFiles/Regions");
+    filePool.setPreloadSize(100);
+
+    sfz::FilePool::PreloadRequest shortRequest;
+    shortRequest.add(0, 1.0f, {});
+    auto shortInformation = filePool.getFileInformation("dummy.wav", shortRequest);
+    REQUIRE( shortInformation );
+    REQUIRE( shortInformation->sampleHandle->preloadedData->getNumFrames() == 100 );
+
+    sfz::FilePool::PreloadRequest longRequest;
+    longRequest.add(1000, 1.0f, {});
+    auto longInformation = filePool.getFileInformation("dummy.wav", longRequest);
+    REQUIRE( longInformation );
+    REQUIRE( longInformation->sampleHandle == shortInformation->sampleHandle );
+    REQUIRE( shortInformation->sampleHandle->preloadedData->getNumFrames() == 1100 );
+    REQUIRE( filePool.getNumPreloadedSamples() == 1 );
+    const auto numChannels = shortInformation->sampleHandle->preloadedData->getNumChannels();
+    REQUIRE( filePool.getPreloadedBytes() == 1100 * numChannels * sizeof(int16_t) );
+
+    // A smaller request reuses the existing preload
+    auto otherInformation = filePool.getFileInformation("dummy.wav", shortRequest);
+    REQUIRE( otherInformation->sampleHandle == shortInformation->sampleHandle );
+    REQUIRE( otherInformation->sampleHandle->preloadedData->getNumFrames() == 1100 );
+}
+
+TEST_CASE("[Files] 16 bit files are stored as integers")
+{
+    sfz::Synth synth;
+    synth.loadSfzFile(fs::current_path() / "tests/TestFiles/channels.sfz");
+    REQUIRE( synth.getNumRegions() == 2 );
+    auto monoData = synth.getRegionView(0)->sampleHandle->preloadedData;
+    REQUIRE( monoData->getFormat() == sfz::SampleBuffer::Format::int16 );
+    REQUIRE( monoData->getNumBytes() == monoData->getNumFrames() * sizeof(int16_t) );
+    // 24 bit files are still converted to floats
+    auto stereoData = synth.getRegionView(1)->sampleHandle->preloadedData;
+    REQUIRE( stereoData->getFormat() == sfz::SampleBuffer::Format::float32 );
+    REQUIRE( stereoData->getNumBytes() == stereoData->getNumFrames() * 2 * sizeof(float) );
+}
+
+TEST_CASE("[Files] Preloads are carved out of the instrument arena")
+{
+    sfz::Synth synth;
+    synth.loadSfzFile(fs::current_path() / "tests/TestFiles/channels.sfz");
+    REQUIRE( synth.getNumRegions() == 2 );
+    REQUIRE( synth.getRegionView(0)->sampleHandle->preloadedData->getInt16Buffer().isInArena() );
+    const auto& stereoData = synth.getRegionView(1)->sampleHandle->preloadedData->getFloatBuffer();
+    REQUIRE( stereoData.isInArena() );
+    REQUIRE( stereoData.channelReader(1) == stereoData.channelReader(0) + stereoData.getChannelStride() );
+
+    // Preloads kept alive past a reload still hold their slab
+    auto oldData = synth.getRegionView(1)->sampleHandle->preloadedData;
+    synth.loadSfzFile(fs::current_path() / "tests/TestFiles/channels.sfz");
+    REQUIRE( synth.getRegionView(1)->sampleHandle->preloadedData != oldData );
+    REQUIRE( oldData->getFloatBuffer().getSample(0, 0) == synth.getRegionView(1)->sampleHandle->preloadedData->getFloatBuffer().getSample(0, 0) );
+}
+
+TEST_CASE("[Files] Replaced arena preloads are counted against the budget")
+{
+    sfz::Synth synth;
+    synth.setSamplesPerBlock(256);
+    synth.setPreloadSize(1024);
+    synth.loadSfzFile(fs::current_path() / "tests/TestFiles/prefetch.sfz");
+    const auto releaseData = synth.getRegionView(1)->sampleHandle->preloadedData;
+    REQUIRE( releaseData->isInArena() );
+    REQUIRE( synth.getMemoryStats().pinnedBytes == 0 );
+
+    // Growing the preload leaves the first one in its slab
+    synth.noteOn(0, 1, 60, 127);
+    sfz::AudioBuffer<float> block { 2, 256 };
+    for (int i = 0; i < 100 && synth.getRegionView(1)->sampleHandle->preloadedData == releaseData; ++i) {
+        synth.renderBlock(block);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    REQUIRE( !synth.getRegionView(1)->sampleHandle->preloadedData->isInArena() );
+    REQUIRE( synth.getMemoryStats().pinnedBytes == releaseData->getNumBytes() );
+
+    // Loading again with a budget keeps the preloads on the heap
+    synth.setMemoryBudget(std::numeric_limits<size_t>::max());
+    synth.loadSfzFile(fs::current_path() / "tests/TestFiles/prefetch.sfz");
+    REQUIRE( synth.getMemoryStats().pinnedBytes == 0 );
+    REQUIRE( !synth.getRegionView(0)->sampleHandle->preloadedData->isInArena() );
+}
+
+TEST_CASE("[Files] Arena preloads are not shrunk to fit the memory budget")
+{
+    sfz::Synth synth;
+    synth.setSamplesPerBlock(256);
+    synth.setPreloadSize(0);
+    synth.loadSfzFile(fs::current_path() / "tests/TestFiles/channels.sfz");
+    const auto fullSize = synth.getMemoryStats().preloadedBytes;
+
+    // Shrinking them would free nothing until the instrument is unloaded
+    synth.setMemoryBudget(1);
+    sfz::AudioBuffer<float> block { 2, 256 };
+    for (int i = 0; i < 20; ++i) {
+        synth.renderBlock(block);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    REQUIRE( synth.getMemoryStats().numEvictions == 0 );
+    REQUIRE( synth.getMemoryStats().preloadedBytes == fullSize );
+}
+
+TEST_CASE("[Files] Preload cache")
+{
+    const auto cacheDirectory = fs::temp_directory_path() / "sfizz_preload_cache_test";
+    fs::remove_all(cacheDirectory);
+    const auto sfzFile = fs::current_path() / "tests/TestFiles/channels.sfz";
+
+    sfz::Synth decodingSynth;
+    decodingSynth.setCacheDirectory(cacheDirectory);
+    decodingSynth.setPreloadSize(1000);
+    decodingSynth.loadSfzFile(sfzFile);
+    REQUIRE( decodingSynth.getNumRegions() == 2 );
+    size_t numCacheFiles { 0 };
+    for (auto& entry : fs::directory_iterator(cacheDirectory)) {
+        REQUIRE( entry.path().extension() == ".sfzcache" );
+        numCacheFiles++;
+    }
+    REQUIRE( numCacheFiles == 2 );
+
+    // A smaller preload is read from the cache
+    sfz::Synth cachedSynth;
+    cachedSynth.setCacheDirectory(cacheDirectory);
+    cachedSynth.setPreloadSize(500);
+    cachedSynth.loadSfzFile(sfzFile);
+    REQUIRE( cachedSynth.getNumRegions() == 2 );
+    for (int regionIndex = 0; regionIndex < 2; ++regionIndex) {
+        const auto decodedRegion = decodingSynth.getRegionView(regionIndex);
+        const auto cachedRegion = cachedSynth.getRegionView(regionIndex);
+        REQUIRE( cachedRegion->sampleEnd == decodedRegion->sampleEnd );
+        REQUIRE( cachedRegion->sampleRate == decodedRegion->sampleRate );
+        const auto& decoded = *decodedRegion->sampleHandle->preloadedData;
+        const auto& cached = *cachedRegion->sampleHandle->preloadedData;
+        REQUIRE( cached.getNumFrames() == 500 );
+        REQUIRE( cached.getFormat() == decoded.getFormat() );
+        REQUIRE( cached.getNumChannels() == decoded.getNumChannels() );
+        for (int channel = 0; channel < cached.getNumChannels(); ++channel) {
+            if (cached.getFormat() == sfz::SampleBuffer::Format::int16) {
+                const auto decodedSpan = decoded.getInt16Buffer().getConstSpan(channel).first(500);
+                REQUIRE( absl::c_equal(cached.getInt16Buffer().getConstSpan(channel), decodedSpan) );
+            } else {
+                const auto decodedSpan = decoded.getFloatBuffer().getConstSpan(channel).first(500);
+                REQUIRE( absl::c_equal(cached.getFloatBuffer().getConstSpan(channel), decodedSpan) );
+            }
+        }
+    }
+
+    // A cache file with an unknown sample format is ignored and the file is decoded again
+    constexpr std::streamoff formatOffset { 50 };
+    for (auto& entry : fs::directory_iterator(cacheDirectory)) {
+        fs::fstream cacheStream { entry.path(), std::ios::binary | std::ios::in | std::ios::out };
+        const uint16_t badFormat { 0x7777 };
+        cacheStream.seekp(formatOffset);
+        cacheStream.write(reinterpret_cast<const char*>(&badFormat), sizeof(badFormat));
+    }
+    sfz::Synth corruptedSynth;
+    corruptedSynth.setCacheDirectory(cacheDirectory);
+    corruptedSynth.setPreloadSize(500);
+    corruptedSynth.loadSfzFile(sfzFile);
+    REQUIRE( corruptedSynth.getNumRegions() == 2 );
+    for (int regionIndex = 0; regionIndex < 2; ++regionIndex) {
+        const auto& decoded = *decodingSynth.getRegionView(regionIndex)->sampleHandle->preloadedData;
+        const auto& reloaded = *corruptedSynth.getRegionView(regionIndex)->sampleHandle->preloadedData;
+        REQUIRE( reloaded.getNumFrames() == 500 );
+        REQUIRE( reloaded.getFormat() == decoded.getFormat() );
+    }
+
+    // A larger preload decodes the file again and refreshes the cache
+    sfz::Synth largerSynth;
+    largerSynth.setCacheDirectory(cacheDirectory);
+    largerSynth.setPreloadSize(2000);
+    largerSynth.loadSfzFile(sfzFile);
+    REQUIRE( largerSynth.getRegionView(0)->sampleHandle->preloadedData->getNumFrames() == 2000 );
+    fs::remove_all(cacheDirectory);
+}
+
+TEST_CASE("[Files] Retired buffers are freed by the garbage thread")
+{
+    sfz::FilePool filePool;
+    auto buffer = std::make_shared<sfz::SampleBuffer>(sfz::SampleBuffer::Format::int16, 2, 4096);
+    std::weak_ptr<sfz::SampleBuffer> observer { buffer };
+    filePool.retire(std::move(buffer));
+    REQUIRE( buffer == nullptr );
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (!observer.expired() && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    REQUIRE( observer.expired() );
+}
+
+TEST_CASE("[Files] Retiring more buffers than the queue holds")
+{
+    sfz::FilePool filePool;
+    std::vector<std::weak_ptr<sfz::SampleBuffer>> observers;
+    for (int i = 0; i < sfz::config::retireQueueSize + sfz::config::retireFallbackSize / 2; ++i) {
+        auto buffer = std::make_shared<sfz::SampleBuffer>(sfz::SampleBuffer::Format::int16, 1, 16);
+        observers.emplace_back(buffer);
+        filePool.retire(std::move(buffer));
+        REQUIRE( buffer == nullptr );
+    }
+
+    // The buffers left over are handed to the garbage thread with the next updates
+    const auto allExpired = [&]() {
+        return std::all_of(observers.begin(), observers.end(), [](const std::weak_ptr<sfz::SampleBuffer>& observer) { return observer.expired(); });
+    };
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (!allExpired() && std::chrono::steady_clock::now() < deadline) {
+        filePool.applyPreloadUpdates({});
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    REQUIRE( allExpired() );
+}
+
+TEST_CASE("[Files] Streamed file data is handed over to the voices")
+{
+    constexpr int blockSize { 256 };
+    constexpr int numBlocks { 20 };
+    const auto sfzFile = fs::current_path() / "tests/TestFiles/channels.sfz";
+    auto render = [&](sfz::Synth& synth) {
+        synth.setSamplesPerBlock(blockSize);
+        synth.loadSfzFile(sfzFile);
+        synth.noteOn(0, 1, 60, 127);
+        sfz::AudioBuffer<float> block { 2, blockSize };
+        std::vector<float> output;
+        for (int i = 0; i < numBlocks; ++i) {
+            synth.renderBlock(block);
+            output.insert(output.end(), block.getSpan(0).begin(), block.getSpan(0).end());
+            // Leave the loader some time to stream the file
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        return output;
+    };
+
+    sfz::Synth preloadedSynth;
+    preloadedSynth.setPreloadSize(0);
+    const auto preloadedOutput = render(preloadedSynth);
+
+    sfz::Synth streamingSynth;
+    streamingSynth.setPreloadSize(blockSize);
+    const auto streamedOutput = render(streamingSynth);
+    // The second time around the loader reads from the file it kept open
+    const auto restreamedOutput = render(streamingSynth);
+
+    REQUIRE( streamedOutput == preloadedOutput );
+    REQUIRE( restreamedOutput == preloadedOutput );
+    REQUIRE( absl::c_any_of(streamedOutput, [](float x) { return x != 0.0f; }) );
+}
+
+TEST_CASE("[Files] Sample quality")
+{
+    constexpr int blockSize { 256 };
+    constexpr int numBlocks { 8 };
+    auto render = [&](int quality) {
+        sfz::Synth synth;
+        synth.setSamplesPerBlock(blockSize);
+        synth.setPreloadSize(0);
+        synth.setSampleQuality(quality);
+        synth.loadSfzFile(fs::current_path() / "tests/TestFiles/channels.sfz");
+        synth.noteOn(0, 1, 60, 127);
+        sfz::AudioBuffer<float> block { 2, blockSize };
+        std::vector<float> output;
+        for (int i = 0; i < numBlocks; ++i) {
+            synth.renderBlock(block);
+            output.insert(output.end(), block.getSpan(0).begin(), block.getSpan(0).end());
+        }
+        return output;
+    };
+    auto energy = [](const std::vector<float>& output) {
+        return std::accumulate(output.begin(), output.end(), 0.0, [](double sum, float x) { return sum + x * x; });
+    };
+
+    const auto linear = render(1);
+    const auto hermite = render(2);
+    const auto sinc = render(3);
+    REQUIRE( absl::c_any_of(linear, [](float x) { return x != 0.0f; }) );
+    // The file is resampled to the synth rate; all the kernels keep the level of the sample
+    REQUIRE( hermite != linear );
+    REQUIRE( sinc != linear );
+    REQUIRE( energy(hermite) == Approx(energy(linear)).epsilon(0.05) );
+    REQUIRE( energy(sinc) == Approx(energy(linear)).epsilon(0.05) );
+}
+
+TEST_CASE("[Files] Loading queue overflow policies")
+{
+    sfz::Synth synth;
+    synth.loadSfzFile(fs::current_path() / "tests/TestFiles/channels.sfz");
+    REQUIRE( synth.getLoadingStats().capacity >= sfz::config::loadingQueueSize );
+    synth.setLoadingQueueCapacity(1);
+    synth.setLoadingOverflowPolicy(sfz::FilePool::OverflowPolicy::grow);
+    REQUIRE( synth.getLoadingStats().capacity == 1 );
+
+    for (int i = 0; i < 16; ++i)
+        synth.noteOn(0, 1, 60, 127);
+    auto stats = synth.getLoadingStats();
+    REQUIRE( stats.numDropped == 0 );
+    REQUIRE( stats.highWaterMark >= 1 );
+
+    synth.resetLoadingStats();
+    stats = synth.getLoadingStats();
+    REQUIRE( stats.highWaterMark == 0 );
+    REQUIRE( stats.numGrown == 0 );
+    REQUIRE( stats.capacity == 1 );
+
+    // The queue rounds the capacity up to fit its blocks, and the statistics report what it holds
+    synth.setLoadingQueueCapacity(4);
+    REQUIRE( synth.getLoadingStats().capacity > 4 );
+}
+
+TEST_CASE("[Files] Cache entries are checked against the file path")
+{
+    const auto directory = fs::temp_directory_path() / "sfizz_cache_path_test";
+    const auto cacheDirectory = directory / "cache";
+    fs::remove_all(directory);
+    fs::create_directories(directory);
+    // Two files with the same size and modification time, but different samples
+    fs::copy_file(fs::current_path() / "tests/TestFiles/mono_sample.wav", directory / "first.wav");
+    fs::copy_file(fs::current_path() / "tests/TestFiles/mono_sample.wav", directory / "second.wav");
+    {
+        fs::fstream wavStream { directory / "second.wav", std::ios::binary | std::ios::in | std::ios::out };
+        const std::array<char, 64> changedSamples { 0x11, 0x22, 0x33, 0x44 };
+        wavStream.seekp(5000);
+        wavStream.write(changedSamples.data(), changedSamples.size());
+    }
+    fs::last_write_time(directory / "second.wav", fs::last_write_time(directory / "first.wav"));
+    for (auto name : { "first", "second" }) {
+        fs::ofstream sfzStream { directory / (std::string(name) + ".sfz") };
+        sfzStream << "<region> sample=" << name << ".wav" << '\n';
+    }
+
+    auto loadWithCache = [&](sfz::Synth& synth, const char* sfzName) {
+        synth.setCacheDirectory(cacheDirectory);
+        synth.setPreloadSize(1000);
+        synth.loadSfzFile(directory / sfzName);
+        REQUIRE( synth.getNumRegions() == 1 );
+        return synth.getRegionView(0)->sampleHandle->preloadedData->getInt16Buffer().getConstSpan(0);
+    };
+    sfz::Synth firstSynth;
+    const auto firstSamples = loadWithCache(firstSynth, "first.sfz");
+    const auto firstEntry = fs::directory_iterator(cacheDirectory)->path();
+    sfz::Synth secondSynth;
+    const auto secondSamples = loadWithCache(secondSynth, "second.sfz");
+    REQUIRE( !absl::c_equal(firstSamples, secondSamples) );
+
+    // The entry of the first file stands in for the second one, as if their paths hashed the same
+    for (auto& entry : fs::directory_iterator(cacheDirectory)) {
+        if (entry.path() != firstEntry)
+            fs::copy_file(firstEntry, entry.path(), fs::copy_options::overwrite_existing);
+    }
+    sfz::Synth cachedSynth;
+    const auto cachedSamples = loadWithCache(cachedSynth, "second.sfz");
+    REQUIRE( absl::c_equal(cachedSamples, secondSamples) );
+    fs::remove_all(directory);
+}
+
+TEST_CASE("[Files] Unreadable files are reported and never grow the preload")
+{
+    const auto directory = fs::temp_directory_path() / "sfizz_unreadable_file_test";
+    fs::remove_all(directory);
+    fs::create_directories(directory);
+    fs::copy_file(fs::current_path() / "tests/TestFiles/mono_sample.wav", directory / "mono_sample.wav");
+    {
+        fs::ofstream sfzStream { directory / "unreadable.sfz" };
+        sfzStream << "<region> key=60 sample=mono_sample.wav" << '\n';
+    }
+
+    sfz::Synth synth;
+    synth.setSamplesPerBlock(256);
+    synth.setPreloadSize(256);
+    synth.loadSfzFile(directory / "unreadable.sfz");
+    REQUIRE( synth.getNumRegions() == 1 );
+    const auto preloadedFrames = synth.getRegionView(0)->sampleHandle->preloadedData->getNumFrames();
+    fs::remove(directory / "mono_sample.wav");
+    synth.noteOn(0, 1, 60, 127);
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (synth.getLoadingStats().numFailed == 0 && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    REQUIRE( synth.getLoadingStats().numFailed == 1 );
+
+    sfz::AudioBuffer<float> block { 2, 256 };
+    synth.renderBlock(block);
+    REQUIRE( synth.getRegionView(0)->sampleHandle->preloadedData->getNumFrames() == preloadedFrames );
+    fs::remove_all(directory);
+}
+
+TEST_CASE("[Files] Voices streaming the same file get the same data")
+{
+    constexpr int blockSize { 256 };
+    constexpr int numBlocks { 20 };
+    constexpr int numNotes { 8 };
+    const auto sfzFile = fs::current_path() / "tests/TestFiles/channels.sfz";
+    auto render = [&](sfz::Synth& synth) {
+        synth.setSamplesPerBlock(blockSize);
+        synth.loadSfzFile(sfzFile);
+        for (int i = 0; i < numNotes; ++i)
+            synth.noteOn(0, 1, 60, 127);
+        sfz::AudioBuffer<float> block { 2, blockSize };
+        std::vector<float> output;
+        for (int i = 0; i < numBlocks; ++i) {
+            synth.renderBlock(block);
+            output.insert(output.end(), block.getSpan(0).begin(), block.getSpan(0).end());
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        return output;
+    };
+
+    sfz::Synth preloadedSynth;
+    preloadedSynth.setPreloadSize(0);
+    const auto preloadedOutput = render(preloadedSynth);
+
+    sfz::Synth streamingSynth;
+    streamingSynth.setPreloadSize(blockSize);
+    const auto streamedOutput = render(streamingSynth);
+
+    REQUIRE( streamedOutput == preloadedOutput );
+    REQUIRE( streamingSynth.getLoadingStats().numDropped == 0 );
+}
+
+TEST_CASE("[Files] Reused file handles read after the preload")
+{
+    constexpr int blockSize { 256 };
+    constexpr int numBlocks { 20 };
+    const auto sfzFile = fs::current_path() / "tests/TestFiles/channels.sfz";
+    // The second note reads the file again through the handle left open by the first one
+    auto render = [&](sfz::Synth& synth) {
+        synth.setSamplesPerBlock(blockSize);
+        synth.loadSfzFile(sfzFile);
+        sfz::AudioBuffer<float> block { 2, blockSize };
+        std::vector<float> output;
+        for (int i = 0; i < numBlocks; ++i) {
+            if (i == 0 || i == numBlocks / 2)
+                synth.noteOn(0, 1, 60, 127);
+            synth.renderBlock(block);
+            output.insert(output.end(), block.getSpan(0).begin(), block.getSpan(0).end());
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        return output;
+    };
+
+    sfz::Synth preloadedSynth;
+    preloadedSynth.setPreloadSize(0);
+    const auto preloadedOutput = render(preloadedSynth);
+
+    sfz::Synth streamingSynth;
+    streamingSynth.setPreloadSize(blockSize);
+    const auto streamedOutput = render(streamingSynth);
+
+    REQUIRE( streamedOutput == preloadedOutput );
+    REQUIRE( streamingSynth.getLoadingStats().numFailed == 0 );
+}
+
+TEST_CASE("[Files] Preloads are shrunk to fit the memory budget")
+{
+    sfz::Synth synth;
+    synth.setSamplesPerBlock(256);
+    synth.setPreloadSize(0);
+    // A budget set before loading keeps the preloads out of the slabs, so that they can be shrunk
+    synth.setMemoryBudget(std::numeric_limits<size_t>::max());
+    synth.loadSfzFile(fs::current_path() / "tests/TestFiles/channels.sfz");
+    REQUIRE( synth.getNumRegions() == 2 );
+    const auto fullSize = synth.getMemoryStats().preloadedBytes;
+    REQUIRE( fullSize == synth.getPreloadedBytes() );
+    REQUIRE( synth.getMemoryStats().numEvictions == 0 );
+
+    synth.setMemoryBudget(1);
+    sfz::AudioBuffer<float> block { 2, 256 };
+    for (int i = 0; i < 100 && synth.getMemoryStats().numEvictions < 2; ++i) {
+        synth.renderBlock(block);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    const auto stats = synth.getMemoryStats();
+    REQUIRE( stats.budget == 1 );
+    REQUIRE( stats.numEvictions == 2 );
+    REQUIRE( stats.preloadedBytes == fullSize - stats.evictedBytes );
+    for (int i = 0; i < synth.getNumRegions(); ++i)
+        REQUIRE( synth.getRegionView(i)->sampleHandle->preloadedData->getNumFrames() == sfz::config::evictedPreloadSize );
+}
+
+TEST_CASE("[Files] The least played preloads are shrunk first")
+{
+    sfz::Synth synth;
+    synth.setSamplesPerBlock(256);
+    synth.setPreloadSize(0);
+    synth.setMemoryBudget(std::numeric_limits<size_t>::max());
+    synth.loadSfzFile(fs::current_path() / "tests/TestFiles/channels.sfz");
+    const auto fullSize = synth.getMemoryStats().preloadedBytes;
+
+    sfz::AudioBuffer<float> block { 2, 256 };
+    synth.noteOn(0, 1, 61, 127);
+    for (int i = 0; i < 100 && synth.getMemoryStats().streamingBytes == 0; ++i) {
+        synth.renderBlock(block);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    synth.noteOff(0, 1, 61, 0);
+    for (int i = 0; i < 100 && synth.getMemoryStats().streamingBytes > 0; ++i) {
+        synth.renderBlock(block);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    REQUIRE( synth.getMemoryStats().streamingBytes == 0 );
+
+    synth.setMemoryBudget(fullSize - 1);
+    for (int i = 0; i < 100 && synth.getMemoryStats().numEvictions < 1; ++i) {
+        synth.renderBlock(block);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    REQUIRE( synth.getMemoryStats().numEvictions == 1 );
+    REQUIRE( synth.getRegionView(0)->sampleHandle->preloadedData->getNumFrames() == sfz::config::evictedPreloadSize );
+    REQUIRE( synth.getRegionView(1)->sampleHandle->preloadedData->getNumFrames() == synth.getRegionView(1)->sampleEnd );
+}
+
+TEST_CASE("[Files] Lazy preloading of keyswitched regions")
+{
+    sfz::Synth synth;
+    synth.setSamplesPerBlock(256);
+    synth.setPreloadSize(20000);
+    synth.setLazyKeyswitchPreload(true);
+    synth.loadSfzFile(fs::current_path() / "tests/TestFiles/keyswitches.sfz");
+    REQUIRE( synth.getNumRegions() == 4 );
+    auto numPreloadedFrames = [&](int regionIndex) {
+        return synth.getRegionView(regionIndex)->sampleHandle->preloadedData->getNumFrames();
+    };
+    // Only the sw_default articulation is fully preloaded
+    REQUIRE( numPreloadedFrames(0) == 20000 );
+    REQUIRE( numPreloadedFrames(1) == sfz::config::deferredPreloadSize );
+    REQUIRE( numPreloadedFrames(2) == sfz::config::deferredPreloadSize );
+    REQUIRE( numPreloadedFrames(3) == sfz::config::deferredPreloadSize );
+
+    // Selecting an articulation preloads it along with its neighbours
+    synth.noteOn(0, 1, 38, 127);
+    sfz::AudioBuffer<float> block { 2, 256 };
+    for (int i = 0; i < 100 && (numPreloadedFrames(1) < 20000 || numPreloadedFrames(2) < 20000); ++i) {
+        synth.renderBlock(block);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    REQUIRE( numPreloadedFrames(1) == 20000 );
+    REQUIRE( numPreloadedFrames(2) == 20000 );
+    REQUIRE( numPreloadedFrames(3) == sfz::config::deferredPreloadSize );
+    REQUIRE( synth.getPreloadedBytes() == synth.getMemoryStats().preloadedBytes );
+    size_t expectedBytes { 0 };
+    for (int i = 0; i < synth.getNumRegions(); ++i)
+        expectedBytes += synth.getRegionView(i)->sampleHandle->preloadedData->getNumBytes();
+    REQUIRE( synth.getPreloadedBytes() == expectedBytes );
+}
+
+TEST_CASE("[Files] Lazy preloading keeps regions gated by other switches")
+{
+    sfz::Synth synth;
+    synth.setPreloadSize(20000);
+    synth.setLazyKeyswitchPreload(true);
+    synth.loadSfzFile(fs::current_path() / "tests/TestFiles/keyswitches_gated.sfz");
+    REQUIRE( synth.getNumRegions() == 4 );
+    // sw_down and sw_previous depend on the keyboard state, so these regions stay preloaded
+    REQUIRE( synth.getRegionView(0)->sampleHandle->preloadedData->getNumFrames() == 20000 );
+    REQUIRE( synth.getRegionView(1)->sampleHandle->preloadedData->getNumFrames() == sfz::config::deferredPreloadSize );
+    REQUIRE( synth.getRegionView(2)->sampleHandle->preloadedData->getNumFrames() == 20000 );
+    REQUIRE( synth.getRegionView(3)->sampleHandle->preloadedData->getNumFrames() == 20000 );
+}
+
+TEST_CASE("[Files] Keyswitched regions are preloaded eagerly by default")
+{
+    sfz::Synth synth;
+    synth.setPreloadSize(20000);
+    synth.loadSfzFile(fs::current_path() / "tests/TestFiles/keyswitches.sfz");
+    REQUIRE( synth.getNumRegions() == 4 );
+    for (int i = 0; i < synth.getNumRegions(); ++i)
+        REQUIRE( synth.getRegionView(i)->sampleHandle->preloadedData->getNumFrames() == 20000 );
+}
+
+TEST_CASE("[Files] Release and round robin regions are prefetched")
+{
+    sfz::Synth synth;
+    synth.setSamplesPerBlock(256);
+    synth.setPreloadSize(1024);
+    synth.loadSfzFile(fs::current_path() / "tests/TestFiles/prefetch.sfz");
+    REQUIRE( synth.getNumRegions() == 4 );
+    auto isWarm = [&](int regionIndex) {
+        const auto region = synth.getRegionView(regionIndex);
+        return region->sampleHandle->preloadedData->getNumFrames() == region->trueSampleEnd();
+    };
+    auto renderUntil = [&](auto condition) {
+        sfz::AudioBuffer<float> block { 2, 256 };
+        for (int i = 0; i < 100 && !condition(); ++i) {
+            synth.renderBlock(block);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    };
+    for (int i = 0; i < synth.getNumRegions(); ++i)
+        REQUIRE( !isWarm(i) );
+
+    synth.noteOn(0, 1, 60, 127);
+    renderUntil([&]() { return isWarm(1); });
+    REQUIRE( !isWarm(0) );
+    REQUIRE( isWarm(1) );
+
+    // The next step of the sequence is warmed, and then the one after
+    synth.noteOn(0, 1, 62, 127);
+    renderUntil([&]() { return isWarm(2) || isWarm(3); });
+    REQUIRE( isWarm(2) != isWarm(3) );
+    synth.noteOn(0, 1, 62, 127);
+    renderUntil([&]() { return isWarm(2) && isWarm(3); });
+    REQUIRE( isWarm(2) );
+    REQUIRE( isWarm(3) );
+}
+
+TEST_CASE("[Files] Prefetching stays within the memory budget")
+{
+    sfz::Synth synth;
+    synth.setSamplesPerBlock(256);
+    synth.setPreloadSize(1024);
+    synth.loadSfzFile(fs::current_path() / "tests/TestFiles/prefetch.sfz");
+    const auto preloadedBytes = synth.getMemoryStats().preloadedBytes;
+    synth.setMemoryBudget(preloadedBytes + 1);
+
+    synth.noteOn(0, 1, 60, 127);
+    sfz::AudioBuffer<float> block { 2, 256 };
+    for (int i = 0; i < 20; ++i) {
+        synth.renderBlock(block);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    REQUIRE( synth.getRegionView(1)->sampleHandle->preloadedData->getNumFrames() == 1024 );
+    REQUIRE( synth.getMemoryStats().preloadedBytes == preloadedBytes );
+}
+
+TEST_CASE("[Files] Prefetch requests never take the place of a voice")
+{
+    sfz::Synth synth;
+    synth.setSamplesPerBlock(256);
+    synth.setPreloadSize(1024);
+    synth.loadSfzFile(fs::current_path() / "tests/TestFiles/prefetch.sfz");
+    synth.setLoadingQueueCapacity(2);
+    synth.setLoadingOverflowPolicy(sfz::FilePool::OverflowPolicy::drop);
+
+    // The first note also prefetches its release region, which leaves the room for the second voice
+    synth.noteOn(0, 1, 60, 127);
+    synth.noteOn(0, 1, 62, 127);
+    REQUIRE( synth.getLoadingStats().numDropped == 0 );
+
+    const auto release = synth.getRegionView(1);
+    sfz::AudioBuffer<float> block { 2, 256 };
+    for (int i = 0; i < 100 && release->sampleHandle->preloadedData->getNumFrames() < release->trueSampleEnd(); ++i) {
+        synth.renderBlock(block);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    REQUIRE( release->sampleHandle->preloadedData->getNumFrames() == release->trueSampleEnd() );
+}
+
+TEST_CASE("[Files] Stereo files are deinterleaved across chunks")
+{
+    sfz::Synth synth;
+    synth.setPreloadSize(0);
+    synth.loadSfzFile(fs::current_path() / "tests/TestFiles/channels.sfz");
+    REQUIRE( synth.getNumRegions() == 2 );
+    const auto& preload = *synth.getRegionView(1)->sampleHandle->preloadedData;
+    REQUIRE( preload.getNumChannels() == 2 );
+    REQUIRE( preload.getNumFrames() > 2 * sfz::config::fileChunkSize );
+
+    const auto file = fs::current_path() / "tests/TestFiles/stereo_sample.wav";
+    SndfileHandle sndFile(reinterpret_cast<const char*>(file.c_str()));
+    std::vector<float> interleaved(2 * preload.getNumFrames());
+    REQUIRE( sndFile.readf(interleaved.data(), preload.getNumFrames()) == static_cast<sf_count_t>(preload.getNumFrames()) );
+    const auto left = preload.getFloatBuffer().getConstSpan(0);
+    const auto right = preload.getFloatBuffer().getConstSpan(1);
+    bool identical { true };
+    for (size_t frame = 0; frame < preload.getNumFrames(); ++frame)
+        identical &= left[frame] == interleaved[2 * frame] && right[frame] == interleaved[2 * frame + 1];
+    REQUIRE( identical );
+}
+
+TEST_CASE("[Files] Locked sample memory")
+{
+    const auto lockedBefore = sfz::SampleBuffer::getTotalLockedBytes();
+    {
+        sfz::SampleBuffer buffer { sfz::SampleBuffer::Format::float32, 2, 4096, sfz::SampleBuffer::Locking::locked };
+        // The system may refuse to lock anything past its limit
+        REQUIRE( (buffer.getLockedBytes() == 0 || buffer.getLockedBytes() == buffer.getStorageBytes()) );
+        REQUIRE( sfz::SampleBuffer::getTotalLockedBytes() == lockedBefore + buffer.getLockedBytes() );
+    }
+    REQUIRE( sfz::SampleBuffer::getTotalLockedBytes() == lockedBefore );
+
+    {
+        sfz::Synth synth;
+        synth.setPreloadSize(0);
+        synth.setMemoryLocking(sfz::SampleBuffer::Locking::lockedHugePages);
+        synth.loadSfzFile(fs::current_path() / "tests/TestFiles/channels.sfz");
+        REQUIRE( synth.getNumRegions() == 2 );
+        size_t regionLockedBytes { 0 };
+        for (int i = 0; i < synth.getNumRegions(); ++i)
+            regionLockedBytes += synth.getRegionView(i)->sampleHandle->preloadedData->getLockedBytes();
+        REQUIRE( synth.getMemoryStats().lockedBytes == lockedBefore + regionLockedBytes );
+    }
+    REQUIRE( sfz::SampleBuffer::getTotalLockedBytes() == lockedBefore );
+}
@@ -156,4 +156,19 @@ TEST_CASE("[LinearEnvelope] 2 events, function")
     std::array<float, 8> expected { 1, 2, 2.5, 3, 3.5, 4.0, 4.0, 4.0 };
     envelope.getBlock(absl::MakeSpan(output));
     REQUIRE(output == expected);
-}
\ No newline at end of file
+}
+
+TEST_CASE("[LinearEnvelope] Constant blocks")
+{
+    sfz::LinearEnvelope<float> envelope;
+    std::array<float, 8> output;
+    REQUIRE(envelope.getBlock(absl::MakeSpan(output)));
+    // An event at the start of the block changes the value at once
+    envelope.registerEvent(0, 1.0);
+    REQUIRE(envelope.getBlock(absl::MakeSpan(output)));
+    REQUIRE(absl::c_all_of(output, [](float x) { return x == 1.0f; }));
+    envelope.registerEvent(4, 2.0);
+    REQUIRE(!envelope.getBlock(absl::MakeSpan(output)));
+    REQUIRE(envelope.getBlock(absl::MakeSpan(output)));
+    REQUIRE(absl::c_all_of(output, [](float x) { return x == 2.0f; }));
+}
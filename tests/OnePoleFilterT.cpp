@@ -27,7 +27,9 @@
 #include "../sfizz/ghc/fs_std.hpp"
 #include <absl/types/span.h>
 #include <algorithm>
+#include <cmath>
 #include <string>
+#include <vector>
 using namespace Catch::literals;
 
 template <class Type>
@@ -210,3 +212,57 @@ TEST_CASE("[OnePoleFilter] Highpass Double")
         fs::current_path() / "tests/TestFiles/OnePoleFilter/OPF_high_gain_0.9.npy",
         0.9f);
 }
+
+template <class Type>
+void testLanes(bool highpass)
+{
+    // More filters than SIMD lanes, with blocks not a multiple of the SIMD width
+    constexpr int numFilters { 11 };
+    constexpr int blockSize { 37 };
+    std::vector<sfz::OnePoleFilter<Type>> singleFilters;
+    std::vector<sfz::OnePoleFilter<Type>> laneFilters;
+    std::vector<std::vector<Type>> inputs(numFilters, std::vector<Type>(blockSize));
+    std::vector<std::vector<Type>> expected(numFilters, std::vector<Type>(blockSize));
+    std::vector<std::vector<Type>> outputs(numFilters, std::vector<Type>(blockSize));
+    for (int i = 0; i < numFilters; ++i) {
+        singleFilters.emplace_back(static_cast<Type>(0.05 + 0.08 * i));
+        laneFilters.emplace_back(static_cast<Type>(0.05 + 0.08 * i));
+    }
+
+    std::vector<sfz::OnePoleFilter<Type>*> filterPointers;
+    std::vector<absl::Span<const Type>> inputSpans;
+    std::vector<absl::Span<Type>> outputSpans;
+    for (int i = 0; i < numFilters; ++i) {
+        filterPointers.push_back(&laneFilters[i]);
+        inputSpans.push_back(absl::MakeConstSpan(inputs[i]));
+        outputSpans.push_back(absl::MakeSpan(outputs[i]));
+    }
+
+    // The states carry over to the next blocks
+    for (int block = 0; block < 3; ++block) {
+        for (int i = 0; i < numFilters; ++i) {
+            for (int j = 0; j < blockSize; ++j)
+                inputs[i][j] = static_cast<Type>(std::sin(0.3 * (i + 1) * (block * blockSize + j)));
+            if (highpass)
+                singleFilters[i].processHighpass(inputs[i], absl::MakeSpan(expected[i]));
+            else
+                singleFilters[i].processLowpass(inputs[i], absl::MakeSpan(expected[i]));
+        }
+
+        if (highpass)
+            sfz::OnePoleFilter<Type>::processHighpassLanes(filterPointers, inputSpans, outputSpans);
+        else
+            sfz::OnePoleFilter<Type>::processLowpassLanes(filterPointers, inputSpans, outputSpans);
+
+        for (int i = 0; i < numFilters; ++i)
+            REQUIRE(approxEqual(outputs[i], expected[i]));
+    }
+}
+
+TEST_CASE("[OnePoleFilter] Lanes match the single filters")
+{
+    testLanes<float>(false);
+    testLanes<float>(true);
+    testLanes<double>(false);
+    testLanes<double>(true);
+}
@@ -287,4 +287,24 @@ TEST_CASE("Region activation", "Region tests")
         region.registerNoteOff(1, 40, 0, 0.5f);
         REQUIRE(region.isSwitchedOn());
     }
+    SECTION("Sequences: next step")
+    {
+        region.parseOpcode({ "seq_length", "3" });
+        region.parseOpcode({ "seq_position", "2" });
+        region.parseOpcode({ "key", "40" });
+        REQUIRE(region.isNextInSequence());
+        region.registerNoteOn(1, 40, 64, 0.5f);
+        REQUIRE(!region.isNextInSequence());
+        region.registerNoteOn(1, 40, 64, 0.5f);
+        REQUIRE(!region.isNextInSequence());
+        region.registerNoteOn(1, 40, 64, 0.5f);
+        REQUIRE(region.isNextInSequence());
+    }
+    SECTION("Sequences: no sequence")
+    {
+        region.parseOpcode({ "key", "40" });
+        REQUIRE(!region.isNextInSequence());
+        region.registerNoteOn(1, 40, 64, 0.5f);
+        REQUIRE(!region.isNextInSequence());
+    }
 }
@@ -97,6 +97,29 @@ TEST_CASE("[Region] Parsing opcodes")
         REQUIRE(*region.sampleCount == 0);
     }
 
+    SECTION("preload_size")
+    {
+        REQUIRE(!region.preloadSize);
+        region.parseOpcode({ "preload_size", "4096" });
+        REQUIRE(region.preloadSize);
+        REQUIRE(*region.preloadSize == 4096);
+        region.parseOpcode({ "preload_size", "-1" });
+        REQUIRE(region.preloadSize);
+        REQUIRE(*region.preloadSize == 0);
+    }
+
+    SECTION("sample_quality")
+    {
+        REQUIRE(!region.sampleQuality);
+        region.parseOpcode({ "sample_quality", "3" });
+        REQUIRE(region.sampleQuality);
+        REQUIRE(*region.sampleQuality == 3);
+        region.parseOpcode({ "sample_quality", "-1" });
+        REQUIRE(*region.sampleQuality == 0);
+        region.parseOpcode({ "sample_quality", "12" });
+        REQUIRE(*region.sampleQuality == 10);
+    }
+
     SECTION("loop_mode")
     {
         REQUIRE(region.loopMode == SfzLoopMode::no_loop);
@@ -1045,4 +1068,56 @@ TEST_CASE("[Region] Non-conforming floating point values in integer opcodes")
     REQUIRE(region.offset == 2014);
     region.parseOpcode({ "pitch_keytrack", "-2.1" });
     REQUIRE(region.pitchKeytrack == -2);
-}
\ No newline at end of file
+}
+
+TEST_CASE("[Region] Maximum pitch ratio")
+{
+    sfz::MidiState midiState;
+    sfz::Region region { midiState };
+    region.parseOpcode({ "key", "60" });
+    REQUIRE(region.getMaxPitchRatio() == 1.0_a);
+    region.parseOpcode({ "hikey", "72" });
+    REQUIRE(region.getMaxPitchRatio() == 2.0_a);
+    region.parseOpcode({ "transpose", "12" });
+    REQUIRE(region.getMaxPitchRatio() == 4.0_a);
+    region.parseOpcode({ "pitch_keytrack", "-100" });
+    REQUIRE(region.getMaxPitchRatio() == 2.0_a);
+}
+
+TEST_CASE("[Region] True sample end")
+{
+    sfz::MidiState midiState;
+    sfz::Region region { midiState };
+    region.parseOpcode({ "end", "1000" });
+    REQUIRE(region.trueSampleEnd() == 1000);
+    region.parseOpcode({ "loop_end", "500" });
+    REQUIRE(region.trueSampleEnd() == 500);
+    region.parseOpcode({ "loop_mode", "no_loop" });
+    REQUIRE(region.trueSampleEnd() == 500);
+    region.parseOpcode({ "loop_mode", "one_shot" });
+    REQUIRE(region.trueSampleEnd() == 500);
+    region.parseOpcode({ "loop_mode", "loop_continuous" });
+    REQUIRE(region.trueSampleEnd() == 500);
+    // Released sustain loops play past the loop end
+    region.parseOpcode({ "loop_mode", "loop_sustain" });
+    REQUIRE(region.trueSampleEnd() == 1000);
+}
+
+TEST_CASE("[Region] Preloaded data covering the true sample end")
+{
+    sfz::MidiState midiState;
+    sfz::Region region { midiState };
+    region.parseOpcode({ "end", "1000" });
+    region.parseOpcode({ "loop_end", "500" });
+    region.sampleHandle = std::make_shared<sfz::SampleHandle>();
+    region.sampleHandle->preloadedData = std::make_shared<sfz::SampleBuffer>(sfz::SampleBuffer::Format::int16, 1, 800);
+    REQUIRE(region.canUsePreloadedData());
+    region.parseOpcode({ "loop_mode", "no_loop" });
+    REQUIRE(region.canUsePreloadedData());
+    region.parseOpcode({ "loop_mode", "one_shot" });
+    REQUIRE(region.canUsePreloadedData());
+    region.parseOpcode({ "loop_mode", "loop_continuous" });
+    REQUIRE(region.canUsePreloadedData());
+    region.parseOpcode({ "loop_mode", "loop_sustain" });
+    REQUIRE(!region.canUsePreloadedData());
+}
@@ -28,6 +28,7 @@
 #include <algorithm>
 #include <array>
 #include <iostream>
+#include <string>
 using namespace Catch::literals;
 
 constexpr int smallBufferSize { 3 };
@@ -591,6 +592,42 @@ TEST_CASE("[Helpers] Multiplicative Ramp unaligned (SIMD vs scalar)")
     REQUIRE(approxEqual<float>(outputScalar, outputSIMD));
 }
 
+TEST_CASE("[Helpers] One-pole lanes (SIMD vs scalar)")
+{
+    constexpr int numLanes { 7 };
+    constexpr int size { 37 };
+    std::array<float, numLanes> statesScalar;
+    std::array<float, numLanes> gains;
+    std::vector<std::vector<float>> inputs(numLanes, std::vector<float>(size));
+    std::vector<std::vector<float>> outputScalar(numLanes, std::vector<float>(size));
+    std::vector<std::vector<float>> outputSIMD(numLanes, std::vector<float>(size));
+    std::array<const float*, numLanes> inputPointers;
+    std::array<float*, numLanes> pointersScalar;
+    std::array<float*, numLanes> pointersSIMD;
+    for (int lane = 0; lane < numLanes; ++lane) {
+        statesScalar[lane] = 0.01f * static_cast<float>(lane);
+        gains[lane] = 0.05f + 0.1f * static_cast<float>(lane);
+        for (int i = 0; i < size; ++i)
+            inputs[lane][i] = std::sin(0.2f * static_cast<float>((lane + 1) * i));
+        inputPointers[lane] = inputs[lane].data();
+        pointersScalar[lane] = outputScalar[lane].data();
+        pointersSIMD[lane] = outputSIMD[lane].data();
+    }
+
+    auto statesSIMD = statesScalar;
+    sfz::onePoleLowpassLanes<float, false>(absl::MakeSpan(statesScalar), gains, inputPointers, pointersScalar, size);
+    sfz::onePoleLowpassLanes<float, true>(absl::MakeSpan(statesSIMD), gains, inputPointers, pointersSIMD, size);
+    REQUIRE(approxEqualMargin<float>(statesScalar, statesSIMD));
+    for (int lane = 0; lane < numLanes; ++lane)
+        REQUIRE(approxEqualMargin<float>(outputScalar[lane], outputSIMD[lane]));
+
+    sfz::onePoleHighpassLanes<float, false>(absl::MakeSpan(statesScalar), gains, inputPointers, pointersScalar, size);
+    sfz::onePoleHighpassLanes<float, true>(absl::MakeSpan(statesSIMD), gains, inputPointers, pointersSIMD, size);
+    REQUIRE(approxEqualMargin<float>(statesScalar, statesSIMD));
+    for (int lane = 0; lane < numLanes; ++lane)
+        REQUIRE(approxEqualMargin<float>(outputScalar[lane], outputSIMD[lane]));
+}
+
 TEST_CASE("[Helpers] Add")
 {
     std::array<float, 5> input { 1.0f, 2.0f, 3.0f, 4.0f, 5.0f };
@@ -772,4 +809,622 @@ TEST_CASE("[Helpers] Diff (SIMD vs Scalar)")
     sfz::diff<float, false>(input, absl::MakeSpan(outputScalar));
     sfz::diff<float, true>(input, absl::MakeSpan(outputSIMD));
     REQUIRE(approxEqual<float>(outputScalar, outputSIMD));
-}
\ No newline at end of file
+}
+
+TEST_CASE("[Helpers] int16 to float")
+{
+    std::array<int16_t, 6> input { 0, 1, -1, 32767, -32768, 1000 };
+    std::array<float, 6> expected { 0.0f, 1.0f, -1.0f, 32767.0f, -32768.0f, 1000.0f };
+    std::array<float, 6> output;
+    sfz::int16ToFloat<float, false>(input, absl::MakeSpan(output));
+    REQUIRE(output == expected);
+    absl::c_fill(output, 0.0f);
+    sfz::int16ToFloat<float, true>(input, absl::MakeSpan(output));
+    REQUIRE(output == expected);
+}
+
+TEST_CASE("[Helpers] int16 to float (SIMD vs Scalar)")
+{
+    std::vector<int16_t> input(bigBufferSize);
+    std::vector<float> outputScalar(bigBufferSize);
+    std::vector<float> outputSIMD(bigBufferSize);
+    absl::c_iota(input, static_cast<int16_t>(-bigBufferSize / 2));
+
+    sfz::int16ToFloat<float, false>(input, absl::MakeSpan(outputScalar));
+    sfz::int16ToFloat<float, true>(input, absl::MakeSpan(outputSIMD));
+    REQUIRE(outputScalar == outputSIMD);
+
+    // Unaligned input and output
+    sfz::int16ToFloat<float, false>(absl::MakeConstSpan(input).subspan(1, bigBufferSize - 3), absl::MakeSpan(outputScalar).subspan(3));
+    sfz::int16ToFloat<float, true>(absl::MakeConstSpan(input).subspan(1, bigBufferSize - 3), absl::MakeSpan(outputSIMD).subspan(3));
+    REQUIRE(outputScalar == outputSIMD);
+}
+
+TEST_CASE("[Helpers] Mix stereo")
+{
+    std::array<float, 5> left { 1.0f, 2.0f, 3.0f, 4.0f, 5.0f };
+    std::array<float, 5> right { 1.0f, 0.0f, -1.0f, 0.0f, 1.0f };
+    std::array<float, 5> expectedLeft { 1.5f, 2.0f, 2.5f, 4.0f, 5.5f };
+    std::array<float, 5> expectedRight { -0.75f, 0.5f, 1.75f, 1.0f, 0.25f };
+    sfz::mixStereo<float, false>(1.0f, 0.5f, 0.25f, -1.0f, absl::MakeSpan(left), absl::MakeSpan(right));
+    REQUIRE(approxEqual<float>(left, expectedLeft));
+    REQUIRE(approxEqual<float>(right, expectedRight));
+}
+
+TEST_CASE("[Helpers] Mix stereo (SIMD vs Scalar)")
+{
+    std::vector<float> leftScalar(bigBufferSize);
+    std::vector<float> rightScalar(bigBufferSize);
+    sfz::linearRamp<float>(absl::MakeSpan(leftScalar), 0.0f, 0.1f);
+    sfz::linearRamp<float>(absl::MakeSpan(rightScalar), 1.0f, -0.2f);
+    auto leftSIMD = leftScalar;
+    auto rightSIMD = rightScalar;
+    sfz::mixStereo<float, false>(0.3f, 0.7f, -0.2f, 1.1f, absl::MakeSpan(leftScalar), absl::MakeSpan(rightScalar));
+    sfz::mixStereo<float, true>(0.3f, 0.7f, -0.2f, 1.1f, absl::MakeSpan(leftSIMD), absl::MakeSpan(rightSIMD));
+    REQUIRE(approxEqual<float>(leftScalar, leftSIMD));
+    REQUIRE(approxEqual<float>(rightScalar, rightSIMD));
+
+    // Unaligned buffers
+    sfz::mixStereo<float, false>(0.3f, 0.7f, -0.2f, 1.1f, absl::MakeSpan(leftScalar).subspan(1), absl::MakeSpan(rightScalar).subspan(1));
+    sfz::mixStereo<float, true>(0.3f, 0.7f, -0.2f, 1.1f, absl::MakeSpan(leftSIMD).subspan(1), absl::MakeSpan(rightSIMD).subspan(1));
+    REQUIRE(approxEqual<float>(leftScalar, leftSIMD));
+    REQUIRE(approxEqual<float>(rightScalar, rightSIMD));
+}
+
+TEST_CASE("[Helpers] Pan")
+{
+    std::vector<float> pan { -1.0f, -0.5f, 0.0f, 0.3f, 1.0f };
+    std::vector<float> left(pan.size(), 1.0f);
+    std::vector<float> right(pan.size(), 1.0f);
+    std::vector<float> expectedLeft(pan.size());
+    std::vector<float> expectedRight(pan.size());
+    for (size_t i = 0; i < pan.size(); ++i) {
+        expectedLeft[i] = std::cos(piFour<float> * (1.0f + pan[i]));
+        expectedRight[i] = std::sin(piFour<float> * (1.0f + pan[i]));
+    }
+    sfz::tablePan<float, false>(pan, absl::MakeSpan(left), absl::MakeSpan(right));
+    REQUIRE(approxEqualMargin<float>(left, expectedLeft, 1e-6f));
+    REQUIRE(approxEqualMargin<float>(right, expectedRight, 1e-6f));
+}
+
+TEST_CASE("[Helpers] Pan, SIMD vs scalar")
+{
+    std::vector<float> pan(bigBufferSize);
+    std::vector<float> leftScalar(bigBufferSize);
+    std::vector<float> rightScalar(bigBufferSize);
+    std::vector<float> leftSIMD(bigBufferSize);
+    std::vector<float> rightSIMD(bigBufferSize);
+    sfz::linearRamp<float>(absl::MakeSpan(pan), -1.0f, 2.0f / bigBufferSize);
+    for (size_t i = 0; i < pan.size(); ++i) {
+        leftScalar[i] = std::sin(0.1f * static_cast<float>(i));
+        rightScalar[i] = std::cos(0.07f * static_cast<float>(i));
+    }
+    sfz::copy<float>(leftScalar, absl::MakeSpan(leftSIMD));
+    sfz::copy<float>(rightScalar, absl::MakeSpan(rightSIMD));
+    sfz::pan<float, false>(pan, absl::MakeSpan(leftScalar), absl::MakeSpan(rightScalar));
+    sfz::pan<float, true>(pan, absl::MakeSpan(leftSIMD), absl::MakeSpan(rightSIMD));
+    REQUIRE(approxEqualMargin<float>(leftScalar, leftSIMD));
+    REQUIRE(approxEqualMargin<float>(rightScalar, rightSIMD));
+}
+
+TEST_CASE("[Helpers] Table pan, SIMD vs scalar")
+{
+    std::vector<float> pan(bigBufferSize);
+    std::vector<float> leftScalar(bigBufferSize);
+    std::vector<float> rightScalar(bigBufferSize);
+    std::vector<float> leftSIMD(bigBufferSize);
+    std::vector<float> rightSIMD(bigBufferSize);
+    // Out of range pans are clamped
+    sfz::linearRamp<float>(absl::MakeSpan(pan), -1.2f, 2.4f / bigBufferSize);
+    for (size_t i = 0; i < pan.size(); ++i) {
+        leftScalar[i] = std::sin(0.1f * static_cast<float>(i));
+        rightScalar[i] = std::cos(0.07f * static_cast<float>(i));
+    }
+    sfz::copy<float>(leftScalar, absl::MakeSpan(leftSIMD));
+    sfz::copy<float>(rightScalar, absl::MakeSpan(rightSIMD));
+    sfz::tablePan<float, false>(pan, absl::MakeSpan(leftScalar), absl::MakeSpan(rightScalar));
+    sfz::tablePan<float, true>(pan, absl::MakeSpan(leftSIMD), absl::MakeSpan(rightSIMD));
+    REQUIRE(approxEqualMargin<float>(leftScalar, leftSIMD, 1e-6f));
+    REQUIRE(approxEqualMargin<float>(rightScalar, rightSIMD, 1e-6f));
+
+    // Unaligned envelope and buffers
+    sfz::tablePan<float, false>(absl::MakeConstSpan(pan).subspan(1), absl::MakeSpan(leftScalar).subspan(1), absl::MakeSpan(rightScalar).subspan(1));
+    sfz::tablePan<float, true>(absl::MakeConstSpan(pan).subspan(1), absl::MakeSpan(leftSIMD).subspan(1), absl::MakeSpan(rightSIMD).subspan(1));
+    REQUIRE(approxEqualMargin<float>(leftScalar, leftSIMD, 1e-6f));
+    REQUIRE(approxEqualMargin<float>(rightScalar, rightSIMD, 1e-6f));
+}
+
+TEST_CASE("[Helpers] Gain and pan matches the separate passes")
+{
+    std::vector<float> amplitude(bigBufferSize);
+    std::vector<float> eg(bigBufferSize);
+    std::vector<float> volume(bigBufferSize);
+    std::vector<float> pan(bigBufferSize);
+    std::vector<float> input(bigBufferSize);
+    std::vector<float> expectedLeft(bigBufferSize);
+    std::vector<float> expectedRight(bigBufferSize);
+    std::vector<float> left(bigBufferSize);
+    std::vector<float> right(bigBufferSize);
+    sfz::linearRamp<float>(absl::MakeSpan(amplitude), 0.5f, 0.0001f);
+    sfz::linearRamp<float>(absl::MakeSpan(eg), 1.0f, -0.0002f);
+    sfz::fill<float>(absl::MakeSpan(volume), 0.7f);
+    sfz::linearRamp<float>(absl::MakeSpan(pan), -1.0f, 2.0f / bigBufferSize);
+    for (size_t i = 0; i < input.size(); ++i)
+        input[i] = std::sin(0.1f * static_cast<float>(i));
+
+    sfz::copy<float>(input, absl::MakeSpan(expectedLeft));
+    sfz::applyGain<float>(amplitude, absl::MakeSpan(expectedLeft));
+    sfz::applyGain<float>(eg, absl::MakeSpan(expectedLeft));
+    sfz::applyGain<float>(volume, absl::MakeSpan(expectedLeft));
+    sfz::copy<float>(expectedLeft, absl::MakeSpan(expectedRight));
+    for (size_t i = 0; i < pan.size(); ++i) {
+        expectedLeft[i] *= std::cos(piFour<float> * (1.0f + pan[i]));
+        expectedRight[i] *= std::sin(piFour<float> * (1.0f + pan[i]));
+    }
+
+    sfz::copy<float>(input, absl::MakeSpan(left));
+    sfz::applyGainAndPan<float, false>(amplitude, eg, volume, pan, absl::MakeSpan(left), absl::MakeSpan(right));
+    // The pan law is read from a table so the gains near zero are only close in absolute terms
+    REQUIRE(approxEqualMargin<float>(left, expectedLeft, 1e-6f));
+    REQUIRE(approxEqualMargin<float>(right, expectedRight, 1e-6f));
+
+    sfz::copy<float>(input, absl::MakeSpan(left));
+    sfz::applyGainAndPan<float, true>(amplitude, eg, volume, pan, absl::MakeSpan(left), absl::MakeSpan(right));
+    REQUIRE(approxEqualMargin<float>(left, expectedLeft));
+    REQUIRE(approxEqualMargin<float>(right, expectedRight));
+
+    // Unaligned envelopes and buffers
+    sfz::copy<float>(input, absl::MakeSpan(left));
+    sfz::applyGainAndPan<float, true>(absl::MakeConstSpan(amplitude).subspan(1), absl::MakeConstSpan(eg).subspan(1), absl::MakeConstSpan(volume).subspan(1),
+        absl::MakeConstSpan(pan).subspan(1), absl::MakeSpan(left).subspan(1), absl::MakeSpan(right).subspan(1));
+    REQUIRE(approxEqualMargin<float>(absl::MakeConstSpan(left).subspan(1), absl::MakeConstSpan(expectedLeft).subspan(1)));
+    REQUIRE(approxEqualMargin<float>(absl::MakeConstSpan(right).subspan(1), absl::MakeConstSpan(expectedRight).subspan(1)));
+}
+
+TEST_CASE("[Helpers] Gain, width and position matches the separate passes")
+{
+    std::vector<float> amplitude(bigBufferSize);
+    std::vector<float> eg(bigBufferSize);
+    std::vector<float> volume(bigBufferSize);
+    std::vector<float> width(bigBufferSize);
+    std::vector<float> position(bigBufferSize);
+    std::vector<float> inputLeft(bigBufferSize);
+    std::vector<float> inputRight(bigBufferSize);
+    std::vector<float> expectedLeft(bigBufferSize);
+    std::vector<float> expectedRight(bigBufferSize);
+    std::vector<float> left(bigBufferSize);
+    std::vector<float> right(bigBufferSize);
+    sfz::linearRamp<float>(absl::MakeSpan(amplitude), 0.5f, 0.0001f);
+    sfz::linearRamp<float>(absl::MakeSpan(eg), 1.0f, -0.0002f);
+    sfz::fill<float>(absl::MakeSpan(volume), 0.7f);
+    sfz::linearRamp<float>(absl::MakeSpan(width), -1.0f, 2.0f / bigBufferSize);
+    sfz::linearRamp<float>(absl::MakeSpan(position), 1.0f, -2.0f / bigBufferSize);
+    for (size_t i = 0; i < inputLeft.size(); ++i) {
+        inputLeft[i] = std::sin(0.1f * static_cast<float>(i));
+        inputRight[i] = std::cos(0.07f * static_cast<float>(i));
+    }
+
+    // The mid/side processing the stereo voices used to do in separate passes
+    for (size_t i = 0; i < inputLeft.size(); ++i) {
+        const auto gain = amplitude[i] * eg[i] * volume[i];
+        auto side = (inputLeft[i] * gain - inputRight[i] * gain) * sqrtTwoInv<float>;
+        auto mid = (inputLeft[i] * gain + inputRight[i] * gain) * sqrtTwoInv<float>;
+        side *= std::cos(piFour<float> * (1.0f + width[i]));
+        mid *= std::sin(piFour<float> * (1.0f + width[i]));
+        expectedLeft[i] = (mid + std::cos(piFour<float> * (1.0f + position[i])) * side) * sqrtTwoInv<float>;
+        expectedRight[i] = (mid + std::sin(piFour<float> * (1.0f + position[i])) * side) * sqrtTwoInv<float>;
+    }
+
+    sfz::copy<float>(inputLeft, absl::MakeSpan(left));
+    sfz::copy<float>(inputRight, absl::MakeSpan(right));
+    sfz::applyGainWidthAndPosition<float, false>(amplitude, eg, volume, width, position, absl::MakeSpan(left), absl::MakeSpan(right));
+    // The pan law is read from a table so the gains near zero are only close in absolute terms
+    REQUIRE(approxEqualMargin<float>(left, expectedLeft, 1e-6f));
+    REQUIRE(approxEqualMargin<float>(right, expectedRight, 1e-6f));
+
+    sfz::copy<float>(inputLeft, absl::MakeSpan(left));
+    sfz::copy<float>(inputRight, absl::MakeSpan(right));
+    sfz::applyGainWidthAndPosition<float, true>(amplitude, eg, volume, width, position, absl::MakeSpan(left), absl::MakeSpan(right));
+    REQUIRE(approxEqualMargin<float>(left, expectedLeft));
+    REQUIRE(approxEqualMargin<float>(right, expectedRight));
+
+    // Unaligned envelopes and buffers
+    sfz::copy<float>(inputLeft, absl::MakeSpan(left));
+    sfz::copy<float>(inputRight, absl::MakeSpan(right));
+    sfz::applyGainWidthAndPosition<float, true>(absl::MakeConstSpan(amplitude).subspan(1), absl::MakeConstSpan(eg).subspan(1), absl::MakeConstSpan(volume).subspan(1),
+        absl::MakeConstSpan(width).subspan(1), absl::MakeConstSpan(position).subspan(1), absl::MakeSpan(left).subspan(1), absl::MakeSpan(right).subspan(1));
+    REQUIRE(approxEqualMargin<float>(absl::MakeConstSpan(left).subspan(1), absl::MakeConstSpan(expectedLeft).subspan(1)));
+    REQUIRE(approxEqualMargin<float>(absl::MakeConstSpan(right).subspan(1), absl::MakeConstSpan(expectedRight).subspan(1)));
+}
+
+TEST_CASE("[Helpers] Interpolate")
+{
+    std::array<float, 5> source { 0.0f, 1.0f, 2.0f, 3.0f, 4.0f };
+    std::array<int, 4> indices { 0, 1, 1, 3 };
+    std::array<float, 4> leftCoeffs { 1.0f, 0.5f, 0.25f, 0.0f };
+    std::array<float, 4> rightCoeffs { 0.0f, 0.5f, 0.75f, 1.0f };
+    std::array<float, 4> expected { 0.0f, 1.5f, 1.75f, 4.0f };
+    std::array<float, 4> output;
+    sfz::interpolate<float, false>(source, indices, leftCoeffs, rightCoeffs, absl::MakeSpan(output));
+    REQUIRE(approxEqual<float>(output, expected));
+    absl::c_fill(output, 0.0f);
+    sfz::interpolate<float, true>(source, indices, leftCoeffs, rightCoeffs, absl::MakeSpan(output));
+    REQUIRE(approxEqual<float>(output, expected));
+
+    std::array<int16_t, 5> int16Source { 0, 1, 2, 3, 4 };
+    absl::c_fill(output, 0.0f);
+    sfz::interpolate<int16_t>(int16Source, indices, leftCoeffs, rightCoeffs, absl::MakeSpan(output));
+    REQUIRE(approxEqual<float>(output, expected));
+}
+
+TEST_CASE("[Helpers] Interpolate (SIMD vs Scalar)")
+{
+    std::vector<float> source(2 * bigBufferSize + 2);
+    std::vector<float> jumps(bigBufferSize);
+    std::vector<int> indices(bigBufferSize);
+    std::vector<float> leftCoeffs(bigBufferSize);
+    std::vector<float> rightCoeffs(bigBufferSize);
+    std::vector<float> outputScalar(bigBufferSize);
+    std::vector<float> outputSIMD(bigBufferSize);
+    sfz::linearRamp<float>(absl::MakeSpan(source), 0.0f, 0.1f);
+    sfz::fill<float>(absl::MakeSpan(jumps), 1.7f);
+    sfz::cumsum<float>(jumps, absl::MakeSpan(jumps));
+    sfz::sfzInterpolationCast<float>(jumps, absl::MakeSpan(indices), absl::MakeSpan(leftCoeffs), absl::MakeSpan(rightCoeffs));
+
+    sfz::interpolate<float, false>(source, indices, leftCoeffs, rightCoeffs, absl::MakeSpan(outputScalar));
+    sfz::interpolate<float, true>(source, indices, leftCoeffs, rightCoeffs, absl::MakeSpan(outputSIMD));
+    REQUIRE(approxEqual<float>(outputScalar, outputSIMD));
+
+    // Unaligned coefficients and output
+    sfz::interpolate<float, false>(source, absl::MakeConstSpan(indices).subspan(1), absl::MakeConstSpan(leftCoeffs).subspan(1), absl::MakeConstSpan(rightCoeffs).subspan(1), absl::MakeSpan(outputScalar).subspan(3));
+    sfz::interpolate<float, true>(source, absl::MakeConstSpan(indices).subspan(1), absl::MakeConstSpan(leftCoeffs).subspan(1), absl::MakeConstSpan(rightCoeffs).subspan(1), absl::MakeSpan(outputSIMD).subspan(3));
+    REQUIRE(approxEqual<float>(outputScalar, outputSIMD));
+}
+
+TEST_CASE("[Helpers] Interpolate stereo (SIMD vs Scalar)")
+{
+    std::vector<float> leftSource(2 * bigBufferSize + 2);
+    std::vector<float> rightSource(2 * bigBufferSize + 2);
+    std::vector<float> jumps(bigBufferSize);
+    std::vector<int> indices(bigBufferSize);
+    std::vector<float> leftCoeffs(bigBufferSize);
+    std::vector<float> rightCoeffs(bigBufferSize);
+    std::vector<float> leftMono(bigBufferSize);
+    std::vector<float> rightMono(bigBufferSize);
+    std::vector<float> leftScalar(bigBufferSize);
+    std::vector<float> rightScalar(bigBufferSize);
+    std::vector<float> leftSIMD(bigBufferSize);
+    std::vector<float> rightSIMD(bigBufferSize);
+    sfz::linearRamp<float>(absl::MakeSpan(leftSource), 0.0f, 0.1f);
+    sfz::linearRamp<float>(absl::MakeSpan(rightSource), 1.0f, -0.1f);
+    sfz::fill<float>(absl::MakeSpan(jumps), 1.3f);
+    sfz::cumsum<float>(jumps, absl::MakeSpan(jumps));
+    sfz::sfzInterpolationCast<float>(jumps, absl::MakeSpan(indices), absl::MakeSpan(leftCoeffs), absl::MakeSpan(rightCoeffs));
+
+    sfz::interpolate<float, false>(leftSource, indices, leftCoeffs, rightCoeffs, absl::MakeSpan(leftMono));
+    sfz::interpolate<float, false>(rightSource, indices, leftCoeffs, rightCoeffs, absl::MakeSpan(rightMono));
+    sfz::interpolateStereo<float, false>(leftSource, rightSource, indices, leftCoeffs, rightCoeffs, absl::MakeSpan(leftScalar), absl::MakeSpan(rightScalar));
+    sfz::interpolateStereo<float, true>(leftSource, rightSource, indices, leftCoeffs, rightCoeffs, absl::MakeSpan(leftSIMD), absl::MakeSpan(rightSIMD));
+    REQUIRE(leftMono == leftScalar);
+    REQUIRE(rightMono == rightScalar);
+    REQUIRE(approxEqual<float>(leftScalar, leftSIMD));
+    REQUIRE(approxEqual<float>(rightScalar, rightSIMD));
+}
+
+TEST_CASE("[Helpers] Interpolation cast of integer and near-integer jumps")
+{
+    // Every path truncates, so an integer jump lands on its own frame with the whole weight on the left
+    const std::vector<float> floatJumps { 0.0f, 1.0f, 2.0f, 3.0f, 0.99999994f, 1.00000012f, 1.99999988f, 2.5f,
+        3.49999976f, 3.5f, 4.0f, 4.99999952f, 5.00000048f, 6.25f, 1048577.0f, 1048576.75f };
+    const std::vector<int> expectedJumps { 0, 1, 2, 3, 0, 1, 1, 2, 3, 3, 4, 4, 5, 6, 1048577, 1048576 };
+    const std::vector<float> expectedRight { 0.0f, 0.0f, 0.0f, 0.0f, 0.99999994f, 1.1920929e-07f, 0.999999881f, 0.5f,
+        0.499999762f, 0.5f, 0.0f, 0.999999523f, 4.76837158e-07f, 0.25f, 0.0f, 0.75f };
+    const std::vector<float> expectedLeft { 1.0f, 1.0f, 1.0f, 1.0f, 5.96046448e-08f, 0.999999881f, 1.1920929e-07f, 0.5f,
+        0.500000238f, 0.5f, 1.0f, 4.76837158e-07f, 0.999999523f, 0.75f, 1.0f, 0.25f };
+
+    std::vector<int> jumps(floatJumps.size());
+    std::vector<float> leftCoeffs(floatJumps.size());
+    std::vector<float> rightCoeffs(floatJumps.size());
+    sfz::sfzInterpolationCast<float, false>(floatJumps, absl::MakeSpan(jumps), absl::MakeSpan(leftCoeffs), absl::MakeSpan(rightCoeffs));
+    REQUIRE(jumps == expectedJumps);
+    REQUIRE(leftCoeffs == expectedLeft);
+    REQUIRE(rightCoeffs == expectedRight);
+
+    const auto supported = sfz::getSupportedSIMDPath();
+    for (auto path : { sfz::SIMDPath::sse, sfz::SIMDPath::avx2, sfz::SIMDPath::avx512 }) {
+        if (path > supported)
+            break;
+        sfz::setSIMDPath(path);
+        INFO("SIMD path: " << sfz::simdPathName(sfz::getSIMDPath()));
+        std::fill(jumps.begin(), jumps.end(), -1);
+        sfz::sfzInterpolationCast<float, true>(floatJumps, absl::MakeSpan(jumps), absl::MakeSpan(leftCoeffs), absl::MakeSpan(rightCoeffs));
+        REQUIRE(jumps == expectedJumps);
+        REQUIRE(leftCoeffs == expectedLeft);
+        REQUIRE(rightCoeffs == expectedRight);
+    }
+    sfz::setSIMDPath(supported);
+}
+
+TEST_CASE("[Helpers] Hermite interpolation")
+{
+    // Lines go through the spline unchanged, and the frames outside of the source are silent
+    std::array<float, 6> source { 0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f };
+    std::array<int, 5> indices { 1, 2, 2, 3, 0 };
+    std::array<float, 5> coeffs { 0.0f, 0.5f, 0.25f, 0.75f, 0.0f };
+    std::array<float, 5> expected { 1.0f, 2.5f, 2.25f, 3.75f, 0.0f };
+    std::array<float, 5> output;
+    sfz::interpolateHermite<float, false>(source, indices, coeffs, absl::MakeSpan(output));
+    REQUIRE(approxEqual<float>(output, expected));
+    absl::c_fill(output, 0.0f);
+    sfz::interpolateHermite<float, true>(source, indices, coeffs, absl::MakeSpan(output));
+    REQUIRE(approxEqual<float>(output, expected));
+
+    std::array<int16_t, 6> int16Source { 0, 1, 2, 3, 4, 5 };
+    absl::c_fill(output, 0.0f);
+    sfz::interpolateHermite<int16_t>(int16Source, indices, coeffs, absl::MakeSpan(output));
+    REQUIRE(approxEqual<float>(output, expected));
+}
+
+TEST_CASE("[Helpers] Sinc interpolation")
+{
+    // Unity gain for a constant source and a slow sine, away from the edges
+    std::vector<float> source(64);
+    std::array<int, 6> indices { 10, 11, 20, 21, 30, 40 };
+    std::array<float, 6> coeffs { 0.0f, 0.1f, 0.5f, 0.33f, 0.9f, 0.999f };
+    std::array<float, 6> output;
+    std::array<float, 6> expected;
+    absl::c_fill(source, 1.0f);
+    absl::c_fill(expected, 1.0f);
+    sfz::interpolateSinc<float, false>(source, indices, coeffs, absl::MakeSpan(output));
+    REQUIRE(approxEqual<float>(output, expected));
+    sfz::interpolateSinc<float, true>(source, indices, coeffs, absl::MakeSpan(output));
+    REQUIRE(approxEqual<float>(output, expected));
+
+    const auto frequency = 0.02f;
+    for (size_t i = 0; i < source.size(); ++i)
+        source[i] = std::sin(twoPi<float> * frequency * static_cast<float>(i));
+    for (size_t i = 0; i < indices.size(); ++i)
+        expected[i] = std::sin(twoPi<float> * frequency * (static_cast<float>(indices[i]) + coeffs[i]));
+    sfz::interpolateSinc<float, false>(source, indices, coeffs, absl::MakeSpan(output));
+    REQUIRE(approxEqualMargin<float>(output, expected, 1e-2f));
+    sfz::interpolateSinc<float, true>(source, indices, coeffs, absl::MakeSpan(output));
+    REQUIRE(approxEqualMargin<float>(output, expected, 1e-2f));
+}
+
+TEST_CASE("[Helpers] Hermite and sinc interpolation (SIMD vs Scalar)")
+{
+    // The first indices read frames before the source and the last ones after it
+    std::vector<float> source(2 * bigBufferSize - 40);
+    std::vector<float> jumps(bigBufferSize);
+    std::vector<int> indices(bigBufferSize);
+    std::vector<float> leftCoeffs(bigBufferSize);
+    std::vector<float> rightCoeffs(bigBufferSize);
+    std::vector<float> outputScalar(bigBufferSize);
+    std::vector<float> outputSIMD(bigBufferSize);
+    for (size_t i = 0; i < source.size(); ++i)
+        source[i] = std::sin(0.3f * static_cast<float>(i));
+    sfz::fill<float>(absl::MakeSpan(jumps), 1.99f);
+    sfz::cumsum<float>(jumps, absl::MakeSpan(jumps));
+    sfz::subtract<float>(1.99f, absl::MakeSpan(jumps));
+    sfz::sfzInterpolationCast<float>(jumps, absl::MakeSpan(indices), absl::MakeSpan(leftCoeffs), absl::MakeSpan(rightCoeffs));
+
+    sfz::interpolateHermite<float, false>(source, indices, rightCoeffs, absl::MakeSpan(outputScalar));
+    sfz::interpolateHermite<float, true>(source, indices, rightCoeffs, absl::MakeSpan(outputSIMD));
+    REQUIRE(approxEqual<float>(outputScalar, outputSIMD));
+    sfz::interpolateSinc<float, false>(source, indices, rightCoeffs, absl::MakeSpan(outputScalar));
+    sfz::interpolateSinc<float, true>(source, indices, rightCoeffs, absl::MakeSpan(outputSIMD));
+    REQUIRE(approxEqual<float>(outputScalar, outputSIMD));
+
+    // Unaligned coefficients and output
+    sfz::interpolateHermite<float, false>(source, absl::MakeConstSpan(indices).subspan(1), absl::MakeConstSpan(rightCoeffs).subspan(1), absl::MakeSpan(outputScalar).subspan(3));
+    sfz::interpolateHermite<float, true>(source, absl::MakeConstSpan(indices).subspan(1), absl::MakeConstSpan(rightCoeffs).subspan(1), absl::MakeSpan(outputSIMD).subspan(3));
+    REQUIRE(approxEqual<float>(outputScalar, outputSIMD));
+    sfz::interpolateSinc<float, false>(source, absl::MakeConstSpan(indices).subspan(1), absl::MakeConstSpan(rightCoeffs).subspan(1), absl::MakeSpan(outputScalar).subspan(3));
+    sfz::interpolateSinc<float, true>(source, absl::MakeConstSpan(indices).subspan(1), absl::MakeConstSpan(rightCoeffs).subspan(1), absl::MakeSpan(outputSIMD).subspan(3));
+    REQUIRE(approxEqual<float>(outputScalar, outputSIMD));
+}
+
+TEST_CASE("[Helpers] Phase index")
+{
+    std::array<int, 6> indices;
+    std::array<float, 6> leftCoeffs;
+    std::array<float, 6> rightCoeffs;
+    int position { 10 };
+    float phase { 0.25f };
+    sfz::phaseIndex<float, false>(0.5f, position, phase, 100, 0, false, absl::MakeSpan(indices), absl::MakeSpan(leftCoeffs), absl::MakeSpan(rightCoeffs));
+    std::array<int, 6> expectedIndices { 10, 11, 11, 12, 12, 13 };
+    std::array<float, 6> expectedRight { 0.75f, 0.25f, 0.75f, 0.25f, 0.75f, 0.25f };
+    std::array<float, 6> expectedLeft { 0.25f, 0.75f, 0.25f, 0.75f, 0.25f, 0.75f };
+    REQUIRE(indices == expectedIndices);
+    REQUIRE(approxEqual<float>(rightCoeffs, expectedRight));
+    REQUIRE(approxEqual<float>(leftCoeffs, expectedLeft));
+    REQUIRE(position == 13);
+    REQUIRE(phase == 0.25_a);
+
+    // Saturating at the end
+    position = 10;
+    phase = 0.0f;
+    sfz::phaseIndex<float, false>(1.0f, position, phase, 12, 0, false, absl::MakeSpan(indices), absl::MakeSpan(leftCoeffs), absl::MakeSpan(rightCoeffs));
+    expectedIndices = { 11, 12, 12, 12, 12, 12 };
+    REQUIRE(indices == expectedIndices);
+    REQUIRE(leftCoeffs[5] == 0.0f);
+    REQUIRE(rightCoeffs[5] == 1.0f);
+    REQUIRE(position == 12);
+
+    // Looping back
+    position = 10;
+    phase = 0.0f;
+    sfz::phaseIndex<float, false>(1.0f, position, phase, 12, 8, true, absl::MakeSpan(indices), absl::MakeSpan(leftCoeffs), absl::MakeSpan(rightCoeffs));
+    expectedIndices = { 11, 12, 8, 9, 10, 11 };
+    REQUIRE(indices == expectedIndices);
+    REQUIRE(position == 11);
+
+    // Wrapping several times within a block
+    position = 0;
+    phase = 0.0f;
+    sfz::phaseIndex<float, false>(4.0f, position, phase, 12, 10, true, absl::MakeSpan(indices), absl::MakeSpan(leftCoeffs), absl::MakeSpan(rightCoeffs));
+    expectedIndices = { 4, 8, 12, 10, 11, 12 };
+    REQUIRE(indices == expectedIndices);
+}
+
+TEST_CASE("[Helpers] Phase index matches the jumps and casts")
+{
+    std::vector<float> jumps(bigBufferSize);
+    std::vector<int> expectedIndices(bigBufferSize);
+    std::vector<float> expectedLeft(bigBufferSize);
+    std::vector<float> expectedRight(bigBufferSize);
+    std::vector<int> indices(bigBufferSize);
+    std::vector<float> leftCoeffs(bigBufferSize);
+    std::vector<float> rightCoeffs(bigBufferSize);
+    const float step { 1.1f };
+    const float phase { 0.3f };
+    sfz::fill<float>(absl::MakeSpan(jumps), step);
+    jumps[0] += phase;
+    sfz::cumsum<float>(jumps, absl::MakeSpan(jumps));
+    sfz::sfzInterpolationCast<float>(jumps, absl::MakeSpan(expectedIndices), absl::MakeSpan(expectedLeft), absl::MakeSpan(expectedRight));
+    sfz::add<int>(5, absl::MakeSpan(expectedIndices));
+
+    int position { 5 };
+    float nextPhase { phase };
+    sfz::phaseIndex<float>(step, position, nextPhase, 100000, 0, false, absl::MakeSpan(indices), absl::MakeSpan(leftCoeffs), absl::MakeSpan(rightCoeffs));
+    // The cumulative sum drifts a little over the block
+    for (size_t i = 0; i < indices.size(); ++i)
+        REQUIRE(indices[i] + rightCoeffs[i] == Approx(expectedIndices[i] + expectedRight[i]).margin(1e-2));
+}
+
+TEST_CASE("[Helpers] Phase index (SIMD vs Scalar)")
+{
+    std::vector<int> indicesScalar(bigBufferSize);
+    std::vector<float> leftScalar(bigBufferSize);
+    std::vector<float> rightScalar(bigBufferSize);
+    std::vector<int> indicesSIMD(bigBufferSize);
+    std::vector<float> leftSIMD(bigBufferSize);
+    std::vector<float> rightSIMD(bigBufferSize);
+
+    auto check = [&](float step, int end, int loopStart, bool loop, size_t first) {
+        int positionScalar { 3 };
+        float phaseScalar { 0.2f };
+        int positionSIMD { 3 };
+        float phaseSIMD { 0.2f };
+        sfz::phaseIndex<float, false>(step, positionScalar, phaseScalar, end, loopStart, loop,
+            absl::MakeSpan(indicesScalar).subspan(first), absl::MakeSpan(leftScalar).subspan(first), absl::MakeSpan(rightScalar).subspan(first));
+        sfz::phaseIndex<float, true>(step, positionSIMD, phaseSIMD, end, loopStart, loop,
+            absl::MakeSpan(indicesSIMD).subspan(first), absl::MakeSpan(leftSIMD).subspan(first), absl::MakeSpan(rightSIMD).subspan(first));
+        REQUIRE(indicesScalar == indicesSIMD);
+        REQUIRE(approxEqual<float>(leftScalar, leftSIMD));
+        REQUIRE(approxEqual<float>(rightScalar, rightSIMD));
+        REQUIRE(positionScalar == positionSIMD);
+        REQUIRE(phaseScalar == Approx(phaseSIMD));
+    };
+
+    check(1.3f, 100000, 0, false, 0);
+    check(1.3f, 1000, 0, false, 0);
+    check(0.7f, 1000, 500, true, 0);
+    check(2.9f, 600, 100, true, 1);
+    check(2.9f, 600, 100, false, 3);
+    // Short loops wrap several times per block
+    check(4.0f, 200, 190, true, 0);
+    check(4.3f, 200, 198, true, 2);
+    check(0.5f, 200, 200, true, 0);
+}
+
+TEST_CASE("[Helpers] SIMD path selection")
+{
+    const auto supported = sfz::getSupportedSIMDPath();
+    REQUIRE(sfz::getSIMDPath() == supported);
+    REQUIRE(std::string(sfz::simdPathName(supported)) != "unknown");
+
+    // Lowering works, raising past the processor does not
+    sfz::setSIMDPath(sfz::SIMDPath::scalar);
+    REQUIRE(sfz::getSIMDPath() <= supported);
+    sfz::setSIMDPath(sfz::SIMDPath::avx512);
+    REQUIRE(sfz::getSIMDPath() == supported);
+}
+
+TEST_CASE("[Helpers] Every SIMD path matches the scalar kernels")
+{
+    std::vector<float> input(bigBufferSize);
+    std::vector<float> gain(bigBufferSize);
+    std::vector<float> interleaved(2 * bigBufferSize);
+    std::vector<float> floatJumps(bigBufferSize);
+    for (size_t i = 0; i < input.size(); ++i) {
+        input[i] = std::sin(0.1f * static_cast<float>(i));
+        gain[i] = std::cos(0.03f * static_cast<float>(i));
+        floatJumps[i] = 0.37f * static_cast<float>(i);
+    }
+    for (size_t i = 0; i < interleaved.size(); ++i)
+        interleaved[i] = std::cos(0.05f * static_cast<float>(i));
+
+    std::vector<float> expected(bigBufferSize);
+    std::vector<float> expectedRight(bigBufferSize);
+    std::vector<float> output(bigBufferSize);
+    std::vector<float> outputRight(bigBufferSize);
+    std::vector<float> expectedInterleaved(2 * bigBufferSize);
+    std::vector<float> outputInterleaved(2 * bigBufferSize);
+    std::vector<int> expectedJumps(bigBufferSize);
+    std::vector<int> outputJumps(bigBufferSize);
+
+    const auto supported = sfz::getSupportedSIMDPath();
+    for (auto path : { sfz::SIMDPath::sse, sfz::SIMDPath::avx2, sfz::SIMDPath::avx512 }) {
+        if (path > supported)
+            break;
+        sfz::setSIMDPath(path);
+        INFO("SIMD path: " << sfz::simdPathName(sfz::getSIMDPath()));
+        // Odd offsets so that every path goes through its head and tail
+        for (size_t first : { 0, 1, 3 }) {
+            const auto in = absl::MakeConstSpan(input).subspan(first);
+            const auto g = absl::MakeConstSpan(gain).subspan(first);
+            const auto out = absl::MakeSpan(output).subspan(first);
+            const auto expectedOut = absl::MakeSpan(expected).subspan(first);
+
+            sfz::applyGain<float, false>(0.3f, in, expectedOut);
+            sfz::applyGain<float, true>(0.3f, in, out);
+            REQUIRE(approxEqual<float>(expected, output));
+
+            sfz::applyGain<float, false>(g, in, expectedOut);
+            sfz::applyGain<float, true>(g, in, out);
+            REQUIRE(approxEqual<float>(expected, output));
+
+            sfz::multiplyAdd<float, false>(g, in, expectedOut);
+            sfz::multiplyAdd<float, true>(g, in, out);
+            REQUIRE(approxEqual<float>(expected, output));
+
+            REQUIRE(sfz::linearRamp<float, false>(expectedOut, 0.1f, 0.001f) == Approx(sfz::linearRamp<float, true>(out, 0.1f, 0.001f)).epsilon(1e-3));
+            REQUIRE(approxEqual<float>(expected, output));
+
+            REQUIRE(sfz::multiplicativeRamp<float, false>(expectedOut, 0.1f, 1.0001f) == Approx(sfz::multiplicativeRamp<float, true>(out, 0.1f, 1.0001f)).epsilon(1e-3));
+            REQUIRE(approxEqual<float>(expected, output));
+
+            sfz::cumsum<float, false>(in, expectedOut);
+            sfz::cumsum<float, true>(in, out);
+            REQUIRE(approxEqualMargin<float>(expected, output));
+
+            sfz::sfzInterpolationCast<float, false>(absl::MakeConstSpan(floatJumps).subspan(first), absl::MakeSpan(expectedJumps).subspan(first),
+                expectedOut, absl::MakeSpan(expectedRight).subspan(first));
+            sfz::sfzInterpolationCast<float, true>(absl::MakeConstSpan(floatJumps).subspan(first), absl::MakeSpan(outputJumps).subspan(first),
+                out, absl::MakeSpan(outputRight).subspan(first));
+            REQUIRE(expectedJumps == outputJumps);
+            REQUIRE(approxEqualMargin<float>(expected, output));
+            REQUIRE(approxEqualMargin<float>(expectedRight, outputRight));
+
+            const auto interleavedIn = absl::MakeConstSpan(interleaved).subspan(2 * first);
+            sfz::readInterleaved<float, false>(interleavedIn, expectedOut, absl::MakeSpan(expectedRight).subspan(first));
+            sfz::readInterleaved<float, true>(interleavedIn, out, absl::MakeSpan(outputRight).subspan(first));
+            REQUIRE(expected == output);
+            REQUIRE(expectedRight == outputRight);
+
+            sfz::writeInterleaved<float, false>(in, g, absl::MakeSpan(expectedInterleaved).subspan(2 * first));
+            sfz::writeInterleaved<float, true>(in, g, absl::MakeSpan(outputInterleaved).subspan(2 * first));
+            REQUIRE(expectedInterleaved == outputInterleaved);
+
+            std::vector<int> indices(in.size());
+            std::vector<float> leftCoeffs(in.size());
+            std::vector<float> rightCoeffs(in.size());
+            sfz::sfzInterpolationCast<float, false>(absl::MakeConstSpan(floatJumps).first(in.size()), absl::MakeSpan(indices), absl::MakeSpan(leftCoeffs), absl::MakeSpan(rightCoeffs));
+            sfz::interpolate<float, false>(input, indices, leftCoeffs, rightCoeffs, expectedOut);
+            sfz::interpolate<float, true>(input, indices, leftCoeffs, rightCoeffs, out);
+            REQUIRE(approxEqualMargin<float>(expected, output));
+        }
+    }
+    sfz::setSIMDPath(supported);
+}